@@ -0,0 +1,383 @@
+// Microbenchmark of the command line path: tokenization by esp_console_split_argv and cli_split_argv and the
+// dispatch of cli_command_run, on generated corpora of short commands, long quoted data, escaped strings and many
+// arguments. Both tokenizers are checked against the documented semantics and each other before measuring.
+
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "argtable3.h"
+#include "cli_cmd.h"
+#include "cli_split.h"
+#include "cli_stats.h"
+
+// a port nothing listens on, the background node handshake fails at once
+#define BENCH_NODE_PORT 9
+// random lines compared between the tokenizers
+#define BENCH_FUZZ_LINES 100000
+// the longest generated line and its max number of arguments
+#define BENCH_LINE_MAX (64 * 1024)
+#define BENCH_ARGC_MAX (BENCH_LINE_MAX / 2 + 2)
+// arguments of the many_args corpus, more than fixed size argv used to take
+#define BENCH_MANY_ARGS 64
+// argv limit of the documented examples
+#define BENCH_CASE_ARGC 16
+
+typedef struct {
+  char const *name;
+  void (*gen)(char *line, size_t size, unsigned *rnd);
+  size_t lines_div; /*!< the corpus has --lines / lines_div lines */
+} corpus_t;
+
+typedef struct {
+  char const *line;
+  char const *argv[BENCH_CASE_ARGC];
+} split_case_t;
+
+static struct {
+  struct arg_int *rounds;
+  struct arg_int *lines;
+  struct arg_lit *help;
+  struct arg_end *end;
+} bench_args;
+
+static volatile size_t bench_sink;
+
+// the command of dispatched lines, it doesn't do anything
+static cli_err_t fn_bench_nop(int argc, char **argv) {
+  bench_sink += (size_t)argc;
+  return CLI_OK;
+}
+
+static unsigned next_rand(unsigned *rnd) {
+  *rnd = *rnd * 1103515245u + 12345u;
+  return *rnd >> 8;
+}
+
+static size_t append_hex(char *p, size_t n, unsigned *rnd) {
+  static char const hex[] = "0123456789abcdef";
+  for (size_t i = 0; i < n; i++) {
+    p[i] = hex[next_rand(rnd) & 0xf];
+  }
+  return n;
+}
+
+// typical commands with IDs, indexes and numbers
+static void gen_short(char *line, size_t size, unsigned *rnd) {
+  char id[65] = {};
+  append_hex(id, 64, rnd);
+  switch (next_rand(rnd) % 4) {
+    case 0:
+      snprintf(line, size, "bench_nop %s", id);
+      break;
+    case 1:
+      snprintf(line, size, "bench_nop %u %u 0", next_rand(rnd) % 1000, next_rand(rnd) % 20 + 1);
+      break;
+    case 2:
+      snprintf(line, size, "bench_nop %s children edges.txt 16 10000", id);
+      break;
+    default:
+      snprintf(line, size, "bench_nop");
+      break;
+  }
+}
+
+static void gen_quoted_data(char *line, size_t size, size_t target, unsigned *rnd) {
+  static char const *const words[] = {"iota", "tangle", "message", "payload", "node", "milestone", "data", "index"};
+  size_t n = (size_t)snprintf(line, size, "bench_nop iota_cmder \"");
+  while (n < target && n + 16 < size) {
+    n += (size_t)snprintf(line + n, size - n, "%s ", words[next_rand(rnd) % 8]);
+  }
+  snprintf(line + n - 1, size - n + 1, "\" --remote");
+}
+
+// api_send_msg with quoted data of 1KB to 3KB
+static void gen_quoted(char *line, size_t size, unsigned *rnd) {
+  gen_quoted_data(line, size, 1024 + next_rand(rnd) % 2048, rnd);
+}
+
+// api_send_msg with quoted data of 16KB to 48KB
+static void gen_large(char *line, size_t size, unsigned *rnd) {
+  gen_quoted_data(line, size, 16 * 1024 + next_rand(rnd) % (32 * 1024), rnd);
+}
+
+// escaped spaces, backslashes and quotes in quoted and unquoted arguments
+static void gen_escaped(char *line, size_t size, unsigned *rnd) {
+  static char const *const pieces[] = {"a\\ b", "c\\\\d", "\\\"e\\\"", "\"f \\\" g\"", "\"h\\\\i j\"", "plain"};
+  size_t n = (size_t)snprintf(line, size, "bench_nop");
+  size_t args = 2 + next_rand(rnd) % 10;
+  for (size_t i = 0; i < args && n + 32 < size; i++) {
+    n += (size_t)snprintf(line + n, size - n, " ");
+    for (size_t k = 1 + next_rand(rnd) % 4; k > 0; k--) {
+      n += (size_t)snprintf(line + n, size - n, "%s", pieces[next_rand(rnd) % 6]);
+    }
+  }
+}
+
+// many arguments, separated by runs of spaces
+static void gen_many_args(char *line, size_t size, unsigned *rnd) {
+  size_t n = (size_t)snprintf(line, size, "bench_nop");
+  for (size_t i = 0; i < BENCH_MANY_ARGS && n + 80 < size; i++) {
+    n += (size_t)snprintf(line + n, size - n, "%*s", (int)(1 + next_rand(rnd) % 3), "");
+    n += append_hex(line + n, 8 + next_rand(rnd) % 56, rnd);
+  }
+  line[n] = '\0';
+}
+
+static corpus_t const corpora[] = {
+    {"short", gen_short, 1},
+    {"quoted", gen_quoted, 1},
+    {"large", gen_large, 16},
+    {"escaped", gen_escaped, 1},
+    {"many_args", gen_many_args, 1},
+};
+
+// the semantics of cli_cmd.h, a faster tokenizer has to keep them
+static split_case_t const split_cases[] = {
+    {"abc def 1 20 .3", {"abc", "def", "1", "20", ".3"}},
+    {"abc \"123 456\" def", {"abc", "123 456", "def"}},
+    {"a\\ b\\\\c\\\"", {"a b\\c\""}},
+    {"  lead   trail  ", {"lead", "trail"}},
+    {"\"q \\\" x\" \"\"", {"q \" x", ""}},
+};
+
+typedef size_t (*split_fn_t)(char *line, size_t len, char **argv, size_t argv_size);
+
+static size_t split_scalar(char *line, size_t len, char **argv, size_t argv_size) {
+  (void)len;
+  return esp_console_split_argv(line, argv, argv_size);
+}
+
+static split_fn_t const split_fns[] = {split_scalar, cli_split_argv};
+
+static int split_verify() {
+  char buf[256];
+  char *argv[BENCH_CASE_ARGC];
+  for (size_t f = 0; f < sizeof(split_fns) / sizeof(split_fns[0]); f++) {
+    for (size_t i = 0; i < sizeof(split_cases) / sizeof(split_cases[0]); i++) {
+      split_case_t const *c = &split_cases[i];
+      strcpy(buf, c->line);
+      size_t argc = split_fns[f](buf, strlen(buf), argv, BENCH_CASE_ARGC);
+      size_t expected = 0;
+      while (expected < BENCH_CASE_ARGC && c->argv[expected]) {
+        expected++;
+      }
+      if (argc != expected || argv[argc] != NULL) {
+        printf("split mismatch: [%s], %zu arguments, expected %zu\n", c->line, argc, expected);
+        return -1;
+      }
+      for (size_t k = 0; k < argc; k++) {
+        if (strcmp(argv[k], c->argv[k]) != 0) {
+          printf("split mismatch: [%s], argument %zu is [%s], expected [%s]\n", c->line, k, argv[k], c->argv[k]);
+          return -1;
+        }
+      }
+    }
+  }
+  return 0;
+}
+
+// both tokenizers give the same arguments, with len bytes of line and argv_size limits
+static int split_compare(char const *line, size_t len, size_t argv_size) {
+  static char a[BENCH_LINE_MAX], b[BENCH_LINE_MAX];
+  static char *argv_a[BENCH_ARGC_MAX], *argv_b[BENCH_ARGC_MAX];
+  memcpy(a, line, len);
+  memcpy(b, line, len);
+  a[len] = b[len] = '\0';
+  size_t argc_a = esp_console_split_argv(a, argv_a, argv_size);
+  size_t argc_b = cli_split_argv(b, len, argv_b, argv_size);
+  if (argc_a + 1 < argv_size && argc_a > cli_split_argc_max(line, len)) {
+    printf("%zu arguments of [%.*s] are more than the max\n", argc_a, (int)len, line);
+    return -1;
+  }
+  bool same = argc_a == argc_b && argv_b[argc_b] == NULL;
+  for (size_t k = 0; same && k < argc_a; k++) {
+    same = argv_a[k] - a == argv_b[k] - b && strcmp(argv_a[k], argv_b[k]) == 0;
+  }
+  if (!same) {
+    printf("tokenizers differ on [%.*s], %zu and %zu arguments\n", (int)len, line, argc_a, argc_b);
+    return -1;
+  }
+  return 0;
+}
+
+// random lines of separators, quotes, escapes and NUL bytes
+static int split_fuzz() {
+  static char const alphabet[] = {' ', ' ', '"', '\\', 'a', 'b', 'n', '\0'};
+  char line[80];
+  unsigned rnd = 7;
+  for (size_t i = 0; i < BENCH_FUZZ_LINES; i++) {
+    size_t len = next_rand(&rnd) % 80;
+    for (size_t k = 0; k < len; k++) {
+      // NUL bytes are rare, they end the line
+      line[k] = alphabet[next_rand(&rnd) % (next_rand(&rnd) % 16 ? 7 : 8)];
+    }
+    if (split_compare(line, len, 1 + next_rand(&rnd) % BENCH_CASE_ARGC) != 0) {
+      return -1;
+    }
+  }
+  return 0;
+}
+
+static char **corpus_new(corpus_t const *corpus, size_t lines, size_t *bytes) {
+  char **out = calloc(lines, sizeof(char *));
+  char *line = malloc(BENCH_LINE_MAX);
+  unsigned rnd = 1;
+  *bytes = 0;
+  if (out == NULL || line == NULL) {
+    free(out);
+    free(line);
+    return NULL;
+  }
+  for (size_t i = 0; i < lines; i++) {
+    corpus->gen(line, BENCH_LINE_MAX, &rnd);
+    if ((out[i] = strdup(line)) == NULL) {
+      for (size_t k = 0; k < i; k++) {
+        free(out[k]);
+      }
+      free(out);
+      free(line);
+      return NULL;
+    }
+    *bytes += strlen(line);
+  }
+  free(line);
+  return out;
+}
+
+static void corpus_free(char **lines, size_t len) {
+  for (size_t i = 0; i < len; i++) {
+    free(lines[i]);
+  }
+  free(lines);
+}
+
+// tokenize in a copy of the line, as cli_command_run does
+static uint64_t bench_split(split_fn_t split, char **lines, size_t len, size_t rounds) {
+  static char *argv[BENCH_ARGC_MAX];
+  char *buf = malloc(BENCH_LINE_MAX);
+  if (buf == NULL) {
+    return 0;
+  }
+  uint64_t start = cli_stats_now_ns();
+  for (size_t r = 0; r < rounds; r++) {
+    for (size_t i = 0; i < len; i++) {
+      size_t n = strlen(lines[i]);
+      memcpy(buf, lines[i], n + 1);
+      bench_sink += split(buf, n, argv, cli_split_argc_max(buf, n) + 1);
+    }
+  }
+  uint64_t ns = cli_stats_now_ns() - start;
+  free(buf);
+  return ns;
+}
+
+static uint64_t bench_dispatch(char **lines, size_t len, size_t rounds, size_t *failed) {
+  uint64_t start = cli_stats_now_ns();
+  for (size_t r = 0; r < rounds; r++) {
+    for (size_t i = 0; i < len; i++) {
+      cli_err_t cmd_ret = 0;
+      if (cli_command_run(lines[i], &cmd_ret) != CLI_OK || cmd_ret != CLI_OK) {
+        (*failed)++;
+      }
+    }
+  }
+  return cli_stats_now_ns() - start;
+}
+
+int main(int argc, char **argv) {
+  int ret = 0;
+
+  bench_args.rounds = arg_int0("r", "rounds", "<n>", "rounds of each corpus, default 200");
+  bench_args.lines = arg_int0("l", "lines", "<n>", "lines of each corpus, default 1000");
+  bench_args.help = arg_lit0("h", "help", "show this help");
+  bench_args.end = arg_end(3);
+
+  int nerrors = arg_parse(argc, argv, (void **)&bench_args);
+  if (bench_args.help->count > 0) {
+    printf("Usage: %s", argv[0]);
+    arg_print_syntax(stdout, (void **)&bench_args, "\n");
+    arg_print_glossary(stdout, (void **)&bench_args, "  %-20s %s\n");
+    goto done;
+  }
+  if (nerrors != 0) {
+    arg_print_errors(stderr, bench_args.end, argv[0]);
+    ret = -1;
+    goto done;
+  }
+  size_t rounds = bench_args.rounds->count ? (size_t)bench_args.rounds->ival[0] : 200;
+  size_t all_lines = bench_args.lines->count ? (size_t)bench_args.lines->ival[0] : 1000;
+  if (rounds == 0 || all_lines == 0) {
+    printf("rounds and lines must be positive\n");
+    ret = -1;
+    goto done;
+  }
+
+  if (split_verify() != 0 || split_fuzz() != 0) {
+    ret = -1;
+    goto done;
+  }
+
+  if (cli_command_set_node("127.0.0.1", BENCH_NODE_PORT, false) != CLI_OK || cli_command_init() != CLI_OK) {
+    printf("cli_command_init failed\n");
+    ret = -1;
+    goto done;
+  }
+  cli_cmd_t nop = {
+      .command = "bench_nop",
+      .help = "Do nothing, for benchmarks",
+      .hint = NULL,
+      .func = &fn_bench_nop,
+      .args = NULL,
+  };
+  if (cli_command_register(&nop) != CLI_OK) {
+    printf("register bench_nop failed\n");
+    ret = -1;
+    goto end;
+  }
+  // the seed derivation and the node handshake are done before measuring
+  cli_err_t cmd_ret = 0;
+  cli_command_run("node_conf", &cmd_ret);
+  cli_command_run("tip_pool", &cmd_ret);
+
+  printf("\n%-10s %7s %10s %14s %10s %14s %10s %14s %10s\n", "corpus", "lines", "bytes/line", "scalar ns/line",
+         "scalar MB/s", "split ns/line", "split MB/s", "run ns/line", "run MB/s");
+  for (size_t c = 0; c < sizeof(corpora) / sizeof(corpora[0]); c++) {
+    size_t bytes = 0, failed = 0;
+    size_t lines = all_lines / corpora[c].lines_div ? all_lines / corpora[c].lines_div : 1;
+    char **corpus = corpus_new(&corpora[c], lines, &bytes);
+    if (corpus == NULL) {
+      printf("OOM\n");
+      ret = -1;
+      break;
+    }
+    for (size_t i = 0; i < lines && failed == 0; i++) {
+      failed += split_compare(corpus[i], strlen(corpus[i]), BENCH_ARGC_MAX) != 0;
+    }
+    // warm up
+    bench_split(split_scalar, corpus, lines, 1);
+    bench_split(cli_split_argv, corpus, lines, 1);
+    bench_dispatch(corpus, lines, 1, &failed);
+
+    double scalar_ns = (double)bench_split(split_scalar, corpus, lines, rounds);
+    double split_ns = (double)bench_split(cli_split_argv, corpus, lines, rounds);
+    double run_ns = (double)bench_dispatch(corpus, lines, rounds, &failed);
+    double total_lines = (double)lines * rounds, total_bytes = (double)bytes * rounds;
+    printf("%-10s %7zu %10.1f %14.1f %10.1f %14.1f %10.1f %14.1f %10.1f\n", corpora[c].name, lines,
+           (double)bytes / lines, scalar_ns / total_lines, total_bytes * 1e3 / scalar_ns, split_ns / total_lines,
+           total_bytes * 1e3 / split_ns, run_ns / total_lines, total_bytes * 1e3 / run_ns);
+    if (failed) {
+      printf("%s: %zu lines failed\n", corpora[c].name, failed);
+      ret = -1;
+    }
+    corpus_free(corpus, lines);
+  }
+
+end:
+  cli_command_end();
+done:
+  arg_freetable((void **)&bench_args, sizeof(bench_args) / sizeof(bench_args.rounds));
+  return ret;
+}
@@ -0,0 +1,471 @@
+// A local stand-in of the node REST API for benchmarks, it serves responses of a fixture corpus with injected latency
+// and errors. Connections are kept alive and served by a thread each, as the connection pool of the cmder expects.
+
+#include <arpa/inet.h>
+#include <errno.h>
+#include <inttypes.h>
+#include <netinet/in.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "argtable3.h"
+
+// max size of a request header
+#define MOCK_HEADER_MAX (16 * 1024)
+// max size of a request body, messages are 32KB at most
+#define MOCK_BODY_MAX (64 * 1024)
+#define MOCK_TARGET_MAX 2048
+#define MOCK_LISTEN_BACKLOG 64
+
+typedef struct {
+  char method[8]; /*!< GET or POST */
+  char *path;     /*!< path pattern, '*' matches a path segment */
+  int status;     /*!< HTTP status */
+  char *body;     /*!< JSON body */
+  size_t body_len;
+} mock_route_t;
+
+typedef struct {
+  mock_route_t *routes;
+  size_t routes_len;
+  uint32_t latency_ms; /*!< delay of every response */
+  uint32_t jitter_ms;  /*!< random delay added to the latency */
+  double error_rate;   /*!< ratio of requests answered by a 500 error */
+  unsigned seed;       /*!< seed of injected delays and errors */
+  uint32_t conns;      /*!< accepted connections, a connection seeds its random numbers with it */
+  uint64_t requests;   /*!< served requests */
+  uint64_t injected;   /*!< injected errors */
+  uint64_t not_found;  /*!< requests without a route */
+  uint64_t submitted;  /*!< submitted messages */
+} mock_node_t;
+
+static mock_node_t mock;
+static volatile sig_atomic_t mock_stop;
+
+static struct {
+  struct arg_str *fixtures;
+  struct arg_int *port;
+  struct arg_str *port_file;
+  struct arg_int *latency;
+  struct arg_int *jitter;
+  struct arg_dbl *error_rate;
+  struct arg_int *seed;
+  struct arg_lit *help;
+  struct arg_end *end;
+} mock_args;
+
+static void mock_signal(int sig) {
+  (void)sig;
+  mock_stop = 1;
+}
+
+// load routes of "<method> <path> <status> <body>" lines
+static int routes_load(char const path[]) {
+  FILE *fp = fopen(path, "r");
+  if (fp == NULL) {
+    printf("open %s failed: %s\n", path, strerror(errno));
+    return -1;
+  }
+
+  char *line = NULL;
+  size_t line_cap = 0;
+  size_t line_num = 0;
+  ssize_t len = 0;
+  int ret = 0;
+  while ((len = getline(&line, &line_cap, fp)) != -1) {
+    line_num++;
+    while (len > 0 && (line[len - 1] == '\n' || line[len - 1] == '\r')) {
+      line[--len] = '\0';
+    }
+    if (line[0] == '\0' || line[0] == '#') {
+      continue;
+    }
+
+    char method[8] = {}, route_path[MOCK_TARGET_MAX] = {};
+    int status = 0, body_off = 0;
+    if (sscanf(line, "%7s %2047s %d %n", method, route_path, &status, &body_off) != 3 || body_off == 0) {
+      printf("%s:%zu: invalid route\n", path, line_num);
+      ret = -1;
+      break;
+    }
+
+    mock_route_t *routes = realloc(mock.routes, (mock.routes_len + 1) * sizeof(mock_route_t));
+    if (routes == NULL) {
+      ret = -1;
+      break;
+    }
+    mock.routes = routes;
+    mock_route_t *r = &mock.routes[mock.routes_len];
+    memcpy(r->method, method, sizeof(r->method));
+    r->status = status;
+    r->path = strdup(route_path);
+    r->body = strdup(line + body_off);
+    if (r->path == NULL || r->body == NULL) {
+      free(r->path);
+      free(r->body);
+      ret = -1;
+      break;
+    }
+    r->body_len = strlen(r->body);
+    mock.routes_len++;
+  }
+  free(line);
+  fclose(fp);
+  return ret;
+}
+
+static void routes_free() {
+  for (size_t i = 0; i < mock.routes_len; i++) {
+    free(mock.routes[i].path);
+    free(mock.routes[i].body);
+  }
+  free(mock.routes);
+}
+
+// '*' matches a run of characters except '/'
+static bool path_match(char const *pat, char const *s, char const *end) {
+  while (*pat) {
+    if (*pat == '*') {
+      pat++;
+      for (;; s++) {
+        if (path_match(pat, s, end)) {
+          return true;
+        }
+        if (s == end || *s == '/') {
+          return false;
+        }
+      }
+    }
+    if (s == end || *pat != *s) {
+      return false;
+    }
+    pat++;
+    s++;
+  }
+  return s == end;
+}
+
+static mock_route_t const *route_find(char const method[], char const target[]) {
+  for (size_t i = 0; i < mock.routes_len; i++) {
+    mock_route_t const *r = &mock.routes[i];
+    // the query is ignored if the route doesn't have one
+    char const *end = strchr(r->path, '?') ? NULL : strchr(target, '?');
+    if (end == NULL) {
+      end = target + strlen(target);
+    }
+    if (strcmp(r->method, method) == 0 && path_match(r->path, target, end)) {
+      return r;
+    }
+  }
+  return NULL;
+}
+
+static int send_all(int fd, char const *buf, size_t len) {
+  while (len > 0) {
+    ssize_t n = send(fd, buf, len, MSG_NOSIGNAL);
+    if (n < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      return -1;
+    }
+    buf += n;
+    len -= (size_t)n;
+  }
+  return 0;
+}
+
+static char const *status_text(int status) {
+  switch (status) {
+    case 200:
+      return "OK";
+    case 201:
+      return "Created";
+    case 400:
+      return "Bad Request";
+    case 404:
+      return "Not Found";
+    case 500:
+      return "Internal Server Error";
+    default:
+      return "Unknown";
+  }
+}
+
+static int respond(int fd, int status, char const *body, size_t body_len) {
+  char header[256];
+  int n = snprintf(header, sizeof(header),
+                   "HTTP/1.1 %d %s\r\nContent-Type: application/json\r\nContent-Length: %zu\r\n\r\n", status,
+                   status_text(status), body_len);
+  if (send_all(fd, header, (size_t)n) != 0) {
+    return -1;
+  }
+  return send_all(fd, body, body_len);
+}
+
+static int respond_error(int fd, int status, char const msg[]) {
+  char body[MOCK_TARGET_MAX + 128];
+  int n = snprintf(body, sizeof(body), "{\"error\":{\"code\":\"%d\",\"message\":\"%s\"}}", status, msg);
+  if (n < 0 || (size_t)n >= sizeof(body)) {
+    n = (int)strlen(body);
+  }
+  return respond(fd, status, body, (size_t)n);
+}
+
+// the message ID is a hash of the message, it's not a BLAKE2b hash but it's stable for a message
+static int respond_submit(int fd, char const *body, size_t body_len) {
+  char resp[128];
+  int n = snprintf(resp, sizeof(resp), "{\"data\":{\"messageId\":\"");
+  for (uint64_t lane = 0; lane < 4; lane++) {
+    uint64_t h = 14695981039346656037ull ^ lane;
+    for (size_t i = 0; i < body_len; i++) {
+      h = (h ^ (uint8_t)body[i]) * 1099511628211ull;
+    }
+    n += snprintf(resp + n, sizeof(resp) - (size_t)n, "%016" PRIx64, h);
+  }
+  n += snprintf(resp + n, sizeof(resp) - (size_t)n, "\"}}");
+  __atomic_add_fetch(&mock.submitted, 1, __ATOMIC_RELAXED);
+  return respond(fd, 201, resp, (size_t)n);
+}
+
+static int serve_request(int fd, unsigned *rnd, char const method[], char const target[], char const *body,
+                         size_t body_len) {
+  __atomic_add_fetch(&mock.requests, 1, __ATOMIC_RELAXED);
+
+  uint32_t delay_ms = mock.latency_ms + (mock.jitter_ms ? (uint32_t)rand_r(rnd) % (mock.jitter_ms + 1) : 0);
+  if (delay_ms > 0) {
+    struct timespec ts = {.tv_sec = delay_ms / 1000, .tv_nsec = (long)(delay_ms % 1000) * 1000000L};
+    while (nanosleep(&ts, &ts) != 0 && errno == EINTR) {
+    }
+  }
+
+  if (mock.error_rate > 0 && (double)rand_r(rnd) / RAND_MAX < mock.error_rate) {
+    __atomic_add_fetch(&mock.injected, 1, __ATOMIC_RELAXED);
+    return respond_error(fd, 500, "injected error");
+  }
+
+  if (strcmp(method, "POST") == 0 && strcmp(target, "/api/v1/messages") == 0) {
+    if (body_len == 0) {
+      return respond_error(fd, 400, "empty message");
+    }
+    return respond_submit(fd, body, body_len);
+  }
+
+  mock_route_t const *r = route_find(method, target);
+  if (r == NULL) {
+    __atomic_add_fetch(&mock.not_found, 1, __ATOMIC_RELAXED);
+    char msg[MOCK_TARGET_MAX + 32];
+    snprintf(msg, sizeof(msg), "no fixture of %s", target);
+    return respond_error(fd, 404, msg);
+  }
+  return respond(fd, r->status, r->body, r->body_len);
+}
+
+// value of a header, case-insensitive, NULL if it's not found
+static char const *header_value(char const *headers, char const name[], size_t *len) {
+  size_t name_len = strlen(name);
+  for (char const *p = headers; p && *p; p = strstr(p, "\r\n")) {
+    p += p[0] == '\r' ? 2 : 0;
+    if (strncasecmp(p, name, name_len) == 0 && p[name_len] == ':') {
+      char const *v = p + name_len + 1;
+      while (*v == ' ' || *v == '\t') {
+        v++;
+      }
+      char const *e = strstr(v, "\r\n");
+      *len = e ? (size_t)(e - v) : strlen(v);
+      return v;
+    }
+  }
+  return NULL;
+}
+
+static void *conn_serve(void *arg) {
+  int fd = (int)(intptr_t)arg;
+  unsigned rnd = mock.seed + __atomic_add_fetch(&mock.conns, 1, __ATOMIC_RELAXED);
+  // a byte for the terminator of headers
+  char *buf = malloc(MOCK_HEADER_MAX + MOCK_BODY_MAX + 1);
+  size_t len = 0;
+
+  while (buf) {
+    // read a header, a pipelined request may be read already
+    char *header_end = NULL;
+    buf[len] = '\0';
+    while ((header_end = strstr(buf, "\r\n\r\n")) == NULL) {
+      if (len >= MOCK_HEADER_MAX) {
+        goto done;
+      }
+      ssize_t n = recv(fd, buf + len, MOCK_HEADER_MAX + MOCK_BODY_MAX - len, 0);
+      if (n <= 0) {
+        goto done;
+      }
+      len += (size_t)n;
+      buf[len] = '\0';
+    }
+    *header_end = '\0';
+    size_t header_len = (size_t)(header_end - buf) + 4;
+
+    char method[8] = {}, target[MOCK_TARGET_MAX] = {};
+    if (sscanf(buf, "%7s %2047s", method, target) != 2) {
+      respond_error(fd, 400, "invalid request line");
+      goto done;
+    }
+
+    size_t value_len = 0, body_len = 0;
+    char const *v = header_value(buf, "Content-Length", &value_len);
+    if (v) {
+      body_len = strtoul(v, NULL, 10);
+    }
+    if (body_len > MOCK_BODY_MAX) {
+      respond_error(fd, 400, "message is too large");
+      goto done;
+    }
+    bool keep_alive = true;
+    if ((v = header_value(buf, "Connection", &value_len)) != NULL && strncasecmp(v, "close", 5) == 0) {
+      keep_alive = false;
+    }
+    // curl waits for it before sending large bodies
+    if ((v = header_value(buf, "Expect", &value_len)) != NULL && strncasecmp(v, "100-continue", 12) == 0 &&
+        len - header_len < body_len) {
+      if (send_all(fd, "HTTP/1.1 100 Continue\r\n\r\n", 25) != 0) {
+        goto done;
+      }
+    }
+
+    while (len < header_len + body_len) {
+      ssize_t n = recv(fd, buf + len, header_len + body_len - len, 0);
+      if (n <= 0) {
+        goto done;
+      }
+      len += (size_t)n;
+    }
+
+    if (serve_request(fd, &rnd, method, target, buf + header_len, body_len) != 0 || !keep_alive) {
+      goto done;
+    }
+    len -= header_len + body_len;
+    memmove(buf, buf + header_len + body_len, len);
+  }
+
+done:
+  free(buf);
+  close(fd);
+  return NULL;
+}
+
+static int listen_tcp(uint16_t port, char const port_file[]) {
+  struct sockaddr_in addr = {.sin_family = AF_INET, .sin_port = htons(port), .sin_addr.s_addr = htonl(INADDR_LOOPBACK)};
+  int one = 1;
+  int fd = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+  if (fd < 0) {
+    printf("create socket failed: %s\n", strerror(errno));
+    return -1;
+  }
+  setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+  if (bind(fd, (struct sockaddr *)&addr, sizeof(addr)) != 0 || listen(fd, MOCK_LISTEN_BACKLOG) != 0) {
+    printf("listen on port %u failed: %s\n", port, strerror(errno));
+    close(fd);
+    return -1;
+  }
+
+  // the bound port of port 0 is written for the caller
+  socklen_t addr_len = sizeof(addr);
+  getsockname(fd, (struct sockaddr *)&addr, &addr_len);
+  printf("[mock_node] listening on 127.0.0.1:%u, %zu routes\n", ntohs(addr.sin_port), mock.routes_len);
+  fflush(stdout);
+  if (port_file) {
+    FILE *fp = fopen(port_file, "w");
+    if (fp == NULL) {
+      printf("open %s failed: %s\n", port_file, strerror(errno));
+      close(fd);
+      return -1;
+    }
+    fprintf(fp, "%u\n", ntohs(addr.sin_port));
+    fclose(fp);
+  }
+  return fd;
+}
+
+int main(int argc, char **argv) {
+  int ret = 0;
+
+  mock_args.fixtures = arg_str1("f", "fixtures", "<file>", "routes of responses");
+  mock_args.port = arg_int0("p", "port", "<port>", "listen port on 127.0.0.1, 0 for any, default 14265");
+  mock_args.port_file = arg_str0(NULL, "port-file", "<file>", "write the listen port to a file once it's ready");
+  mock_args.latency = arg_int0("l", "latency", "<ms>", "delay of every response");
+  mock_args.jitter = arg_int0("j", "jitter", "<ms>", "max random delay added to the latency");
+  mock_args.error_rate = arg_dbl0("e", "error-rate", "<0-1>", "ratio of requests answered by a 500 error");
+  mock_args.seed = arg_int0("s", "seed", "<n>", "seed of injected delays and errors, default 1");
+  mock_args.help = arg_lit0("h", "help", "show this help");
+  mock_args.end = arg_end(5);
+
+  int nerrors = arg_parse(argc, argv, (void **)&mock_args);
+  if (mock_args.help->count > 0) {
+    printf("Usage: %s", argv[0]);
+    arg_print_syntax(stdout, (void **)&mock_args, "\n");
+    arg_print_glossary(stdout, (void **)&mock_args, "  %-24s %s\n");
+    goto done;
+  }
+  if (nerrors != 0) {
+    arg_print_errors(stderr, mock_args.end, argv[0]);
+    ret = -1;
+    goto done;
+  }
+
+  mock.latency_ms = mock_args.latency->count ? (uint32_t)mock_args.latency->ival[0] : 0;
+  mock.jitter_ms = mock_args.jitter->count ? (uint32_t)mock_args.jitter->ival[0] : 0;
+  mock.error_rate = mock_args.error_rate->count ? mock_args.error_rate->dval[0] : 0;
+  mock.seed = mock_args.seed->count ? (unsigned)mock_args.seed->ival[0] : 1;
+  if (routes_load(mock_args.fixtures->sval[0]) != 0) {
+    ret = -1;
+    goto done;
+  }
+
+  int listen_fd = listen_tcp(mock_args.port->count ? (uint16_t)mock_args.port->ival[0] : 14265,
+                             mock_args.port_file->count ? mock_args.port_file->sval[0] : NULL);
+  if (listen_fd < 0) {
+    ret = -1;
+    goto done;
+  }
+
+  // no SA_RESTART, accept returns on signals
+  struct sigaction sa = {.sa_handler = mock_signal};
+  sigemptyset(&sa.sa_mask);
+  sigaction(SIGINT, &sa, NULL);
+  sigaction(SIGTERM, &sa, NULL);
+
+  while (!mock_stop) {
+    int fd = accept(listen_fd, NULL, NULL);
+    if (fd < 0) {
+      if (errno != EINTR) {
+        printf("[mock_node] accept failed: %s\n", strerror(errno));
+      }
+      continue;
+    }
+    pthread_t thread;
+    if (pthread_create(&thread, NULL, conn_serve, (void *)(intptr_t)fd) != 0) {
+      close(fd);
+      continue;
+    }
+    pthread_detach(thread);
+  }
+  close(listen_fd);
+
+  printf("[mock_node] requests: %" PRIu64 ", not found: %" PRIu64 ", injected errors: %" PRIu64
+         ", submitted messages: %" PRIu64 "\n",
+         __atomic_load_n(&mock.requests, __ATOMIC_RELAXED), __atomic_load_n(&mock.not_found, __ATOMIC_RELAXED),
+         __atomic_load_n(&mock.injected, __ATOMIC_RELAXED), __atomic_load_n(&mock.submitted, __ATOMIC_RELAXED));
+
+done:
+  routes_free();
+  arg_freetable((void **)&mock_args, sizeof(mock_args) / sizeof(mock_args.fixtures));
+  return ret;
+}
@@ -0,0 +1,125 @@
+#!/bin/sh
+# End-to-end benchmark: serve the fixtures by mock_node and run every command against it in batch mode.
+#
+# usage: run_bench.sh <iota_cmder> <mock_node> <fixtures> <commands> [rounds]
+#
+# MOCK_NODE_ARGS passes latency and error injection to mock_node, e.g. "--latency 5 --jitter 5 --error-rate 0.01".
+# BENCH_OUT is the file of stats records, bench_results.ndjson by default.
+# It fails if a command of the corpus has no statistics, failed commands are counted as errors only.
+
+set -eu
+
+if [ $# -lt 4 ]; then
+  echo "usage: $0 <iota_cmder> <mock_node> <fixtures> <commands> [rounds]" >&2
+  exit 2
+fi
+
+CMDER=$(realpath "$1")
+MOCK=$(realpath "$2")
+FIXTURES=$(realpath "$3")
+COMMANDS=$(realpath "$4")
+ROUNDS=${5:-20}
+BENCH_OUT=$(realpath "${BENCH_OUT:-bench_results.ndjson}")
+
+WORK=$(mktemp -d)
+MOCK_PID=
+cleanup() {
+  if [ -n "$MOCK_PID" ]; then
+    kill "$MOCK_PID" 2>/dev/null || true
+    wait "$MOCK_PID" 2>/dev/null || true
+  fi
+  rm -rf "$WORK"
+}
+trap cleanup EXIT INT TERM
+
+# shellcheck disable=SC2086
+"$MOCK" --fixtures "$FIXTURES" --port 0 --port-file "$WORK/port" ${MOCK_NODE_ARGS:-} >"$WORK/mock.log" 2>&1 &
+MOCK_PID=$!
+i=0
+while [ ! -s "$WORK/port" ]; do
+  i=$((i + 1))
+  if [ $i -gt 50 ] || ! kill -0 "$MOCK_PID" 2>/dev/null; then
+    echo "mock_node is not started" >&2
+    cat "$WORK/mock.log" >&2
+    exit 1
+  fi
+  sleep 0.1
+done
+PORT=$(cat "$WORK/port")
+
+# data of api_send_bulk
+i=0
+while [ $i -lt 16 ]; do
+  echo "iota_cmder bulk_record_$i" >>"$WORK/bench_bulk.txt"
+  i=$((i + 1))
+done
+
+# the corpus repeated, statistics of the warm-up round are dropped
+sed -e "s/@PORT@/$PORT/g" -e '/^#/d' -e '/^$/d' "$COMMANDS" >"$WORK/round.txt"
+cat "$WORK/round.txt" >"$WORK/batch.txt"
+echo "stats reset" >>"$WORK/batch.txt"
+i=0
+while [ $i -lt "$ROUNDS" ]; do
+  cat "$WORK/round.txt" >>"$WORK/batch.txt"
+  i=$((i + 1))
+done
+echo "stats" >>"$WORK/batch.txt"
+
+start=$(date +%s.%N)
+(cd "$WORK" && "$CMDER" --node "http://127.0.0.1:$PORT" --data-dir "$WORK/data" --batch batch.txt --output ndjson \
+  >records.ndjson 2>cmder.log) || true
+end=$(date +%s.%N)
+
+grep -e '"type":"command_stats"' -e '"type":"api_stats"' "$WORK/records.ndjson" >"$BENCH_OUT" || true
+
+# mock_node reports its counters on exit
+kill "$MOCK_PID" 2>/dev/null || true
+wait "$MOCK_PID" 2>/dev/null || true
+MOCK_PID=
+
+lines=$(($(wc -l <"$WORK/round.txt") * ROUNDS))
+awk -v start="$start" -v end="$end" -v lines="$lines" '
+function num(rec, key,    m) {
+  if (match(rec, "\"" key "\":[0-9.]+")) {
+    m = substr(rec, RSTART, RLENGTH)
+    sub(/.*:/, "", m)
+    return m + 0
+  }
+  return 0
+}
+function timer(line, key) {
+  if (match(line, "\"" key "\":\\{[^}]*\\}")) {
+    return substr(line, RSTART, RLENGTH)
+  }
+  return ""
+}
+BEGIN {
+  printf "%-24s %7s %6s %10s %10s %10s %10s\n", "command", "calls", "errors", "p50 ms", "p99 ms", "net p50", "ops/s"
+}
+/"type":"command_stats"/ {
+  match($0, /"name":"[^"]*"/)
+  name = substr($0, RSTART + 8, RLENGTH - 9)
+  wall = timer($0, "wall")
+  net = timer($0, "net")
+  mean = num(wall, "mean_us")
+  printf "%-24s %7d %6d %10.3f %10.3f %10.3f %10.1f\n", name, num($0, "calls"), num($0, "errors"),
+         num(wall, "p50_us") / 1000, num(wall, "p99_us") / 1000, num(net, "p50_us") / 1000, mean ? 1e6 / mean : 0
+}
+END {
+  secs = end - start
+  printf "%d command lines in %.2f s, %.1f lines/s including startup\n", lines, secs, secs ? lines / secs : 0
+}' "$BENCH_OUT"
+grep '\[mock_node\]' "$WORK/mock.log" | tail -n 1 || true
+
+# every command of the corpus must be measured
+missing=0
+for cmd in $(awk '{print $1}' "$WORK/round.txt" | sort -u); do
+  if ! grep -q "\"type\":\"command_stats\",\"name\":\"$cmd\"" "$BENCH_OUT"; then
+    echo "no statistics of $cmd" >&2
+    missing=1
+  fi
+done
+if [ $missing -ne 0 ]; then
+  tail -n 50 "$WORK/cmder.log" >&2
+  exit 1
+fi
@@ -0,0 +1,127 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include "cli_addr_cache.h"
+#include "cli_codec.h"
+#include "core/address.h"
+#include "uthash.h"
+
+typedef struct {
+  uint32_t index;
+  uint32_t is_change;
+} addr_key_t;
+
+struct cli_addr_entry {
+  addr_key_t key;
+  byte_t addr[ED25519_ADDRESS_BYTES];
+  char bech32[CLI_BECH32_ADDR_BUF];
+  UT_hash_handle hh;
+};
+
+// must be called with the lock
+static void cache_flush(cli_addr_cache_t *cache) {
+  cli_addr_entry_t *elm, *tmp;
+  HASH_ITER(hh, cache->entries, elm, tmp) {
+    HASH_DEL(cache->entries, elm);
+    free(elm);
+  }
+  cache->stats.entries = 0;
+  cache->stats.flushes++;
+}
+
+void cli_addr_cache_init(cli_addr_cache_t *cache, uint32_t max_entries) {
+  memset(cache, 0, sizeof(cli_addr_cache_t));
+  pthread_mutex_init(&cache->lock, NULL);
+  cache->max = max_entries;
+}
+
+void cli_addr_cache_cleanup(cli_addr_cache_t *cache) {
+  pthread_mutex_lock(&cache->lock);
+  cache_flush(cache);
+  pthread_mutex_unlock(&cache->lock);
+  pthread_mutex_destroy(&cache->lock);
+}
+
+void cli_addr_cache_clear(cli_addr_cache_t *cache) {
+  pthread_mutex_lock(&cache->lock);
+  cache_flush(cache);
+  pthread_mutex_unlock(&cache->lock);
+}
+
+int cli_addr_derive(iota_wallet_t *w, bool is_change, uint32_t index, byte_t addr[], char bech32[]) {
+  // the key derivation is the expensive part, derive once and convert to bech32 from the ed25519 address.
+  if (wallet_address_from_index(w, is_change, index, addr) != 0) {
+    return -1;
+  }
+  return cli_bech32_encode(w->bech32HRP, addr, bech32);
+}
+
+int cli_addr_cache_get(cli_addr_cache_t *cache, iota_wallet_t *w, bool is_change, uint32_t index, byte_t addr[],
+                       char bech32[]) {
+  addr_key_t key = {.index = index, .is_change = is_change};
+  cli_addr_entry_t *elm = NULL;
+
+  pthread_mutex_lock(&cache->lock);
+  // addresses of another seed or HRP are not valid anymore
+  if (memcmp(cache->seed, w->seed, IOTA_SEED_BYTES) != 0 || strcmp(cache->hrp, w->bech32HRP) != 0) {
+    if (cache->entries) {
+      cache_flush(cache);
+    }
+    memcpy(cache->seed, w->seed, IOTA_SEED_BYTES);
+    strncpy(cache->hrp, w->bech32HRP, sizeof(cache->hrp) - 1);
+  }
+
+  HASH_FIND(hh, cache->entries, &key, sizeof(addr_key_t), elm);
+  if (elm) {
+    // move to the tail, the head is the least recently used
+    HASH_DEL(cache->entries, elm);
+    HASH_ADD(hh, cache->entries, key, sizeof(addr_key_t), elm);
+    memcpy(addr, elm->addr, ED25519_ADDRESS_BYTES);
+    memcpy(bech32, elm->bech32, CLI_BECH32_ADDR_BUF);
+    cache->stats.hits++;
+    pthread_mutex_unlock(&cache->lock);
+    return 0;
+  }
+  cache->stats.misses++;
+  pthread_mutex_unlock(&cache->lock);
+
+  // derive out of the lock, workers can derive concurrently
+  if (cli_addr_derive(w, is_change, index, addr, bech32) != 0) {
+    return -1;
+  }
+
+  if ((elm = malloc(sizeof(cli_addr_entry_t))) == NULL) {
+    // not cached but the address is valid
+    return 0;
+  }
+  memset(elm, 0, sizeof(cli_addr_entry_t));
+  elm->key = key;
+  memcpy(elm->addr, addr, ED25519_ADDRESS_BYTES);
+  memcpy(elm->bech32, bech32, CLI_BECH32_ADDR_BUF);
+
+  pthread_mutex_lock(&cache->lock);
+  cli_addr_entry_t *found = NULL;
+  HASH_FIND(hh, cache->entries, &key, sizeof(addr_key_t), found);
+  // skip if another thread added it or the seed was changed while deriving
+  if (found || memcmp(cache->seed, w->seed, IOTA_SEED_BYTES) != 0 || strcmp(cache->hrp, w->bech32HRP) != 0) {
+    free(elm);
+  } else {
+    if (cache->max && cache->stats.entries >= cache->max) {
+      cli_addr_entry_t *lru = cache->entries;
+      HASH_DEL(cache->entries, lru);
+      free(lru);
+      cache->stats.entries--;
+      cache->stats.evictions++;
+    }
+    HASH_ADD(hh, cache->entries, key, sizeof(addr_key_t), elm);
+    cache->stats.entries++;
+  }
+  pthread_mutex_unlock(&cache->lock);
+  return 0;
+}
+
+void cli_addr_cache_stats(cli_addr_cache_t *cache, cli_addr_cache_stats_t *stats) {
+  pthread_mutex_lock(&cache->lock);
+  memcpy(stats, &cache->stats, sizeof(cli_addr_cache_stats_t));
+  pthread_mutex_unlock(&cache->lock);
+}
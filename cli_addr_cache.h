@@ -0,0 +1,107 @@
+#ifndef __CLI_ADDR_CACHE_H__
+#define __CLI_ADDR_CACHE_H__
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "wallet/wallet.h"
+
+// buffer size of a bech32 address
+#define CLI_BECH32_ADDR_BUF 65
+
+typedef struct cli_addr_entry cli_addr_entry_t;
+
+/**
+ * @brief Address cache statistics
+ *
+ */
+typedef struct {
+  uint64_t hits;
+  uint64_t misses;
+  uint64_t evictions;
+  uint64_t flushes; /*!< number of times the cache was cleared */
+  uint32_t entries; /*!< number of cached addresses */
+} cli_addr_cache_stats_t;
+
+/**
+ * @brief A cache of derived addresses keyed by (seed, change, index)
+ *
+ * The ed25519 address and its bech32 form are cached together. The cache holds addresses of a single seed and HRP,
+ * it's flushed if a lookup comes with another seed or HRP. Entries are evicted in LRU order. It's thread-safe.
+ *
+ */
+typedef struct {
+  pthread_mutex_t lock;
+  cli_addr_entry_t *entries;
+  byte_t seed[IOTA_SEED_BYTES]; /*!< the seed of cached addresses */
+  char hrp[16];                 /*!< the HRP of cached bech32 addresses */
+  uint32_t max;                 /*!< max number of entries, 0 for unlimited */
+  cli_addr_cache_stats_t stats;
+} cli_addr_cache_t;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Initialize an address cache
+ *
+ * @param cache the cache
+ * @param max_entries max number of addresses, 0 for unlimited
+ */
+void cli_addr_cache_init(cli_addr_cache_t *cache, uint32_t max_entries);
+
+/**
+ * @brief Remove all addresses and release the cache
+ *
+ * @param cache the cache
+ */
+void cli_addr_cache_cleanup(cli_addr_cache_t *cache);
+
+/**
+ * @brief Remove all addresses, it's called when the seed is replaced
+ *
+ * @param cache the cache
+ */
+void cli_addr_cache_clear(cli_addr_cache_t *cache);
+
+/**
+ * @brief Get the address of an index from the cache, or derive it from the wallet
+ *
+ * @param cache the cache
+ * @param w the wallet
+ * @param is_change the change chain or not
+ * @param index the address index
+ * @param addr the ed25519 address, ED25519_ADDRESS_BYTES
+ * @param bech32 the bech32 address, CLI_BECH32_ADDR_BUF
+ * @return int 0 on success
+ */
+int cli_addr_cache_get(cli_addr_cache_t *cache, iota_wallet_t *w, bool is_change, uint32_t index, byte_t addr[],
+                       char bech32[]);
+
+/**
+ * @brief Derive the address of an index without the cache
+ *
+ * @param w the wallet
+ * @param is_change the change chain or not
+ * @param index the address index
+ * @param addr the ed25519 address, ED25519_ADDRESS_BYTES
+ * @param bech32 the bech32 address, CLI_BECH32_ADDR_BUF
+ * @return int 0 on success
+ */
+int cli_addr_derive(iota_wallet_t *w, bool is_change, uint32_t index, byte_t addr[], char bech32[]);
+
+/**
+ * @brief Get a snapshot of the statistics
+ *
+ * @param cache the cache
+ * @param stats the output statistics
+ */
+void cli_addr_cache_stats(cli_addr_cache_t *cache, cli_addr_cache_stats_t *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // __CLI_ADDR_CACHE_H__
@@ -0,0 +1,99 @@
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "cli_arena.h"
+
+struct cli_arena_chunk {
+  cli_arena_chunk_t *next;
+  // the allocation follows the aligned header
+};
+
+#define ARENA_ROUND(n) (((n) + CLI_ARENA_ALIGN - 1) & ~(size_t)(CLI_ARENA_ALIGN - 1))
+#define ARENA_CHUNK_HEADER ARENA_ROUND(sizeof(cli_arena_chunk_t))
+
+// the block doubles to fit need, but it never exceeds the cap of the arena
+static size_t block_size(size_t cap, size_t need, size_t max) {
+  size_t size = cap ? cap : CLI_ARENA_ALIGN;
+  while (size < need && size <= SIZE_MAX / 2) {
+    size *= 2;
+  }
+  size = size < need ? need : size;
+  return max && size > max ? max : size;
+}
+
+void cli_arena_init(cli_arena_t *arena, size_t init, size_t max) {
+  // a capped arena takes its max at once, everything fits in the block and it's never reallocated
+  *arena = (cli_arena_t){.cap = max ? max : ARENA_ROUND(init), .max = max};
+}
+
+void *cli_arena_alloc(cli_arena_t *arena, size_t size) {
+  if (size > SIZE_MAX - CLI_ARENA_ALIGN - ARENA_CHUNK_HEADER) {
+    return NULL;
+  }
+  size = ARENA_ROUND(size ? size : 1);
+  if (arena->max && size > arena->max - arena->total) {
+    return NULL;
+  }
+
+  void *p = NULL;
+  if (arena->used == 0 && arena->chunks == NULL && (arena->buf == NULL || size > arena->cap)) {
+    // nothing is allocated, the block is sized for it
+    size_t cap = block_size(arena->cap, size, arena->max);
+    char *buf = malloc(cap);
+    if (buf) {
+      free(arena->buf);
+      arena->buf = buf;
+      arena->cap = cap;
+    }
+  }
+  if (arena->buf && size <= arena->cap - arena->used) {
+    p = arena->buf + arena->used;
+    arena->used += size;
+  } else {
+    cli_arena_chunk_t *chunk = malloc(ARENA_CHUNK_HEADER + size);
+    if (chunk == NULL) {
+      return NULL;
+    }
+    chunk->next = arena->chunks;
+    arena->chunks = chunk;
+    p = (char *)chunk + ARENA_CHUNK_HEADER;
+  }
+
+  arena->total += size;
+  if (arena->total > arena->high) {
+    arena->high = arena->total;
+  }
+  return p;
+}
+
+static void free_chunks(cli_arena_t *arena) {
+  while (arena->chunks) {
+    cli_arena_chunk_t *next = arena->chunks->next;
+    free(arena->chunks);
+    arena->chunks = next;
+  }
+}
+
+void cli_arena_reset(cli_arena_t *arena) {
+  free_chunks(arena);
+  if (arena->high > arena->cap) {
+    // the next command of this size fits in the block, a failure keeps the old block
+    size_t cap = block_size(arena->cap, arena->high, arena->max);
+    char *buf = malloc(cap);
+    if (buf) {
+      free(arena->buf);
+      arena->buf = buf;
+      arena->cap = cap;
+    }
+  }
+  arena->used = 0;
+  arena->total = 0;
+}
+
+void cli_arena_cleanup(cli_arena_t *arena) {
+  free_chunks(arena);
+  free(arena->buf);
+  arena->buf = NULL;
+  arena->used = 0;
+  arena->total = 0;
+}
@@ -0,0 +1,70 @@
+#ifndef __CLI_ARENA_H__
+#define __CLI_ARENA_H__
+
+#include <stddef.h>
+
+// alignment of arena allocations
+#define CLI_ARENA_ALIGN 16
+
+typedef struct cli_arena_chunk cli_arena_chunk_t;
+
+/**
+ * @brief A bump allocator of the memory of a command, all allocations are released at once by cli_arena_reset
+ *
+ * Allocations come from one block which is kept between commands. Allocations which don't fit go to extra chunks
+ * until the reset, then the block grows to the high-water mark, so a command of the same size doesn't allocate
+ * again. A capped arena allocates a block of the cap on the first use, so it never grows or takes extra chunks.
+ * It's not thread-safe.
+ *
+ */
+typedef struct {
+  char *buf;                 /*!< the block reused by every command */
+  size_t cap;                /*!< size of the block */
+  size_t used;               /*!< bytes used in the block */
+  cli_arena_chunk_t *chunks; /*!< allocations which don't fit in the block */
+  size_t total;              /*!< bytes allocated since the reset */
+  size_t high;               /*!< the max of total */
+  size_t max;                /*!< cap of total, 0 for unlimited */
+} cli_arena_t;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Initialize an arena
+ *
+ * @param arena the arena
+ * @param init size of the block, it's allocated on the first use; the block is max bytes if max is set
+ * @param max cap of the bytes allocated between resets, 0 for unlimited
+ */
+void cli_arena_init(cli_arena_t *arena, size_t init, size_t max);
+
+/**
+ * @brief Allocate memory, aligned to CLI_ARENA_ALIGN
+ *
+ * @param arena the arena
+ * @param size number of bytes
+ * @return void* NULL on OOM or if it's over the cap
+ */
+void *cli_arena_alloc(cli_arena_t *arena, size_t size);
+
+/**
+ * @brief Release all allocations, the block is kept and grows to the high-water mark
+ *
+ * @param arena the arena
+ */
+void cli_arena_reset(cli_arena_t *arena);
+
+/**
+ * @brief Release all memory of the arena
+ *
+ * @param arena the arena
+ */
+void cli_arena_cleanup(cli_arena_t *arena);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // __CLI_ARENA_H__
@@ -0,0 +1,174 @@
+#include <errno.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "cli_args.h"
+#include "cli_codec.h"
+
+static void *field_of(void *parsed, cli_arg_t const *a) { return (char *)parsed + a->offset; }
+
+static void set_default(void *parsed, cli_arg_t const *a) {
+  switch (a->type) {
+    case CLI_ARG_U32:
+      *(uint32_t *)field_of(parsed, a) = (uint32_t)a->def;
+      break;
+    case CLI_ARG_U64:
+      *(uint64_t *)field_of(parsed, a) = a->def;
+      break;
+    case CLI_ARG_BOOL:
+    case CLI_ARG_FLAG:
+      *(bool *)field_of(parsed, a) = a->def != 0;
+      break;
+    default:
+      *(char const **)field_of(parsed, a) = NULL;
+      break;
+  }
+}
+
+// a decimal without a sign, in the range of the argument
+static int parse_uint(char const *cmd, cli_arg_t const *a, char const *s, uint64_t *val) {
+  char *end = NULL;
+  errno = 0;
+  uint64_t v = (s[0] >= '0' && s[0] <= '9') ? strtoull(s, &end, 10) : 0;
+  if (end == NULL || *end != '\0' || errno == ERANGE) {
+    fprintf(stderr, "%s: %s is not a number: %s\n", cmd, a->name, s);
+    return -1;
+  }
+  if (v < a->min || v > a->max) {
+    fprintf(stderr, "%s: %s is out of range [%" PRIu64 ", %" PRIu64 "]: %s\n", cmd, a->name, a->min, a->max, s);
+    return -1;
+  }
+  *val = v;
+  return 0;
+}
+
+static int parse_value(char const *cmd, cli_arg_t const *a, char *s, void *parsed) {
+  uint64_t v = 0;
+  switch (a->type) {
+    case CLI_ARG_HEX: {
+      size_t len = strlen(s);
+      if (len != a->min) {
+        fprintf(stderr, "%s: %s is a %" PRIu64 "-character hex string, the input length is %zu\n", cmd, a->name,
+                a->min, len);
+        return -1;
+      }
+      if (strspn(s, "0123456789abcdefABCDEF") != len) {
+        fprintf(stderr, "%s: %s is not a hex string: %s\n", cmd, a->name, s);
+        return -1;
+      }
+      break;
+    }
+    case CLI_ARG_BECH32:
+      if (cli_bech32_decode(s, NULL, NULL) != 0) {
+        fprintf(stderr, "%s: %s is not a valid bech32 address: %s\n", cmd, a->name, s);
+        return -1;
+      }
+      break;
+    case CLI_ARG_U32:
+    case CLI_ARG_U64:
+    case CLI_ARG_BOOL:
+      if (parse_uint(cmd, a, s, &v) != 0) {
+        return -1;
+      }
+      if (a->type == CLI_ARG_U32) {
+        *(uint32_t *)field_of(parsed, a) = (uint32_t)v;
+      } else if (a->type == CLI_ARG_U64) {
+        *(uint64_t *)field_of(parsed, a) = v;
+      } else {
+        *(bool *)field_of(parsed, a) = v != 0;
+      }
+      return 0;
+    default:
+      break;
+  }
+  *(char const **)field_of(parsed, a) = s;
+  return 0;
+}
+
+static cli_arg_t const *find_flag(cli_arg_t const schema[], char const *opt) {
+  for (cli_arg_t const *a = schema; a->type != CLI_ARG_END; a++) {
+    if (a->type != CLI_ARG_FLAG) {
+      continue;
+    }
+    if ((opt[1] == '-' && a->name && strcmp(opt + 2, a->name) == 0) ||
+        (opt[1] != '-' && a->short_opt && opt[1] == a->short_opt && opt[2] == '\0')) {
+      return a;
+    }
+  }
+  return NULL;
+}
+
+// the next positional argument after prev, NULL if none
+static cli_arg_t const *next_positional(cli_arg_t const schema[], cli_arg_t const *prev) {
+  for (cli_arg_t const *a = prev ? prev + 1 : schema; a->type != CLI_ARG_END; a++) {
+    if (a->type != CLI_ARG_FLAG) {
+      return a;
+    }
+  }
+  return NULL;
+}
+
+int cli_args_parse(cli_arg_t const schema[], int argc, char **argv, void *parsed) {
+  char const *cmd = argc > 0 ? argv[0] : "";
+  bool options = true;
+  cli_arg_t const *pos = NULL;
+
+  for (cli_arg_t const *a = schema; a->type != CLI_ARG_END; a++) {
+    set_default(parsed, a);
+  }
+
+  for (int i = 1; i < argc; i++) {
+    char *s = argv[i];
+    if (options && s[0] == '-' && s[1] != '\0') {
+      if (strcmp(s, "--") == 0) {
+        options = false;
+        continue;
+      }
+      cli_arg_t const *flag = find_flag(schema, s);
+      if (flag == NULL) {
+        fprintf(stderr, "%s: invalid option \"%s\"\n", cmd, s);
+        return -1;
+      }
+      *(bool *)field_of(parsed, flag) = true;
+      continue;
+    }
+
+    cli_arg_t const *a = next_positional(schema, pos);
+    if (a == NULL) {
+      fprintf(stderr, "%s: unexpected argument \"%s\"\n", cmd, s);
+      return -1;
+    }
+    if (parse_value(cmd, a, s, parsed) != 0) {
+      return -1;
+    }
+    pos = a;
+  }
+
+  for (cli_arg_t const *a = next_positional(schema, pos); a; a = next_positional(schema, a)) {
+    if (!a->optional) {
+      fprintf(stderr, "%s: missing argument %s\n", cmd, a->name);
+      return -1;
+    }
+  }
+  return 0;
+}
+
+void cli_args_print_glossary(cli_arg_t const schema[]) {
+  char opt[64];
+  for (cli_arg_t const *a = schema; a && a->type != CLI_ARG_END; a++) {
+    if (a->type == CLI_ARG_FLAG) {
+      if (a->short_opt && a->name) {
+        snprintf(opt, sizeof(opt), "-%c, --%s", a->short_opt, a->name);
+      } else if (a->short_opt) {
+        snprintf(opt, sizeof(opt), "-%c", a->short_opt);
+      } else {
+        snprintf(opt, sizeof(opt), "--%s", a->name);
+      }
+      printf("  %12s  %s\n", opt, a->help ? a->help : "");
+    } else {
+      printf("  %12s  %s\n", a->name, a->help ? a->help : "");
+    }
+  }
+}
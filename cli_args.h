@@ -0,0 +1,99 @@
+#ifndef __CLI_ARGS_H__
+#define __CLI_ARGS_H__
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief Types of command arguments and the C types of their parsed values
+ *
+ */
+typedef enum {
+  CLI_ARG_END = 0, /*!< the end of a schema */
+  CLI_ARG_STR,     /*!< char const *, it points into argv */
+  CLI_ARG_HEX,     /*!< char const *, a hex string of a fixed length */
+  CLI_ARG_BECH32,  /*!< char const *, a bech32 ed25519 address with a valid checksum */
+  CLI_ARG_U32,     /*!< uint32_t, a decimal in a range */
+  CLI_ARG_U64,     /*!< uint64_t, a decimal in a range */
+  CLI_ARG_BOOL,    /*!< bool, 0 or 1 */
+  CLI_ARG_FLAG,    /*!< bool, an option without a value, e.g. -r or --remote */
+} cli_arg_type_t;
+
+/**
+ * @brief An argument of a command schema, schemas are arrays ended by CLI_ARGS_END
+ *
+ * Positional arguments are matched in order, flags anywhere before "--". Use the CLI_ARG_* macros, they check the
+ * field type of the parsed struct at compile time.
+ *
+ */
+typedef struct {
+  cli_arg_type_t type;
+  char const *name; /*!< "<port>" of positional arguments, the long option of flags */
+  char short_opt;   /*!< the short option of flags, 0 if none */
+  char const *help;
+  bool optional;
+  size_t offset; /*!< offset of the value in the parsed struct */
+  uint64_t min;  /*!< min value of integers, length of hex strings */
+  uint64_t max;  /*!< max value of integers, length of hex strings */
+  uint64_t def;  /*!< default value of optional integers */
+} cli_arg_t;
+
+// offset of a field of the parsed struct, it doesn't compile if the field is not of the C type
+#define CLI_ARG_FIELD(st, field, ctype) (offsetof(st, field) + 0 * sizeof(&((st *)0)->field - (ctype *)0))
+
+#define CLI_ARG_ENTRY(t, opt, st, field, ctype, nm, so, hl, lo, hi, dv) \
+  { (t), (nm), (so), (hl), (opt), CLI_ARG_FIELD(st, field, ctype), (lo), (hi), (dv) }
+
+#define CLI_ARG_STR(st, field, nm, hl) CLI_ARG_ENTRY(CLI_ARG_STR, false, st, field, char const *, nm, 0, hl, 0, 0, 0)
+#define CLI_ARG_STR_OPT(st, field, nm, hl) \
+  CLI_ARG_ENTRY(CLI_ARG_STR, true, st, field, char const *, nm, 0, hl, 0, 0, 0)
+// a hex string of len characters
+#define CLI_ARG_HEX(st, field, nm, hl, len) \
+  CLI_ARG_ENTRY(CLI_ARG_HEX, false, st, field, char const *, nm, 0, hl, len, len, 0)
+#define CLI_ARG_BECH32(st, field, nm, hl) \
+  CLI_ARG_ENTRY(CLI_ARG_BECH32, false, st, field, char const *, nm, 0, hl, 0, 0, 0)
+#define CLI_ARG_U32(st, field, nm, hl, lo, hi) \
+  CLI_ARG_ENTRY(CLI_ARG_U32, false, st, field, uint32_t, nm, 0, hl, lo, hi, 0)
+#define CLI_ARG_U32_OPT(st, field, nm, hl, lo, hi, dv) \
+  CLI_ARG_ENTRY(CLI_ARG_U32, true, st, field, uint32_t, nm, 0, hl, lo, hi, dv)
+#define CLI_ARG_U64(st, field, nm, hl, lo, hi) \
+  CLI_ARG_ENTRY(CLI_ARG_U64, false, st, field, uint64_t, nm, 0, hl, lo, hi, 0)
+#define CLI_ARG_U64_OPT(st, field, nm, hl, lo, hi, dv) \
+  CLI_ARG_ENTRY(CLI_ARG_U64, true, st, field, uint64_t, nm, 0, hl, lo, hi, dv)
+#define CLI_ARG_BOOL(st, field, nm, hl) CLI_ARG_ENTRY(CLI_ARG_BOOL, false, st, field, bool, nm, 0, hl, 0, 1, 0)
+// an option, e.g. CLI_ARG_FLAG(st, remote, 'r', "remote", "PoW on the node") for -r and --remote
+#define CLI_ARG_FLAG(st, field, so, lo, hl) CLI_ARG_ENTRY(CLI_ARG_FLAG, true, st, field, bool, lo, so, hl, 0, 0, 0)
+#define CLI_ARGS_END \
+  { CLI_ARG_END }
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Parse arguments of a command into its parsed struct
+ *
+ * Fields of absent optional arguments get their defaults, NULL for strings. Errors are printed to stderr. It only
+ * writes to the parsed struct, commands can be parsed on multiple threads.
+ *
+ * @param schema the arguments of the command
+ * @param argc number of arguments, argv[0] is the command name
+ * @param argv the arguments, string values point into it
+ * @param parsed the parsed struct of the command
+ * @return int 0 on success, -1 on an invalid argument
+ */
+int cli_args_parse(cli_arg_t const schema[], int argc, char **argv, void *parsed);
+
+/**
+ * @brief Print a line per argument, the name and the help text
+ *
+ * @param schema the arguments of the command
+ */
+void cli_args_print_glossary(cli_arg_t const schema[]);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // __CLI_ARGS_H__
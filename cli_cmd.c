@@ -1,13 +1,32 @@
 #include <ctype.h>
+#include <errno.h>
 #include <inttypes.h>
+#include <pthread.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <sys/stat.h>
 #include <time.h>
+#include <unistd.h>
 
-#include "argtable3.h"
+#include "cli_addr_cache.h"
+#include "cli_arena.h"
 #include "cli_cmd.h"
+#include "cli_codec.h"
+#include "cli_http.h"
+#include "cli_idset.h"
+#include "cli_msg.h"
+#include "cli_msg_store.h"
+#include "cli_out.h"
+#include "cli_parallel.h"
+#include "cli_pow.h"
+#include "cli_resp_cache.h"
+#include "cli_split.h"
+#include "cli_stats.h"
+#include "cli_tip_pool.h"
+#include "cli_trie.h"
 #include "utarray.h"
+#include "uthash.h"
 
 #include "client/api/v1/find_message.h"
 #include "client/api/v1/get_balance.h"
@@ -20,6 +39,7 @@
 #include "client/api/v1/get_tips.h"
 #include "client/api/v1/send_message.h"
 #include "core/utils/byte_buffer.h"
+#include "crypto/iota_crypto.h"
 #include "wallet/bip39.h"
 #include "wallet/wallet.h"
 
@@ -27,14 +47,72 @@
 #define CMDER_VERSION_MINOR 0
 #define CMDER_VERSION_MICRO 1
 
+// command index, maps a command name to its position in the command array
+typedef struct {
+  char const *name; /*!< the command name, owned by the command array */
+  unsigned idx;     /*!< index of the command in cmd_array */
+  UT_hash_handle hh;
+} cli_cmd_index_t;
+
+// results of the node handshake
+typedef struct {
+  char name[32];          /*!< node software name */
+  char version[32];       /*!< node software version */
+  bool is_healthy;        /*!< health of the node */
+  char network_id[32];    /*!< network name */
+  char hrp[16];           /*!< bech32 HRP of the network */
+  uint64_t min_pow_score; /*!< min PoW score of messages */
+  char error[128];        /*!< error response of the node */
+} node_params_t;
+
+// resources initialized in the background on startup, commands wait for the ones they need
+typedef struct {
+  pthread_mutex_t lock;
+  pthread_cond_t cond;
+  pthread_t threads[2];        /*!< the seed derivation and the node handshake */
+  size_t threads_len;          /*!< number of started threads */
+  uint32_t ready;              /*!< CLI_NEED_* done, successfully or not */
+  uint32_t failed;             /*!< CLI_NEED_* failed */
+  uint32_t synced;             /*!< CLI_NEED_* applied to the context by the command thread */
+  char mnemonic[256];          /*!< mnemonic sentence, it's cleared once the seed is derived */
+  iota_wallet_t *wallet;       /*!< the wallet, NULL if it's failed */
+  iota_client_conf_t endpoint; /*!< the configured node */
+  node_params_t node;          /*!< results of the node handshake */
+  int node_err;                /*!< error of the node handshake */
+  uint32_t node_gen;           /*!< bumped by node_set, the result of a handshake started before is dropped */
+  uint64_t start_ns;           /*!< start time of cli_command_init */
+  uint64_t prompt_ns;          /*!< time to accept commands */
+  uint64_t wallet_ns;          /*!< time to derive the seed */
+  uint64_t node_ns;            /*!< time of the node handshake */
+} cli_startup_t;
+
 typedef struct {
   iota_wallet_t *wallet;
-  char *parsing_buf;   /*!< buffer for command line parsing */
-  UT_array *cmd_array; /*!< an array of registed commands */
+  cli_arena_t arena;               /*!< the command line, argv and other memory of the running command */
+  UT_array *cmd_array;             /*!< an array of registed commands */
+  cli_cmd_index_t *cmd_index;      /*!< a hash index of registed commands */
+  cli_trie_t *cmd_trie;            /*!< a prefix trie of command names */
+  cli_trie_t *value_trie;          /*!< a prefix trie of IDs and addresses seen in this session */
+  char hint_buf[CLI_TRIE_KEY_MAX]; /*!< the rest of a hinted value */
+  cli_http_pool_t http;            /*!< keep-alive connections to the connected node */
+  cli_addr_cache_t addr_cache;     /*!< derived addresses of the wallet seed */
+  cli_resp_cache_t resp_cache;     /*!< node responses of immutable objects */
+  cli_msg_store_t *msg_store;      /*!< messages of the network on disk, NULL if it's not available */
+  char data_dir[CLI_PATH_MAX];     /*!< directory of the message stores, empty if they're disabled */
+  bool data_dir_set;               /*!< data_dir is set by cli_command_set_data_dir */
+  bool stdin_reserved;             /*!< commands are read from stdin, commands don't read data from it */
+  cli_tip_pool_t tip_pool;         /*!< tips refreshed in the background */
+  cli_stats_t stats;               /*!< latency of commands and node API calls */
+  uint64_t min_pow_score;          /*!< min PoW score of the connected node */
+  char network_id[32];             /*!< network name of the connected node, empty if it's unknown */
+  cli_startup_t startup;           /*!< the background startup */
 } cli_ctx_t;
 
 static cli_ctx_t cli_ctx;
 
+// API calls of background threads are not counted in the network time of commands
+static __thread bool api_in_background;
+
 static char const *amazon_ca1_pem =
     "-----BEGIN CERTIFICATE-----\r\n"
     "MIIDQTCCAimgAwIBAgITBmyfz5m/jAo54vB4ikPmljZbyjANBgkqhkiG9w0BAQsF\r\n"
@@ -57,35 +135,41 @@ static char const *amazon_ca1_pem =
     "rqXRfboQnoZsG4q5WTP468SQvvG5\r\n"
     "-----END CERTIFICATE-----\r\n";
 
-static int update_node_config(iota_wallet_t *w, char const host[], uint32_t port, bool tls) {
-  // set connected node
-  if (wallet_set_endpoint(w, host, port, tls) != 0) {
-    printf("set endpoint failed\n");
-    return -1;
-  }
-
-  // get node info and update HRP prefix
+// get node info, it only uses the connection pool of the context so it's called by any thread
+static int node_probe(iota_client_conf_t const *endpoint, node_params_t *params) {
+  memset(params, 0, sizeof(node_params_t));
   res_node_info_t *info = res_node_info_new();
   if (info == NULL) {
     return -2;
   }
 
-  cli_err_t ret = get_node_info(&w->endpoint, info);
-  if (ret != 0) {
-    printf("get_node_info API failed: %s:%d, TSL: %s\n", w->endpoint.host, w->endpoint.port,
-           w->endpoint.use_tls ? "true" : "false");
-  } else {
-    printf("Connected to %s:%d, TSL: %s\n", w->endpoint.host, w->endpoint.port, w->endpoint.use_tls ? "true" : "false");
+  byte_buf_t *json = byte_buf_new();
+  if (json == NULL) {
+    res_node_info_free(info);
+    return -2;
+  }
+
+  // on the timeouts of the pool, the endpoint is not the one of the pool until it's probed
+  uint64_t start = cli_stats_api_begin(&cli_ctx.stats, !api_in_background);
+  int ret = cli_http_get_endpoint(&cli_ctx.http, endpoint->host, endpoint->port, endpoint->use_tls, "/api/v1/info",
+                                  json, NULL);
+  cli_stats_api(&cli_ctx.stats, "GET /api/v1/info", cli_stats_now_ns() - start, ret != 0, !api_in_background);
+  if (ret == 0) {
+    ret = deser_node_info((char const *)json->data, info);
+  }
+  byte_buf_free(json);
+  if (ret == 0) {
     if (info->is_error) {
-      printf("Node response: \n%s\n", info->u.error->msg);
+      strncpy(params->error, info->u.error->msg, sizeof(params->error) - 1);
       ret = -3;
     } else {
-      printf("\tName: %s\n", info->u.output_node_info->name);
-      printf("\tVersion: %s\n", info->u.output_node_info->version);
-      printf("\tisHealthy: %s\n", info->u.output_node_info->is_healthy ? "true" : "false");
-      printf("\tNetwork ID: %s\n", info->u.output_node_info->network_id);
-      printf("\tbech32HRP: %s\n", info->u.output_node_info->bech32hrp);
-      strncpy(w->bech32HRP, info->u.output_node_info->bech32hrp, sizeof(w->bech32HRP));
+      get_node_info_t const *node = info->u.output_node_info;
+      strncpy(params->name, node->name, sizeof(params->name) - 1);
+      strncpy(params->version, node->version, sizeof(params->version) - 1);
+      params->is_healthy = node->is_healthy;
+      strncpy(params->network_id, node->network_id, sizeof(params->network_id) - 1);
+      strncpy(params->hrp, node->bech32hrp, sizeof(params->hrp) - 1);
+      params->min_pow_score = node->min_pow_score;
     }
   }
 
@@ -93,303 +177,1036 @@ static int update_node_config(iota_wallet_t *w, char const host[], uint32_t port
   return ret;
 }
 
-static cli_err_t cli_wallet_init() {
-  // mnemonic sentence buffer
-  char ms_buf[256] = {};
-  printf("Init client application...\n");
+static void node_params_print(iota_client_conf_t const *endpoint, node_params_t const *params, int err) {
+  if (err != 0 && err != -3) {
+    printf("get_node_info API failed: %s:%d, TSL: %s\n", endpoint->host, endpoint->port,
+           endpoint->use_tls ? "true" : "false");
+    return;
+  }
+  printf("Connected to %s:%d, TSL: %s\n", endpoint->host, endpoint->port, endpoint->use_tls ? "true" : "false");
+  if (err != 0) {
+    printf("Node response: \n%s\n", params->error);
+    return;
+  }
+  printf("\tName: %s\n", params->name);
+  printf("\tVersion: %s\n", params->version);
+  printf("\tisHealthy: %s\n", params->is_healthy ? "true" : "false");
+  printf("\tNetwork ID: %s\n", params->network_id);
+  printf("\tbech32HRP: %s\n", params->hrp);
+  printf("\tminPowScore: %" PRIu64 "\n", params->min_pow_score);
+}
 
-  if (strncmp(WALLET_CONFIG_MNEMONIC, "RANDOM", strlen("RANDOM")) == 0) {
-    printf("generating new mnemonic sentence\n");
-    mnemonic_generator(MS_ENTROPY_256, MS_LAN_EN, ms_buf, sizeof(ms_buf));
-    printf("###\n%s\n###\n", ms_buf);
-    // init wallet instance with random mnemonic
-    if ((cli_ctx.wallet = wallet_create(ms_buf, "", 0)) == NULL) {
-      printf("create wallet instance failed\n");
-      return CLI_ERR_FAILED;
-    }
-  } else {
-    // init wallet instance with default mnemonic
-    if ((cli_ctx.wallet = wallet_create(WALLET_CONFIG_MNEMONIC, "", 0)) == NULL) {
-      printf("create wallet instance failed\n");
-      return CLI_ERR_FAILED;
+// create a directory and its parents
+static int make_dirs(char const dir[]) {
+  char path[CLI_PATH_MAX] = {};
+  if (strlen(dir) >= sizeof(path)) {
+    return -1;
+  }
+  strcpy(path, dir);
+  for (char *p = path + 1; *p; p++) {
+    if (*p == '/') {
+      *p = '\0';
+      if (mkdir(path, 0700) != 0 && errno != EEXIST) {
+        return -1;
+      }
+      *p = '/';
     }
   }
+  return mkdir(path, 0700) != 0 && errno != EEXIST ? -1 : 0;
+}
 
-  if (update_node_config(cli_ctx.wallet, CLIENT_CONFIG_NODE, CLIENT_CONFIG_PORT, NODE_USE_TLS) != 0) {
-    printf("connect to node failed\n");
-    wallet_destroy(cli_ctx.wallet);
-    cli_ctx.wallet = NULL;
-    return CLI_ERR_FAILED;
+// the directory of the message stores unless it's set by cli_command_set_data_dir, empty if there is none
+static void data_dir_default(char dir[], size_t len) {
+  char const *env = getenv(CLI_DATA_DIR_ENV);
+  char const *xdg = getenv("XDG_DATA_HOME");
+  char const *home = getenv("HOME");
+  int n = 0;
+  if (env) {
+    n = snprintf(dir, len, "%s", env);
+  } else if (xdg && xdg[0] == '/') {
+    n = snprintf(dir, len, "%s/%s", xdg, CLI_DATA_DIR_NAME);
+  } else if (home && home[0] == '/') {
+    n = snprintf(dir, len, "%s/.local/share/%s", home, CLI_DATA_DIR_NAME);
+  }
+  if (n < 0 || (size_t)n >= len) {
+    dir[0] = '\0';
   }
-  printf("Init client application...done\n");
-  return CLI_OK;
 }
 
-static void cmd_icd_copy(void *_dst, const void *_src) {
-  cli_cmd_t *dst = (cli_cmd_t *)_dst, *src = (cli_cmd_t *)_src;
-  dst->command = src->command ? strdup(src->command) : NULL;
-  dst->help = src->help ? strdup(src->help) : NULL;
-  dst->hint = src->hint ? strdup(src->hint) : NULL;
-  dst->func = src->func;
-  dst->argtable = src->argtable;
-}
+// open the message store of the network, messages of a network are not served for another one
+static void msg_store_switch(char const network_id[]) {
+  char path[CLI_PATH_MAX] = {};
+  char name[sizeof(cli_ctx.network_id)] = {};
 
-static void cmd_icd_dtor(void *_elt) {
-  cli_cmd_t *elt = (cli_cmd_t *)_elt;
-  if (elt->command) {
-    free(elt->command);
+  if (cli_ctx.data_dir[0] == '\0' || network_id[0] == '\0') {
+    cli_msg_store_close(cli_ctx.msg_store);
+    cli_ctx.msg_store = NULL;
+    return;
   }
-  if (elt->help) {
-    free(elt->help);
+  // the network name is a part of the file name
+  for (size_t i = 0; network_id[i] && i < sizeof(name) - 1; i++) {
+    name[i] = isalnum((unsigned char)network_id[i]) || strchr("-_.", network_id[i]) ? network_id[i] : '_';
   }
-  if (elt->hint) {
-    free(elt->hint);
+  int n = snprintf(path, sizeof(path), "%s/msg_%s.db", cli_ctx.data_dir, name);
+  if (n < 0 || (size_t)n >= sizeof(path)) {
+    path[0] = '\0';
+  }
+  if (cli_ctx.msg_store && strcmp(cli_msg_store_path(cli_ctx.msg_store), path) == 0) {
+    return;
+  }
+
+  cli_msg_store_close(cli_ctx.msg_store);
+  cli_ctx.msg_store = NULL;
+  // works without the store
+  if (path[0] == '\0' || make_dirs(cli_ctx.data_dir) != 0 ||
+      (cli_ctx.msg_store = cli_msg_store_open(path)) == NULL) {
+    printf("message store is not available: %s\n", path[0] ? path : cli_ctx.data_dir);
   }
 }
 
-UT_icd cli_cmd_icd = {sizeof(cli_cmd_t), NULL, cmd_icd_copy, cmd_icd_dtor};
+// update HRP prefix and the network, the wallet can be NULL. It's called by the command thread without running
+// tasks, the message store is switched to the one of the network.
+static void node_params_apply(iota_wallet_t *w, node_params_t const *params) {
+  if (w) {
+    strncpy(w->bech32HRP, params->hrp, sizeof(w->bech32HRP));
+  }
+  // messages are built and PoWed locally for this network
+  cli_ctx.min_pow_score = params->min_pow_score;
+  strncpy(cli_ctx.network_id, params->network_id, sizeof(cli_ctx.network_id) - 1);
+  msg_store_switch(cli_ctx.network_id);
+}
 
-void completion_callback(char const *buf, linenoiseCompletions *lc) {
-  size_t len = strlen(buf);
-  cli_cmd_t *cmd_p = NULL;
-  if (len == 0) {
-    return;
+static int update_node_config(iota_wallet_t *w, char const host[], uint32_t port, bool tls) {
+  // set connected node
+  if (wallet_set_endpoint(w, host, port, tls) != 0) {
+    printf("set endpoint failed\n");
+    return -1;
   }
 
-  while ((cmd_p = (cli_cmd_t *)utarray_next(cli_ctx.cmd_array, cmd_p))) {
-    if (strncmp(buf, cmd_p->command, len) == 0) {
-      linenoiseAddCompletion(lc, cmd_p->command);
+  node_params_t params;
+  int ret = node_probe(&w->endpoint, &params);
+  node_params_print(&w->endpoint, &params, ret);
+  if (ret == 0) {
+    node_params_apply(w, &params);
+  }
+  return ret;
+}
+
+// record a node API call, parameters of the path are replaced with '*' so calls of an API share the statistics
+static void api_stats_record(char const method[], char const path_fmt[], uint64_t ns, bool failed) {
+  char name[CLI_STATS_NAME_MAX] = {};
+  size_t n = (size_t)snprintf(name, sizeof(name), "%s ", method);
+  for (char const *p = path_fmt; *p && n < sizeof(name) - 1; p++) {
+    if (p[0] == '%' && p[1] == 's') {
+      name[n++] = '*';
+      p++;
+    } else {
+      name[n++] = *p;
     }
   }
+  cli_stats_api(&cli_ctx.stats, name, ns, failed, !api_in_background);
 }
 
-char *hints_callback(char const *buf, int *color, int *bold) {
-  size_t len = strlen(buf);
-  cli_cmd_t *cmd_p = NULL;
-  if (len == 0) {
+// GET a JSON response from the connected node through the connection pool, the caller must free the buffer.
+static byte_buf_t *node_api_get(char const path_fmt[], char const *param) {
+  char path[256] = {};
+  int n = snprintf(path, sizeof(path), path_fmt, param);
+  if (n < 0 || (size_t)n >= sizeof(path)) {
+    printf("invalid API parameter\n");
     return NULL;
   }
 
-  while ((cmd_p = (cli_cmd_t *)utarray_next(cli_ctx.cmd_array, cmd_p))) {
-    if (strlen(cmd_p->command) == len && strncmp(buf, cmd_p->command, len) == 0) {
-      *color = HINT_COLOR_GREEN;
-      *bold = 0;
-      return cmd_p->hint;
-    }
+  byte_buf_t *json = byte_buf_new();
+  if (json == NULL) {
+    return NULL;
   }
-  return NULL;
+
+  // error responses are deserialized by the APIs
+  uint64_t start = cli_stats_api_begin(&cli_ctx.stats, !api_in_background);
+  int ret = cli_http_get(&cli_ctx.http, path, json, NULL);
+  api_stats_record("GET", path_fmt, cli_stats_now_ns() - start, ret != 0);
+  if (ret != 0) {
+    byte_buf_free(json);
+    return NULL;
+  }
+  return json;
 }
 
-void to_uppercase(char *sPtr, int nchar) {
-  for (int i = 0; i < nchar; i++) {
-    char *element = sPtr + i;
-    *element = toupper((unsigned char)*element);
+static int api_node_info(res_node_info_t *res) {
+  byte_buf_t *json = node_api_get("/api/v1/info", NULL);
+  if (json == NULL) {
+    return -1;
   }
+  int ret = deser_node_info((char const *)json->data, res);
+  byte_buf_free(json);
+  return ret;
 }
 
-//==========COMMANDS==========
+static int api_tips(res_tips_t *res) {
+  byte_buf_t *json = node_api_get("/api/v1/tips", NULL);
+  if (json == NULL) {
+    return -1;
+  }
+  int ret = deser_get_tips((char const *)json->data, res);
+  byte_buf_free(json);
+  return ret;
+}
 
-/* 'help' command */
-static cli_err_t fn_help(int argc, char **argv) {
-  cli_cmd_t *cmd_p = NULL;
+static int api_message(char const msg_id[], res_message_t *res) {
+  char *cached = cli_resp_cache_get(&cli_ctx.resp_cache, CLI_RESP_MSG, msg_id);
+  if (cached) {
+    int ret = deser_get_message(cached, res);
+    free(cached);
+    return ret;
+  }
 
-  while ((cmd_p = (cli_cmd_t *)utarray_next(cli_ctx.cmd_array, cmd_p))) {
-    char const *help = (cmd_p->help) ? cmd_p->help : "";
-    if (cmd_p->hint != NULL) {
-      printf("- %s %s\n", cmd_p->command, cmd_p->hint);
-      printf("    %s\n", cmd_p->help);
-    } else {
-      printf("- %s %s\n", cmd_p->command, help);
-    }
-    if (cmd_p->argtable) {
-      arg_print_glossary(stdout, (void **)cmd_p->argtable, "  %12s  %s\n");
+  // messages of previous sessions
+  if ((cached = cli_msg_store_get(cli_ctx.msg_store, msg_id)) != NULL) {
+    int ret = deser_get_message(cached, res);
+    if (ret == 0 && !res->is_error) {
+      cli_resp_cache_put(&cli_ctx.resp_cache, CLI_RESP_MSG, msg_id, cached, strlen(cached));
     }
-    printf("\n");
+    free(cached);
+    return ret;
   }
-  return CLI_OK;
+
+  byte_buf_t *json = node_api_get("/api/v1/messages/%s", msg_id);
+  if (json == NULL) {
+    return -1;
+  }
+  int ret = deser_get_message((char const *)json->data, res);
+  // messages are immutable
+  if (ret == 0 && !res->is_error) {
+    size_t len = strlen((char const *)json->data);
+    cli_resp_cache_put(&cli_ctx.resp_cache, CLI_RESP_MSG, msg_id, (char const *)json->data, len);
+    cli_msg_store_put(cli_ctx.msg_store, msg_id, (char const *)json->data, len);
+  }
+  byte_buf_free(json);
+  return ret;
 }
 
-static void register_help() {
-  cli_cmd_t cmd = {
-      .command = "help",
-      .help = "Show this help",
-      .hint = NULL,
-      .func = &fn_help,
-      .argtable = NULL,
-  };
+static int api_msg_meta(char const msg_id[], res_msg_meta_t *res) {
+  char *cached = cli_resp_cache_get(&cli_ctx.resp_cache, CLI_RESP_META, msg_id);
+  if (cached) {
+    int ret = parse_messages_metadata(cached, res);
+    free(cached);
+    return ret;
+  }
 
-  utarray_push_back(cli_ctx.cmd_array, &cmd);
+  byte_buf_t *json = node_api_get("/api/v1/messages/%s/metadata", msg_id);
+  if (json == NULL) {
+    return -1;
+  }
+  int ret = parse_messages_metadata((char const *)json->data, res);
+  if (ret == 0 && !res->is_error) {
+    // metadata is final once the message is referenced by a milestone
+    if (res->u.meta->referenced_milestone != 0) {
+      cli_resp_cache_put(&cli_ctx.resp_cache, CLI_RESP_META, msg_id, (char const *)json->data,
+                         strlen((char const *)json->data));
+    } else {
+      cli_resp_cache_refuse(&cli_ctx.resp_cache, CLI_RESP_META);
+    }
+  }
+  byte_buf_free(json);
+  return ret;
 }
 
-/* 'version' command */
-static cli_err_t fn_version(int argc, char **argv) {
-  printf("TODO\n");
-  return CLI_OK;
+static int api_msg_children(char const msg_id[], res_msg_children_t *res) {
+  byte_buf_t *json = node_api_get("/api/v1/messages/%s/children", msg_id);
+  if (json == NULL) {
+    return -1;
+  }
+  int ret = deser_msg_children((char const *)json->data, res);
+  byte_buf_free(json);
+  return ret;
 }
 
-static void register_version() {
-  cli_cmd_t cmd = {
-      .command = "version",
-      .help = "Show version info",
-      .hint = NULL,
-      .func = &fn_version,
-      .argtable = NULL,
-  };
-
-  utarray_push_back(cli_ctx.cmd_array, &cmd);
-}
+static int api_output(char const output_id[], res_output_t *res) {
+  char *cached = cli_resp_cache_get(&cli_ctx.resp_cache, CLI_RESP_OUTPUT, output_id);
+  if (cached) {
+    int ret = deser_get_output(cached, res);
+    free(cached);
+    return ret;
+  }
 
-/* 'node_info' command */
-static cli_err_t fn_node_info(int argc, char **argv) {
-  res_node_info_t *info = res_node_info_new();
-  if (!info) {
-    return CLI_ERR_OOM;
+  byte_buf_t *json = node_api_get("/api/v1/outputs/%s", output_id);
+  if (json == NULL) {
+    return -1;
   }
-  cli_err_t ret = get_node_info(&cli_ctx.wallet->endpoint, info);
-  if (ret != 0) {
-    printf("get_node_info failed\n");
-  } else {
-    if (info->is_error) {
-      printf("Node response: \n%s\n", info->u.error->msg);
+  int ret = deser_get_output((char const *)json->data, res);
+  if (ret == 0 && !res->is_error) {
+    // an unspent output will be spent
+    if (res->u.output.is_spent) {
+      cli_resp_cache_put(&cli_ctx.resp_cache, CLI_RESP_OUTPUT, output_id, (char const *)json->data,
+                         strlen((char const *)json->data));
     } else {
-      printf("Name: %s\n", info->u.output_node_info->name);
-      printf("Version: %s\n", info->u.output_node_info->version);
-      printf("isHealthy: %s\n", info->u.output_node_info->is_healthy ? "true" : "false");
-      printf("Network ID: %s\n", info->u.output_node_info->network_id);
-      printf("bech32HRP: %s\n", info->u.output_node_info->bech32hrp);
-      printf("minPoWScore: %" PRIu64 "\n", info->u.output_node_info->min_pow_score);
-      printf("Latest Milestone Index: %" PRIu64 "\n", info->u.output_node_info->latest_milestone_index);
-      printf("Latest Milestone Timestamp: %" PRIu64 "\n", info->u.output_node_info->latest_milestone_timestamp);
-      printf("Confirmed Milestone Index: %" PRIu64 "\n", info->u.output_node_info->confirmed_milestone_index);
-      printf("Pruning Index: %" PRIu64 "\n", info->u.output_node_info->pruning_milestone_index);
-      printf("MSP: %0.2f\n", info->u.output_node_info->msg_pre_sec);
-      printf("Referenced MPS: %0.2f\n", info->u.output_node_info->referenced_msg_pre_sec);
-      printf("Reference Rate: %0.2f%%\n", info->u.output_node_info->referenced_rate);
+      cli_resp_cache_refuse(&cli_ctx.resp_cache, CLI_RESP_OUTPUT);
     }
   }
-
-  res_node_info_free(info);
+  byte_buf_free(json);
   return ret;
 }
 
-static void register_node_info() {
-  cli_cmd_t cmd = {
-      .command = "node_info",
-      .help = "Shows node info",
-      .hint = NULL,
-      .func = &fn_node_info,
-      .argtable = NULL,
-  };
-  utarray_push_back(cli_ctx.cmd_array, &cmd);
+static int api_balance(char const bech32_addr[], res_balance_t *res) {
+  byte_buf_t *json = node_api_get("/api/v1/addresses/%s", bech32_addr);
+  if (json == NULL) {
+    return -1;
+  }
+  int ret = deser_balance_info((char const *)json->data, res);
+  byte_buf_free(json);
+  return ret;
 }
 
-/* 'info_set' command */
-static struct {
-  struct arg_str *host;
-  struct arg_int *port;
-  struct arg_int *is_https;
-  struct arg_end *end;
-} node_set_args;
+static int api_address_outputs(char const bech32_addr[], bool include_spent, res_outputs_address_t *res) {
+  byte_buf_t *json = node_api_get(
+      include_spent ? "/api/v1/addresses/%s/outputs?include-spent=true" : "/api/v1/addresses/%s/outputs", bech32_addr);
+  if (json == NULL) {
+    return -1;
+  }
+  int ret = deser_outputs_from_address((char const *)json->data, res);
+  byte_buf_free(json);
+  return ret;
+}
 
-static cli_err_t fn_node_set(int argc, char **argv) {
-  int nerrors = arg_parse(argc, argv, (void **)&node_set_args);
-  if (nerrors != 0) {
-    arg_print_errors(stderr, node_set_args.end, argv[0]);
-    return CLI_ERR_INVALID_ARG;
+static int api_find_msg_index(char const index[], res_find_msg_t *res) {
+  size_t len = strlen(index);
+  char *hex = malloc(len * 2 + 1);
+  if (hex == NULL) {
+    return -1;
+  }
+  cli_hex_encode((uint8_t const *)index, len, hex);
+  byte_buf_t *json = node_api_get("/api/v1/messages?index=%s", hex);
+  free(hex);
+  if (json == NULL) {
+    return -1;
   }
+  int ret = deser_find_message((char const *)json->data, res);
+  byte_buf_free(json);
+  return ret;
+}
 
-  // create a new wallet config
-  iota_wallet_t w = {};
-  memcpy(&w, cli_ctx.wallet, sizeof(iota_wallet_t));
+// POST a message to the connected node, a serialized message or a JSON one the node completes
+static int api_post_message(char const content_type[], byte_t const msg[], size_t len, res_send_message_t *res) {
+  byte_buf_t *json = byte_buf_new();
+  if (json == NULL) {
+    return -1;
+  }
+  uint64_t start = cli_stats_api_begin(&cli_ctx.stats, !api_in_background);
+  int ret = cli_http_post(&cli_ctx.http, "/api/v1/messages", content_type, msg, len, json, NULL);
+  api_stats_record("POST", "/api/v1/messages", cli_stats_now_ns() - start, ret != 0);
+  if (ret == 0) {
+    ret = deser_send_message_response((char const *)json->data, res);
+  }
+  byte_buf_free(json);
+  return ret;
+}
 
-  if (update_node_config(&w, node_set_args.host->sval[0], node_set_args.port->ival[0],
-                         node_set_args.is_https->ival[0]) == 0) {
-    // update wallet config
-    memcpy(cli_ctx.wallet, &w, sizeof(iota_wallet_t));
-  } else {
-    printf("Node config is not updated.\n");
+// fetch tips from the node
+static size_t fetch_tips(char tips[][CLI_TIP_ID_BUF], size_t max) {
+  size_t n = 0;
+  res_tips_t *res = res_tips_new();
+  if (res == NULL) {
+    return 0;
   }
-  return CLI_OK;
+  if (api_tips(res) == 0 && !res->is_error) {
+    n = get_tips_id_count(res) < max ? get_tips_id_count(res) : max;
+    for (size_t i = 0; i < n; i++) {
+      strncpy(tips[i], get_tips_id(res, i), CLI_TIP_ID_BUF - 1);
+      tips[i][CLI_TIP_ID_BUF - 1] = '\0';
+    }
+  }
+  res_tips_free(res);
+  return n;
 }
 
-static void register_node_set() {
-  node_set_args.host = arg_str1(NULL, NULL, "<host>", "hostname");
-  node_set_args.port = arg_int1(NULL, NULL, "<port>", "port number");
-  node_set_args.is_https = arg_int1(NULL, NULL, "<is_https>", "0 or 1");
-  node_set_args.end = arg_end(5);
+// fetch tips for the tip pool, it's called by the refresher thread
+static size_t tip_pool_fetch(void *ctx, char tips[][CLI_TIP_ID_BUF], size_t max) {
+  api_in_background = true;
+  return fetch_tips(tips, max);
+}
 
-  cli_cmd_t cmd = {
-      .command = "node_set",
-      .help = "Set connected node",
-      .hint = " <host> <port> <is_https (0|1)> ",
-      .func = &fn_node_set,
-      .argtable = &node_set_args,
-  };
+// get parents from the tip pool, or from the node if the pool is empty or stale
+static size_t get_parents(char parents[][CLI_TIP_ID_BUF], size_t max) {
+  size_t n = cli_tip_pool_get(&cli_ctx.tip_pool, parents, max);
+  if (n > 0) {
+    return n;
+  }
 
-  utarray_push_back(cli_ctx.cmd_array, &cmd);
+  char(*tips)[CLI_TIP_ID_BUF] = malloc(CLI_TIP_POOL_MAX * CLI_TIP_ID_BUF);
+  if (tips == NULL) {
+    return 0;
+  }
+  size_t len = fetch_tips(tips, CLI_TIP_POOL_MAX);
+  cli_tip_pool_update(&cli_ctx.tip_pool, (char const(*)[CLI_TIP_ID_BUF])tips, len);
+  n = len < max ? len : max;
+  memcpy(parents, tips, n * CLI_TIP_ID_BUF);
+  free(tips);
+  return n;
 }
 
-/* 'node_conf' command */
-static cli_err_t fn_node_conf(int argc, char **argv) {
-  printf("Host: %s:%d, TLS: %s\n", cli_ctx.wallet->endpoint.host, cli_ctx.wallet->endpoint.port,
-         cli_ctx.wallet->endpoint.use_tls ? "true" : "false");
-  printf("HRP: %s\n", cli_ctx.wallet->bech32HRP);
-  return CLI_OK;
+static void tip_pool_start() {
+  if (cli_tip_pool_start(&cli_ctx.tip_pool, tip_pool_fetch, NULL, CLI_TIP_REFRESH_MS, CLI_TIP_MAX_AGE_MS) != 0) {
+    // tips are fetched on sending
+    printf("tip pool is not available\n");
+  }
 }
 
-static void register_node_conf() {
-  cli_cmd_t cmd = {
-      .command = "node_conf",
-      .help = "Show connected node configuration",
-      .hint = NULL,
-      .func = &fn_node_conf,
-      .argtable = NULL,
-  };
-  utarray_push_back(cli_ctx.cmd_array, &cmd);
+// mark a resource as done and wake up commands waiting for it, must be called with the lock
+static void startup_done(cli_startup_t *s, uint32_t need, bool failed) {
+  s->failed |= failed ? need : 0;
+  s->ready |= need;
+  pthread_cond_broadcast(&s->cond);
 }
 
-/* 'seed' command */
-static cli_err_t fn_seed(int argc, char **argv) {
-  dump_hex_str(cli_ctx.wallet->seed, IOTA_SEED_BYTES);
-  return CLI_OK;
+// derive the seed from the mnemonic, PBKDF2 takes a while on embedded devices
+static void *startup_wallet(void *arg) {
+  cli_startup_t *s = &cli_ctx.startup;
+  uint64_t start = cli_stats_now_ns();
+  iota_wallet_t *w = wallet_create(s->mnemonic, "", 0);
+  memset(s->mnemonic, 0, sizeof(s->mnemonic));
+  if (w && wallet_set_endpoint(w, s->endpoint.host, s->endpoint.port, s->endpoint.use_tls) != 0) {
+    wallet_destroy(w);
+    w = NULL;
+  }
+  if (w) {
+    // replaced by the HRP of the node once the handshake is done
+    strncpy(w->bech32HRP, CLIENT_CONFIG_HRP, sizeof(w->bech32HRP) - 1);
+  }
+
+  pthread_mutex_lock(&s->lock);
+  s->wallet = w;
+  s->wallet_ns = cli_stats_now_ns() - start;
+  startup_done(s, CLI_NEED_WALLET, w == NULL);
+  pthread_mutex_unlock(&s->lock);
+  return NULL;
 }
 
-static void register_seed() {
-  cli_cmd_t cmd = {
-      .command = "seed",
-      .help = "Show SEED",
-      .hint = NULL,
-      .func = &fn_seed,
-      .argtable = NULL,
-  };
-  utarray_push_back(cli_ctx.cmd_array, &cmd);
+// the node handshake, commands which don't need the node are served meanwhile
+static void *startup_node(void *arg) {
+  cli_startup_t *s = &cli_ctx.startup;
+  node_params_t params;
+  api_in_background = true;
+  pthread_mutex_lock(&s->lock);
+  uint32_t gen = s->node_gen;
+  pthread_mutex_unlock(&s->lock);
+  uint64_t start = cli_stats_now_ns();
+  int err = node_probe(&s->endpoint, &params);
+
+  pthread_mutex_lock(&s->lock);
+  if (gen != s->node_gen) {
+    // node_set connected another node meanwhile
+    pthread_mutex_unlock(&s->lock);
+    return NULL;
+  }
+  if (err == 0) {
+    // commands using the tip pool wait for the node
+    tip_pool_start();
+  }
+  s->node = params;
+  s->node_err = err;
+  s->node_ns = cli_stats_now_ns() - start;
+  startup_done(s, CLI_NEED_NODE, err != 0);
+  pthread_mutex_unlock(&s->lock);
+  return NULL;
 }
 
-/* 'seed_set' command */
-static struct {
-  struct arg_str *seed;
-  struct arg_end *end;
-} seed_set_args;
-
-static cli_err_t fn_seed_set(int argc, char **argv) {
-  byte_t new_seed[IOTA_SEED_BYTES] = {};
-
-  int nerrors = arg_parse(argc, argv, (void **)&seed_set_args);
-  if (nerrors != 0) {
-    arg_print_errors(stderr, seed_set_args.end, argv[0]);
-    return CLI_ERR_INVALID_ARG;
+static void startup_spawn(cli_startup_t *s, void *(*fn)(void *)) {
+  if (pthread_create(&s->threads[s->threads_len], NULL, fn, NULL) == 0) {
+    s->threads_len++;
+  } else {
+    // done before the prompt
+    fn(NULL);
+    api_in_background = false;
   }
+}
 
-  char const *const seed_in = seed_set_args.seed->sval[0];
-  size_t len = strlen(seed_in);
-  if (len != IOTA_SEED_HEX_BYTES) {
-    printf("SEED is a %d-character string, the input length is %zu\n", IOTA_SEED_HEX_BYTES, len);
+// apply resources which are done to the context, it's called by the command thread with the lock
+static void startup_sync(cli_startup_t *s) {
+  uint32_t fresh = s->ready & ~s->synced;
+  if (fresh == 0) {
+    return;
+  }
+  s->synced |= fresh;
+  bool text = !cli_out_structured();
+
+  if (fresh & CLI_NEED_WALLET) {
+    cli_ctx.wallet = s->wallet;
+    if (s->wallet == NULL) {
+      printf("create wallet instance failed\n");
+    } else if (text) {
+      printf("Wallet is ready in %0.1f ms\n", s->wallet_ns / 1e6);
+    }
+  }
+  if (fresh & CLI_NEED_NODE) {
+    if (text || s->node_err != 0) {
+      node_params_print(&s->endpoint, &s->node, s->node_err);
+    }
+    if (s->node_err != 0) {
+      printf("connect to node failed, node commands are not available until node_set\n");
+    } else if (text) {
+      printf("Node handshake is done in %0.1f ms\n", s->node_ns / 1e6);
+    }
+  }
+  // the HRP of the node is applied once both are done
+  if ((s->synced & CLI_NEED_NODE) && !(s->failed & CLI_NEED_NODE)) {
+    node_params_apply(cli_ctx.wallet, &s->node);
+  }
+}
+
+// wait for resources, returns the failed ones
+static uint32_t startup_wait_ready(uint32_t needs) {
+  cli_startup_t *s = &cli_ctx.startup;
+  pthread_mutex_lock(&s->lock);
+  while ((s->ready & needs) != needs) {
+    pthread_cond_wait(&s->cond, &s->lock);
+  }
+  startup_sync(s);
+  uint32_t failed = s->failed & needs;
+  pthread_mutex_unlock(&s->lock);
+  return failed;
+}
+
+// wait for resources of a command
+static cli_err_t startup_wait(uint32_t needs) {
+  uint32_t failed = startup_wait_ready(needs);
+  if (failed & CLI_NEED_WALLET) {
+    printf("wallet is not available\n");
+    return CLI_WALLET_FAILED;
+  }
+  if (failed & CLI_NEED_NODE) {
+    printf("node is not available, use node_set to connect a node\n");
+    return CLI_NODE_INFO_FAILED;
+  }
+  return CLI_OK;
+}
+
+static cli_err_t cli_wallet_init() {
+  cli_startup_t *s = &cli_ctx.startup;
+  printf("Init client application...\n");
+
+  if (strncmp(WALLET_CONFIG_MNEMONIC, "RANDOM", strlen("RANDOM")) == 0) {
+    printf("generating new mnemonic sentence\n");
+    mnemonic_generator(MS_ENTROPY_256, MS_LAN_EN, s->mnemonic, sizeof(s->mnemonic));
+    printf("###\n%s\n###\n", s->mnemonic);
+  } else {
+    strncpy(s->mnemonic, WALLET_CONFIG_MNEMONIC, sizeof(s->mnemonic) - 1);
+  }
+
+  // the node of the configuration unless it's set by cli_command_set_node
+  if (s->endpoint.host[0] == '\0') {
+    strncpy(s->endpoint.host, CLIENT_CONFIG_NODE, sizeof(s->endpoint.host) - 1);
+    s->endpoint.port = CLIENT_CONFIG_PORT;
+    s->endpoint.use_tls = NODE_USE_TLS;
+  }
+  if (cli_http_pool_set_endpoint(&cli_ctx.http, s->endpoint.host, s->endpoint.port, s->endpoint.use_tls) != 0) {
+    printf("connect to node failed\n");
+    return CLI_ERR_FAILED;
+  }
+
+  // the prompt doesn't wait for the seed and the node, commands wait for the ones they need
+  startup_spawn(s, startup_wallet);
+  startup_spawn(s, startup_node);
+  s->prompt_ns = cli_stats_now_ns() - s->start_ns;
+  printf("Init client application...done in %0.1f ms\n", s->prompt_ns / 1e6);
+  return CLI_OK;
+}
+
+static void cmd_icd_copy(void *_dst, const void *_src) {
+  cli_cmd_t *dst = (cli_cmd_t *)_dst, *src = (cli_cmd_t *)_src;
+  dst->command = src->command ? strdup(src->command) : NULL;
+  dst->help = src->help ? strdup(src->help) : NULL;
+  dst->hint = src->hint ? strdup(src->hint) : NULL;
+  dst->func = src->func;
+  dst->args = src->args;
+  dst->needs = src->needs;
+}
+
+static void cmd_icd_dtor(void *_elt) {
+  cli_cmd_t *elt = (cli_cmd_t *)_elt;
+  if (elt->command) {
+    free(elt->command);
+  }
+  if (elt->help) {
+    free(elt->help);
+  }
+  if (elt->hint) {
+    free(elt->hint);
+  }
+}
+
+UT_icd cli_cmd_icd = {sizeof(cli_cmd_t), NULL, cmd_icd_copy, cmd_icd_dtor};
+
+static void cmd_index_free() {
+  cli_cmd_index_t *elm, *tmp;
+  HASH_ITER(hh, cli_ctx.cmd_index, elm, tmp) {
+    HASH_DEL(cli_ctx.cmd_index, elm);
+    free(elm);
+  }
+}
+
+// add a command of the command array to the index
+static cli_err_t cmd_index_add(cli_cmd_t const *cmd_p) {
+  cli_cmd_index_t *elm = NULL;
+  HASH_FIND_STR(cli_ctx.cmd_index, cmd_p->command, elm);
+  if (elm) {
+    printf("duplicated command: %s\n", cmd_p->command);
+    return CLI_ERR_INVALID_CMD;
+  }
+  elm = malloc(sizeof(cli_cmd_index_t));
+  if (elm == NULL) {
+    return CLI_ERR_OOM;
+  }
+  elm->name = cmd_p->command;
+  elm->idx = utarray_eltidx(cli_ctx.cmd_array, cmd_p);
+  HASH_ADD_KEYPTR(hh, cli_ctx.cmd_index, elm->name, strlen(elm->name), elm);
+  return CLI_OK;
+}
+
+static cli_err_t cmd_index_build() {
+  cli_cmd_t *cmd_p = NULL;
+
+  cmd_index_free();
+  while ((cmd_p = (cli_cmd_t *)utarray_next(cli_ctx.cmd_array, cmd_p))) {
+    if (cmd_index_add(cmd_p) == CLI_ERR_OOM) {
+      cmd_index_free();
+      return CLI_ERR_OOM;
+    }
+  }
+  return CLI_OK;
+}
+
+cli_cmd_t const *cli_command_find(char const *const name, size_t len) {
+  cli_cmd_index_t *elm = NULL;
+  if (name == NULL || len == 0) {
+    return NULL;
+  }
+  HASH_FIND(hh, cli_ctx.cmd_index, name, len, elm);
+  return elm ? (cli_cmd_t const *)utarray_eltptr(cli_ctx.cmd_array, elm->idx) : NULL;
+}
+
+static cli_err_t cmd_trie_build() {
+  cli_cmd_t *cmd_p = NULL;
+
+  cli_trie_free(cli_ctx.cmd_trie);
+  if ((cli_ctx.cmd_trie = cli_trie_new(0)) == NULL) {
+    return CLI_ERR_OOM;
+  }
+
+  while ((cmd_p = (cli_cmd_t *)utarray_next(cli_ctx.cmd_array, cmd_p))) {
+    if (cli_trie_insert(cli_ctx.cmd_trie, cmd_p->command) != 0) {
+      return CLI_ERR_OOM;
+    }
+  }
+  return CLI_OK;
+}
+
+// record an argument value for completions and hints, e.g. message IDs, output IDs, and addresses.
+static void hint_value_add(char const *value) {
+  if (value) {
+    // it's fine to fail on the node limit, the value is not hinted.
+    cli_trie_insert(cli_ctx.value_trie, value);
+  }
+}
+
+typedef struct {
+  linenoiseCompletions *lc;
+  char const *line; /*!< the line before the completing argument */
+  size_t line_len;
+} completion_ctx_t;
+
+static void add_completion(char const *key, void *ctx) {
+  completion_ctx_t *c = (completion_ctx_t *)ctx;
+  size_t key_len = strlen(key);
+  char *buf = malloc(c->line_len + key_len + 1);
+  if (buf == NULL) {
+    return;
+  }
+  memcpy(buf, c->line, c->line_len);
+  memcpy(buf + c->line_len, key, key_len + 1);
+  linenoiseAddCompletion(c->lc, buf);
+  free(buf);
+}
+
+void completion_callback(char const *buf, linenoiseCompletions *lc) {
+  size_t len = strlen(buf);
+  if (len == 0) {
+    return;
+  }
+
+  completion_ctx_t ctx = {.lc = lc, .line = buf, .line_len = 0};
+  char const *arg = strrchr(buf, ' ');
+  if (arg == NULL) {
+    // completing the command name
+    cli_trie_find(cli_ctx.cmd_trie, buf, len, CLI_COMPLETION_MAX, add_completion, &ctx);
+  } else {
+    // completing an argument from values seen in this session
+    ctx.line_len = arg + 1 - buf;
+    cli_trie_find(cli_ctx.value_trie, arg + 1, len - ctx.line_len, CLI_COMPLETION_MAX, add_completion, &ctx);
+  }
+}
+
+static void copy_hint(char const *key, void *ctx) { strncpy((char *)ctx, key, CLI_TRIE_KEY_MAX - 1); }
+
+char *hints_callback(char const *buf, int *color, int *bold) {
+  size_t len = strlen(buf);
+  cli_cmd_t const *cmd_p = cli_command_find(buf, len);
+  if (cmd_p != NULL) {
+    *color = HINT_COLOR_GREEN;
+    *bold = 0;
+    return cmd_p->hint;
+  }
+
+  // hint the rest of a known value if the argument matches only one.
+  char const *arg = strrchr(buf, ' ');
+  if (arg == NULL) {
+    return NULL;
+  }
+  arg++;
+  size_t arg_len = len - (arg - buf);
+  if (arg_len < CLI_HINT_VALUE_MIN_PREFIX) {
+    return NULL;
+  }
+  if (cli_trie_find(cli_ctx.value_trie, arg, arg_len, 2, NULL, NULL) != 1) {
+    return NULL;
+  }
+  cli_trie_find(cli_ctx.value_trie, arg, arg_len, 1, copy_hint, cli_ctx.hint_buf);
+  *color = HINT_COLOR_CYAN;
+  *bold = 0;
+  return cli_ctx.hint_buf + arg_len;
+}
+
+void to_uppercase(char *sPtr, int nchar) {
+  for (int i = 0; i < nchar; i++) {
+    char *element = sPtr + i;
+    *element = toupper((unsigned char)*element);
+  }
+}
+
+//==========COMMANDS==========
+
+/* 'help' command */
+typedef struct {
+  char const *cmd;
+} help_args_t;
+
+static cli_arg_t const help_schema[] = {
+    CLI_ARG_STR_OPT(help_args_t, cmd, "<command>", "Command name"),
+    CLI_ARGS_END,
+};
+
+static void dump_cmd_help(cli_cmd_t const *cmd_p) {
+  char const *help = (cmd_p->help) ? cmd_p->help : "";
+  if (cmd_p->hint != NULL) {
+    printf("- %s %s\n", cmd_p->command, cmd_p->hint);
+    printf("    %s\n", help);
+  } else {
+    printf("- %s %s\n", cmd_p->command, help);
+  }
+  if (cmd_p->args) {
+    cli_args_print_glossary(cmd_p->args);
+  }
+  printf("\n");
+}
+
+static cli_err_t fn_help(int argc, char **argv) {
+  cli_cmd_t *cmd_p = NULL;
+  help_args_t args = {};
+
+  if (cli_args_parse(help_schema, argc, argv, &args) != 0) {
+    return CLI_ERR_INVALID_ARG;
+  }
+
+  // help of the given command
+  if (args.cmd != NULL) {
+    char const *const name = args.cmd;
+    cli_cmd_t const *found = cli_command_find(name, strlen(name));
+    if (found == NULL) {
+      printf("command not found: %s\n", name);
+      return CLI_ERR_CMD_NOT_FOUND;
+    }
+    dump_cmd_help(found);
+    return CLI_OK;
+  }
+
+  while ((cmd_p = (cli_cmd_t *)utarray_next(cli_ctx.cmd_array, cmd_p))) {
+    dump_cmd_help(cmd_p);
+  }
+  return CLI_OK;
+}
+
+static void register_help() {
+  cli_cmd_t cmd = {
+      .command = "help",
+      .help = "Show this help",
+      .hint = " [command]",
+      .func = &fn_help,
+      .args = help_schema,
+  };
+
+  utarray_push_back(cli_ctx.cmd_array, &cmd);
+}
+
+/* 'version' command */
+static cli_err_t fn_version(int argc, char **argv) {
+  if (cli_out_structured()) {
+    cli_out_record_begin("version");
+    cli_out_u64("major", CMDER_VERSION_MAJOR);
+    cli_out_u64("minor", CMDER_VERSION_MINOR);
+    cli_out_u64("micro", CMDER_VERSION_MICRO);
+    cli_out_record_end();
+  } else {
+    printf("TODO\n");
+  }
+  return CLI_OK;
+}
+
+static void register_version() {
+  cli_cmd_t cmd = {
+      .command = "version",
+      .help = "Show version info",
+      .hint = NULL,
+      .func = &fn_version,
+      .args = NULL,
+  };
+
+  utarray_push_back(cli_ctx.cmd_array, &cmd);
+}
+
+/* 'node_info' command */
+static cli_err_t fn_node_info(int argc, char **argv) {
+  res_node_info_t *info = res_node_info_new();
+  if (!info) {
+    return CLI_ERR_OOM;
+  }
+  cli_err_t ret = api_node_info(info);
+  if (ret != 0) {
+    printf("get_node_info failed\n");
+  } else {
+    if (info->is_error) {
+      printf("Node response: \n%s\n", info->u.error->msg);
+      ret = CLI_NODE_ERROR_RESPONSE;
+    } else if (cli_out_structured()) {
+      get_node_info_t const *node = info->u.output_node_info;
+      cli_out_record_begin("node_info");
+      cli_out_str("name", node->name);
+      cli_out_str("version", node->version);
+      cli_out_bool("is_healthy", node->is_healthy);
+      cli_out_str("network_id", node->network_id);
+      cli_out_str("bech32_hrp", node->bech32hrp);
+      cli_out_u64("min_pow_score", node->min_pow_score);
+      cli_out_u64("latest_milestone_index", node->latest_milestone_index);
+      cli_out_u64("latest_milestone_timestamp", node->latest_milestone_timestamp);
+      cli_out_u64("confirmed_milestone_index", node->confirmed_milestone_index);
+      cli_out_u64("pruning_milestone_index", node->pruning_milestone_index);
+      cli_out_double("mps", node->msg_pre_sec);
+      cli_out_double("referenced_mps", node->referenced_msg_pre_sec);
+      cli_out_double("referenced_rate", node->referenced_rate);
+      cli_out_record_end();
+    } else {
+      cli_out_printf("Name: %s\n", info->u.output_node_info->name);
+      cli_out_printf("Version: %s\n", info->u.output_node_info->version);
+      cli_out_printf("isHealthy: %s\n", info->u.output_node_info->is_healthy ? "true" : "false");
+      cli_out_printf("Network ID: %s\n", info->u.output_node_info->network_id);
+      cli_out_printf("bech32HRP: %s\n", info->u.output_node_info->bech32hrp);
+      cli_out_printf("minPoWScore: %" PRIu64 "\n", info->u.output_node_info->min_pow_score);
+      cli_out_printf("Latest Milestone Index: %" PRIu64 "\n", info->u.output_node_info->latest_milestone_index);
+      cli_out_printf("Latest Milestone Timestamp: %" PRIu64 "\n", info->u.output_node_info->latest_milestone_timestamp);
+      cli_out_printf("Confirmed Milestone Index: %" PRIu64 "\n", info->u.output_node_info->confirmed_milestone_index);
+      cli_out_printf("Pruning Index: %" PRIu64 "\n", info->u.output_node_info->pruning_milestone_index);
+      cli_out_printf("MSP: %0.2f\n", info->u.output_node_info->msg_pre_sec);
+      cli_out_printf("Referenced MPS: %0.2f\n", info->u.output_node_info->referenced_msg_pre_sec);
+      cli_out_printf("Reference Rate: %0.2f%%\n", info->u.output_node_info->referenced_rate);
+    }
+  }
+
+  res_node_info_free(info);
+  return ret;
+}
+
+static void register_node_info() {
+  cli_cmd_t cmd = {
+      .command = "node_info",
+      .help = "Shows node info",
+      .hint = NULL,
+      .func = &fn_node_info,
+      .args = NULL,
+  };
+  utarray_push_back(cli_ctx.cmd_array, &cmd);
+}
+
+/* 'info_set' command */
+typedef struct {
+  char const *host;
+  uint32_t port;
+  bool is_https;
+} node_set_args_t;
+
+static cli_arg_t const node_set_schema[] = {
+    CLI_ARG_STR(node_set_args_t, host, "<host>", "hostname"),
+    CLI_ARG_U32(node_set_args_t, port, "<port>", "port number", 1, UINT16_MAX),
+    CLI_ARG_BOOL(node_set_args_t, is_https, "<is_https>", "0 or 1"),
+    CLI_ARGS_END,
+};
+
+static cli_err_t fn_node_set(int argc, char **argv) {
+  node_set_args_t args = {};
+  if (cli_args_parse(node_set_schema, argc, argv, &args) != 0) {
+    return CLI_ERR_INVALID_ARG;
+  }
+
+  // create a new wallet config
+  iota_wallet_t w = {};
+  memcpy(&w, cli_ctx.wallet, sizeof(iota_wallet_t));
+
+  if (update_node_config(&w, args.host, args.port, args.is_https) == 0) {
+    // update wallet config and drop connections to the previous node
+    memcpy(cli_ctx.wallet, &w, sizeof(iota_wallet_t));
+    if (cli_http_pool_set_endpoint(&cli_ctx.http, w.endpoint.host, w.endpoint.port, w.endpoint.use_tls) != 0) {
+      printf("Update connection pool failed\n");
+      return CLI_ERR_FAILED;
+    }
+    // objects are immutable per network, the new node could be on another one
+    cli_resp_cache_clear(&cli_ctx.resp_cache);
+    // the new node replaces a pending startup handshake, and node commands are available if it failed
+    cli_startup_t *s = &cli_ctx.startup;
+    pthread_mutex_lock(&s->lock);
+    s->node_gen++;
+    s->node_err = 0;
+    s->synced |= CLI_NEED_NODE;
+    s->failed &= ~CLI_NEED_NODE;
+    startup_done(s, CLI_NEED_NODE, false);
+    if (cli_ctx.tip_pool.running) {
+      // tips of the previous node
+      cli_tip_pool_clear(&cli_ctx.tip_pool);
+    } else {
+      tip_pool_start();
+    }
+    pthread_mutex_unlock(&s->lock);
+  } else {
+    printf("Node config is not updated.\n");
+  }
+  return CLI_OK;
+}
+
+static void register_node_set() {
+  cli_cmd_t cmd = {
+      .command = "node_set",
+      .help = "Set connected node",
+      .hint = " <host> <port> <is_https (0|1)> ",
+      .func = &fn_node_set,
+      .args = node_set_schema,
+      .needs = CLI_NEED_WALLET,
+  };
+
+  utarray_push_back(cli_ctx.cmd_array, &cmd);
+}
+
+/* 'node_conf' command */
+static cli_err_t fn_node_conf(int argc, char **argv) {
+  cli_http_stats_t stats = {};
+  cli_http_pool_stats(&cli_ctx.http, &stats);
+
+  cli_startup_t *s = &cli_ctx.startup;
+  pthread_mutex_lock(&s->lock);
+  char const *node_state = !(s->ready & CLI_NEED_NODE) ? "pending" : s->failed & CLI_NEED_NODE ? "failed" : "ready";
+  double node_ms = s->node_ns / 1e6;
+  pthread_mutex_unlock(&s->lock);
+
+  if (cli_out_structured()) {
+    cli_out_record_begin("node_conf");
+    cli_out_str("host", cli_ctx.wallet->endpoint.host);
+    cli_out_u64("port", cli_ctx.wallet->endpoint.port);
+    cli_out_bool("tls", cli_ctx.wallet->endpoint.use_tls);
+    cli_out_str("bech32_hrp", cli_ctx.wallet->bech32HRP);
+    cli_out_str("network_id", cli_ctx.network_id);
+    cli_out_u64("min_pow_score", cli_ctx.min_pow_score);
+    cli_out_u64("requests", stats.requests);
+    cli_out_u64("failed", stats.failed);
+    cli_out_u64("handshakes", stats.connects);
+    cli_out_u64("reused", stats.reused);
+    cli_out_u64("pool_flushed", stats.invalidations);
+    cli_out_str("node_state", node_state);
+    cli_out_double("prompt_ms", s->prompt_ns / 1e6);
+    cli_out_double("wallet_ms", s->wallet_ns / 1e6);
+    cli_out_double("node_ms", node_ms);
+    cli_out_record_end();
+    return CLI_OK;
+  }
+
+  printf("Host: %s:%d, TLS: %s\n", cli_ctx.wallet->endpoint.host, cli_ctx.wallet->endpoint.port,
+         cli_ctx.wallet->endpoint.use_tls ? "true" : "false");
+  printf("HRP: %s\n", cli_ctx.wallet->bech32HRP);
+  printf("Network: %s, min PoW score: %" PRIu64 "\n", cli_ctx.network_id, cli_ctx.min_pow_score);
+  printf("Requests: %" PRIu64 ", failed: %" PRIu64 "\n", stats.requests, stats.failed);
+  printf("Handshakes: %" PRIu64 ", avoided: %" PRIu64 ", pool flushed: %" PRIu64 "\n", stats.connects, stats.reused,
+         stats.invalidations);
+  printf("Startup: prompt in %0.1f ms, wallet in %0.1f ms, node %s in %0.1f ms\n", s->prompt_ns / 1e6,
+         s->wallet_ns / 1e6, node_state, node_ms);
+  return CLI_OK;
+}
+
+static void register_node_conf() {
+  cli_cmd_t cmd = {
+      .command = "node_conf",
+      .help = "Show connected node configuration",
+      .hint = NULL,
+      .func = &fn_node_conf,
+      .args = NULL,
+      .needs = CLI_NEED_WALLET,
+  };
+  utarray_push_back(cli_ctx.cmd_array, &cmd);
+}
+
+/* 'seed' command */
+static cli_err_t fn_seed(int argc, char **argv) {
+  if (cli_out_structured()) {
+    char seed[IOTA_SEED_HEX_BYTES + 1] = {};
+    if (bin_2_hex(cli_ctx.wallet->seed, IOTA_SEED_BYTES, seed, sizeof(seed)) != 0) {
+      return CLI_ERR_FAILED;
+    }
+    cli_out_record_begin("seed");
+    cli_out_str("seed", seed);
+    cli_out_record_end();
+    return CLI_OK;
+  }
+  dump_hex_str(cli_ctx.wallet->seed, IOTA_SEED_BYTES);
+  return CLI_OK;
+}
+
+static void register_seed() {
+  cli_cmd_t cmd = {
+      .command = "seed",
+      .help = "Show SEED",
+      .hint = NULL,
+      .func = &fn_seed,
+      .args = NULL,
+      .needs = CLI_NEED_WALLET,
+  };
+  utarray_push_back(cli_ctx.cmd_array, &cmd);
+}
+
+/* 'seed_set' command */
+typedef struct {
+  char const *seed;
+} seed_set_args_t;
+
+static cli_arg_t const seed_set_schema[] = {
+    CLI_ARG_HEX(seed_set_args_t, seed, "<seed>", "A 64-character-string", IOTA_SEED_HEX_BYTES),
+    CLI_ARGS_END,
+};
+
+static cli_err_t fn_seed_set(int argc, char **argv) {
+  byte_t new_seed[IOTA_SEED_BYTES] = {};
+  seed_set_args_t args = {};
+
+  if (cli_args_parse(seed_set_schema, argc, argv, &args) != 0) {
     return CLI_ERR_INVALID_ARG;
   }
 
-  if (hex_2_bin(seed_in, len, new_seed, sizeof(new_seed)) == 0) {
+  if (hex_2_bin(args.seed, IOTA_SEED_HEX_BYTES, new_seed, sizeof(new_seed)) == 0) {
     // update seed
     memcpy(cli_ctx.wallet->seed, new_seed, IOTA_SEED_BYTES);
+    cli_addr_cache_clear(&cli_ctx.addr_cache);
   } else {
     printf("Convert hex string to binary failed\n");
     return -1;
@@ -399,28 +1216,30 @@ static cli_err_t fn_seed_set(int argc, char **argv) {
 }
 
 static void register_seed_set() {
-  seed_set_args.seed = arg_str1(NULL, NULL, "<seed>", "A 64-character-string");
-  seed_set_args.end = arg_end(2);
   cli_cmd_t cmd = {
       .command = "seed_set",
       .help = "Set the SEED of this wallet",
       .hint = " <seed>",
       .func = &fn_seed_set,
-      .argtable = &seed_set_args,
+      .args = seed_set_schema,
+      .needs = CLI_NEED_WALLET,
   };
   utarray_push_back(cli_ctx.cmd_array, &cmd);
 }
 
 /* 'api_msg_index' command */
-static struct {
-  struct arg_str *index;
-  struct arg_end *end;
-} api_find_msg_index_args;
+typedef struct {
+  char const *index;
+} api_find_msg_index_args_t;
+
+static cli_arg_t const api_find_msg_index_schema[] = {
+    CLI_ARG_STR(api_find_msg_index_args_t, index, "<index>", "Index string"),
+    CLI_ARGS_END,
+};
 
 static cli_err_t fn_api_find_msg_index(int argc, char **argv) {
-  int nerrors = arg_parse(argc, argv, (void **)&api_find_msg_index_args);
-  if (nerrors != 0) {
-    arg_print_errors(stderr, api_find_msg_index_args.end, argv[0]);
+  api_find_msg_index_args_t args = {};
+  if (cli_args_parse(api_find_msg_index_schema, argc, argv, &args) != 0) {
     return -1;
   }
 
@@ -430,18 +1249,30 @@ static cli_err_t fn_api_find_msg_index(int argc, char **argv) {
     return -2;
   }
 
-  int err = find_message_by_index(&cli_ctx.wallet->endpoint, api_find_msg_index_args.index->sval[0], res);
+  int err = api_find_msg_index(args.index, res);
   if (err) {
     printf("find message API failed\n");
   } else {
     if (res->is_error) {
       printf("%s\n", res->u.error->msg);
+      err = CLI_NODE_ERROR_RESPONSE;
     } else {
       size_t count = res_find_msg_get_id_len(res);
+      // a record per message ID
       for (size_t i = 0; i < count; i++) {
-        printf("%s\n", res_find_msg_get_id(res, i));
+        if (cli_out_structured()) {
+          cli_out_record_begin("msg_index");
+          cli_out_str("index", args.index);
+          cli_out_str("msg_id", res_find_msg_get_id(res, i));
+          cli_out_record_end();
+        } else {
+          printf("%s\n", res_find_msg_get_id(res, i));
+        }
+        hint_value_add(res_find_msg_get_id(res, i));
+      }
+      if (!cli_out_structured()) {
+        printf("message ID count %zu\n", count);
       }
-      printf("message ID count %zu\n", count);
     }
   }
 
@@ -450,32 +1281,35 @@ static cli_err_t fn_api_find_msg_index(int argc, char **argv) {
 }
 
 static void register_api_find_msg_index() {
-  api_find_msg_index_args.index = arg_str1(NULL, NULL, "<index>", "Index string");
-  api_find_msg_index_args.end = arg_end(2);
   cli_cmd_t cmd = {
       .command = "api_msg_index",
       .help = "Find messages from a given index",
       .hint = " <index>",
       .func = &fn_api_find_msg_index,
-      .argtable = &api_find_msg_index_args,
+      .args = api_find_msg_index_schema,
+      .needs = CLI_NEED_WALLET,
   };
   utarray_push_back(cli_ctx.cmd_array, &cmd);
 }
 
 /* 'api_get_balance' command */
-static struct {
-  struct arg_str *addr;
-  struct arg_end *end;
-} api_get_balance_args;
+typedef struct {
+  char const *addr;
+} api_get_balance_args_t;
+
+static cli_arg_t const api_get_balance_schema[] = {
+    CLI_ARG_BECH32(api_get_balance_args_t, addr, "<address>", "Address HASH"),
+    CLI_ARGS_END,
+};
 
 static int fn_api_get_balance(int argc, char **argv) {
-  int nerrors = arg_parse(argc, argv, (void **)&api_get_balance_args);
+  api_get_balance_args_t args = {};
+  int nerrors = cli_args_parse(api_get_balance_schema, argc, argv, &args);
   if (nerrors != 0) {
-    arg_print_errors(stderr, api_get_balance_args.end, argv[0]);
     return -1;
   }
 
-  char const *const bech32_add_str = api_get_balance_args.addr->sval[0];
+  char const *const bech32_add_str = args.addr;
   if (strncmp(bech32_add_str, cli_ctx.wallet->bech32HRP, strlen(cli_ctx.wallet->bech32HRP)) != 0) {
     printf("Invalid address hash\n");
     return -2;
@@ -486,14 +1320,22 @@ static int fn_api_get_balance(int argc, char **argv) {
       printf("Create res_balance_t object failed\n");
       return -3;
     } else {
-      nerrors = get_balance(&cli_ctx.wallet->endpoint, true, bech32_add_str, res);
+      nerrors = api_balance(bech32_add_str, res);
       if (nerrors != 0) {
         printf("get_balance API failed\n");
       } else {
         if (res->is_error) {
           printf("Err: %s\n", res->u.error->msg);
+          nerrors = CLI_NODE_ERROR_RESPONSE;
         } else {
-          printf("balance: %" PRIu64 "\n", res->u.output_balance->balance);
+          if (cli_out_structured()) {
+            cli_out_record_begin("balance");
+            cli_out_str("address", bech32_add_str);
+            cli_out_u64("balance", res->u.output_balance->balance);
+            cli_out_record_end();
+          } else {
+            printf("balance: %" PRIu64 "\n", res->u.output_balance->balance);
+          }
         }
       }
       res_balance_free(res);
@@ -503,56 +1345,62 @@ static int fn_api_get_balance(int argc, char **argv) {
 }
 
 static void register_api_get_balance() {
-  api_get_balance_args.addr = arg_str1(NULL, NULL, "<address>", "Address HASH");
-  api_get_balance_args.end = arg_end(2);
   cli_cmd_t cmd = {
       .command = "api_get_balance",
       .help = "Get balance from a given address",
       .hint = " <address>",
       .func = &fn_api_get_balance,
-      .argtable = &api_get_balance_args,
+      .args = api_get_balance_schema,
+      .needs = CLI_NEED_WALLET | CLI_NEED_NODE,
   };
   utarray_push_back(cli_ctx.cmd_array, &cmd);
 }
 
 /* 'api_msg_children' command */
-static struct {
-  struct arg_str *msg_id;
-  struct arg_end *end;
-} api_msg_children_args;
+typedef struct {
+  char const *msg_id;
+} api_msg_children_args_t;
+
+static cli_arg_t const api_msg_children_schema[] = {
+    CLI_ARG_HEX(api_msg_children_args_t, msg_id, "<ID>", "Message ID", IOTA_MESSAGE_ID_HEX_BYTES),
+    CLI_ARGS_END,
+};
 
 static int fn_api_msg_children(int argc, char **argv) {
-  int nerrors = arg_parse(argc, argv, (void **)&api_msg_children_args);
+  api_msg_children_args_t args = {};
+  int nerrors = cli_args_parse(api_msg_children_schema, argc, argv, &args);
   if (nerrors != 0) {
-    arg_print_errors(stderr, api_msg_children_args.end, argv[0]);
     return -1;
   }
-
-  // check message id length
-  char const *const msg_id_str = api_msg_children_args.msg_id->sval[0];
-  if (strlen(msg_id_str) != IOTA_MESSAGE_ID_HEX_BYTES) {
-    printf("Invalid message ID length\n");
-    return -2;
-  }
+  char const *const msg_id_str = args.msg_id;
 
   res_msg_children_t *res = res_msg_children_new();
   if (!res) {
     printf("Allocate response failed\n");
     return -3;
   } else {
-    nerrors = get_message_children(&cli_ctx.wallet->endpoint, msg_id_str, res);
+    nerrors = api_msg_children(msg_id_str, res);
     if (nerrors) {
       printf("get_message_children error %d\n", nerrors);
     } else {
       if (res->is_error) {
         printf("Err: %s\n", res->u.error->msg);
+        nerrors = CLI_NODE_ERROR_RESPONSE;
       } else {
         size_t count = res_msg_children_len(res);
         if (count == 0) {
           printf("Message not found\n");
         } else {
           for (size_t i = 0; i < count; i++) {
-            printf("%s\n", res_msg_children_get(res, i));
+            if (cli_out_structured()) {
+              cli_out_record_begin("msg_child");
+              cli_out_str("msg_id", msg_id_str);
+              cli_out_str("child", res_msg_children_get(res, i));
+              cli_out_record_end();
+            } else {
+              printf("%s\n", res_msg_children_get(res, i));
+            }
+            hint_value_add(res_msg_children_get(res, i));
           }
         }
       }
@@ -564,176 +1412,744 @@ static int fn_api_msg_children(int argc, char **argv) {
 }
 
 static void register_api_msg_children() {
-  api_msg_children_args.msg_id = arg_str1(NULL, NULL, "<ID>", "Message ID");
-  api_msg_children_args.end = arg_end(2);
   cli_cmd_t cmd = {
       .command = "api_msg_children",
       .help = "Get children from a given message ID",
       .hint = " <ID>",
       .func = &fn_api_msg_children,
-      .argtable = &api_msg_children_args,
+      .args = api_msg_children_schema,
   };
   utarray_push_back(cli_ctx.cmd_array, &cmd);
 }
 
 /* 'api_msg_meta' command */
-static struct {
-  struct arg_str *msg_id;
-  struct arg_end *end;
-} api_msg_meta_args;
+typedef struct {
+  char const *msg_id;
+} api_msg_meta_args_t;
+
+static cli_arg_t const api_msg_meta_schema[] = {
+    CLI_ARG_HEX(api_msg_meta_args_t, msg_id, "<Message ID>", "Message ID", IOTA_MESSAGE_ID_HEX_BYTES),
+    CLI_ARGS_END,
+};
 
 static int fn_api_msg_meta(int argc, char **argv) {
-  int nerrors = arg_parse(argc, argv, (void **)&api_msg_meta_args);
+  api_msg_meta_args_t args = {};
+  int nerrors = cli_args_parse(api_msg_meta_schema, argc, argv, &args);
   if (nerrors != 0) {
-    arg_print_errors(stderr, api_msg_meta_args.end, argv[0]);
     return -1;
   }
-
-  // check message id length
-  char const *const msg_id_str = api_msg_meta_args.msg_id->sval[0];
-  if (strlen(msg_id_str) != IOTA_MESSAGE_ID_HEX_BYTES) {
-    printf("Invalid message ID length\n");
-    return -2;
-  }
+  char const *const msg_id_str = args.msg_id;
 
   res_msg_meta_t *res = res_msg_meta_new();
   if (!res) {
     printf("Allocate response failed\n");
     return -3;
   } else {
-    nerrors = get_message_metadata(&cli_ctx.wallet->endpoint, msg_id_str, res);
+    nerrors = api_msg_meta(msg_id_str, res);
     if (nerrors) {
       printf("get_message_metadata error %d\n", nerrors);
     } else {
       if (res->is_error) {
         printf("%s\n", res->u.error->msg);
+        nerrors = CLI_NODE_ERROR_RESPONSE;
+      } else if (cli_out_structured()) {
+        msg_meta_t const *meta = res->u.meta;
+        cli_out_record_begin("msg_meta");
+        cli_out_str("msg_id", meta->msg_id);
+        cli_out_bool("is_solid", meta->is_solid);
+        cli_out_array_begin("parents");
+        for (size_t i = 0; i < res_msg_meta_parents_len(res); i++) {
+          cli_out_str(NULL, res_msg_meta_parent_get(res, i));
+          hint_value_add(res_msg_meta_parent_get(res, i));
+        }
+        cli_out_array_end();
+        cli_out_str("ledger_inclusion_state", meta->inclusion_state);
+        if (meta->milestone_idx != 0) {
+          cli_out_u64("milestone_index", meta->milestone_idx);
+        }
+        if (meta->referenced_milestone != 0) {
+          cli_out_u64("referenced_by_milestone_index", meta->referenced_milestone);
+        }
+        if (meta->should_promote >= 0) {
+          cli_out_bool("should_promote", meta->should_promote);
+        }
+        if (meta->should_reattach >= 0) {
+          cli_out_bool("should_reattach", meta->should_reattach);
+        }
+        cli_out_record_end();
       } else {
-        printf("Message ID: %s\nisSolid: %s\n", res->u.meta->msg_id, res->u.meta->is_solid ? "True" : "False");
+        cli_out_printf("Message ID: %s\nisSolid: %s\n", res->u.meta->msg_id, res->u.meta->is_solid ? "True" : "False");
         size_t parents = res_msg_meta_parents_len(res);
-        printf("%zu parents:\n", parents);
+        cli_out_printf("%zu parents:\n", parents);
         for (size_t i = 0; i < parents; i++) {
-          printf("\t%s\n", res_msg_meta_parent_get(res, i));
+          cli_out_printf("\t%s\n", res_msg_meta_parent_get(res, i));
+          hint_value_add(res_msg_meta_parent_get(res, i));
         }
-        printf("ledgerInclusionState: %s\n", res->u.meta->inclusion_state);
+        cli_out_printf("ledgerInclusionState: %s\n", res->u.meta->inclusion_state);
 
         // check milestone index
         if (res->u.meta->milestone_idx != 0) {
-          printf("milestoneIndex: %" PRIu64 "\n", res->u.meta->milestone_idx);
+          cli_out_printf("milestoneIndex: %" PRIu64 "\n", res->u.meta->milestone_idx);
         }
 
         // check referenced milestone index
         if (res->u.meta->referenced_milestone != 0) {
-          printf("referencedByMilestoneIndex: %" PRIu64 "\n", res->u.meta->referenced_milestone);
+          cli_out_printf("referencedByMilestoneIndex: %" PRIu64 "\n", res->u.meta->referenced_milestone);
         }
 
         // check should promote
         if (res->u.meta->should_promote >= 0) {
-          printf("shouldPromote: %s\n", res->u.meta->should_promote ? "True" : "False");
+          cli_out_printf("shouldPromote: %s\n", res->u.meta->should_promote ? "True" : "False");
         }
         // check should reattach
         if (res->u.meta->should_reattach >= 0) {
-          printf("shouldReattach: %s\n", res->u.meta->should_reattach ? "True" : "False");
+          cli_out_printf("shouldReattach: %s\n", res->u.meta->should_reattach ? "True" : "False");
         }
       }
     }
     res_msg_meta_free(res);
   }
-  return nerrors;
+  return nerrors;
+}
+
+static void register_api_msg_meta() {
+  cli_cmd_t cmd = {
+      .command = "api_msg_meta",
+      .help = "Get metadata from a given message ID",
+      .hint = " <Message ID>",
+      .func = &fn_api_msg_meta,
+      .args = api_msg_meta_schema,
+  };
+  utarray_push_back(cli_ctx.cmd_array, &cmd);
+}
+
+/* 'walk' command */
+typedef struct {
+  char id[IOTA_MESSAGE_ID_HEX_BYTES + 1];
+} walk_id_t;
+
+typedef struct {
+  walk_id_t *ids; /*!< children or parents of the message */
+  size_t len;
+  int err;
+} walk_result_t;
+
+typedef struct {
+  FILE *fp;
+  bool parents;           /*!< walk the past cone or the future cone */
+  size_t max;             /*!< limit of visited messages */
+  cli_idset_t visited;    /*!< IDs of visited messages */
+  walk_id_t *frontier;    /*!< messages of the current level */
+  walk_result_t *results; /*!< neighbors of the current level */
+  walk_id_t *next;        /*!< messages of the next level */
+  size_t next_len;
+  size_t next_cap;
+  size_t edges;
+  size_t failed;
+  bool write_failed;
+} walk_t;
+
+static int walk_fetch_children(char const msg_id[], walk_result_t *r) {
+  res_msg_children_t *res = res_msg_children_new();
+  if (res == NULL) {
+    return -1;
+  }
+  int ret = api_msg_children(msg_id, res);
+  if (ret == 0 && !res->is_error) {
+    r->len = res_msg_children_len(res);
+    if (r->len && (r->ids = malloc(r->len * sizeof(walk_id_t))) == NULL) {
+      r->len = 0;
+      ret = -1;
+    }
+    for (size_t i = 0; i < r->len; i++) {
+      strncpy(r->ids[i].id, res_msg_children_get(res, i), IOTA_MESSAGE_ID_HEX_BYTES);
+      r->ids[i].id[IOTA_MESSAGE_ID_HEX_BYTES] = '\0';
+    }
+  } else if (ret == 0) {
+    ret = -1;
+  }
+  res_msg_children_free(res);
+  return ret;
+}
+
+static int walk_fetch_parents(char const msg_id[], walk_result_t *r) {
+  res_msg_meta_t *res = res_msg_meta_new();
+  if (res == NULL) {
+    return -1;
+  }
+  int ret = api_msg_meta(msg_id, res);
+  if (ret == 0 && !res->is_error) {
+    r->len = res_msg_meta_parents_len(res);
+    if (r->len && (r->ids = malloc(r->len * sizeof(walk_id_t))) == NULL) {
+      r->len = 0;
+      ret = -1;
+    }
+    for (size_t i = 0; i < r->len; i++) {
+      strncpy(r->ids[i].id, res_msg_meta_parent_get(res, i), IOTA_MESSAGE_ID_HEX_BYTES);
+      r->ids[i].id[IOTA_MESSAGE_ID_HEX_BYTES] = '\0';
+    }
+  } else if (ret == 0) {
+    ret = -1;
+  }
+  res_msg_meta_free(res);
+  return ret;
+}
+
+static void walk_task(void *ctx, size_t idx) {
+  walk_t *w = (walk_t *)ctx;
+  char const *msg_id = w->frontier[idx].id;
+  w->results[idx].err =
+      w->parents ? walk_fetch_parents(msg_id, &w->results[idx]) : walk_fetch_children(msg_id, &w->results[idx]);
+}
+
+// add a message to the next level if it's not visited
+static int walk_visit(walk_t *w, char const msg_id[]) {
+  byte_t id[CLI_IDSET_ID_BYTES];
+  if (hex_2_bin(msg_id, IOTA_MESSAGE_ID_HEX_BYTES, id, sizeof(id)) != 0) {
+    return -1;
+  }
+  int added = cli_idset_add(&w->visited, id);
+  if (added != 1) {
+    return added;
+  }
+
+  if (w->next_len == w->next_cap) {
+    size_t cap = w->next_cap ? w->next_cap * 2 : 64;
+    walk_id_t *next = realloc(w->next, cap * sizeof(walk_id_t));
+    if (next == NULL) {
+      return -1;
+    }
+    w->next = next;
+    w->next_cap = cap;
+  }
+  memcpy(w->next[w->next_len].id, msg_id, IOTA_MESSAGE_ID_HEX_BYTES);
+  w->next[w->next_len++].id[IOTA_MESSAGE_ID_HEX_BYTES] = '\0';
+  return 1;
+}
+
+static bool walk_emit(void *ctx, size_t idx) {
+  walk_t *w = (walk_t *)ctx;
+  walk_result_t *r = &w->results[idx];
+  char const *msg_id = w->frontier[idx].id;
+  bool cont = true;
+
+  if (r->err) {
+    printf("Err: fetch %s failed\n", msg_id);
+    w->failed++;
+  }
+
+  for (size_t i = 0; i < r->len && cont; i++) {
+    // an edge is always written as "parent child"
+    char const *parent = w->parents ? r->ids[i].id : msg_id;
+    char const *child = w->parents ? msg_id : r->ids[i].id;
+    if (fprintf(w->fp, "%s %s\n", parent, child) < 0) {
+      printf("Err: write file failed\n");
+      w->write_failed = true;
+      cont = false;
+      break;
+    }
+    w->edges++;
+
+    // edges of expanded messages are written even after the count limit is reached
+    if (w->visited.len < w->max && walk_visit(w, r->ids[i].id) < 0) {
+      printf("Err: visit %s failed\n", r->ids[i].id);
+      w->failed++;
+    }
+  }
+
+  free(r->ids);
+  r->ids = NULL;
+  r->len = 0;
+  return cont;
+}
+
+typedef struct {
+  char const *msg_id;
+  char const *direction;
+  char const *file;
+  uint32_t depth;
+  uint64_t max;
+} walk_args_t;
+
+static cli_arg_t const walk_schema[] = {
+    CLI_ARG_HEX(walk_args_t, msg_id, "<Message ID>", "Message ID", IOTA_MESSAGE_ID_HEX_BYTES),
+    CLI_ARG_STR(walk_args_t, direction, "<children|parents>", "walk the future cone or the past cone"),
+    CLI_ARG_STR(walk_args_t, file, "<file>", "output file of edges"),
+    CLI_ARG_U32_OPT(walk_args_t, depth, "<depth>", "depth limit", 1, INT32_MAX, CLI_WALK_DEPTH),
+    CLI_ARG_U64_OPT(walk_args_t, max, "<count>", "limit of visited messages", 1, CLI_WALK_LIMIT_MAX, CLI_WALK_MAX),
+    CLI_ARGS_END,
+};
+
+static cli_err_t fn_walk(int argc, char **argv) {
+  walk_args_t args = {};
+  if (cli_args_parse(walk_schema, argc, argv, &args) != 0) {
+    return CLI_ERR_INVALID_ARG;
+  }
+  char const *const msg_id_str = args.msg_id;
+
+  walk_t w = {.max = (size_t)args.max};
+  if (strcmp(args.direction, "parents") == 0) {
+    w.parents = true;
+  } else if (strcmp(args.direction, "children") != 0) {
+    printf("direction should be children or parents\n");
+    return CLI_ERR_INVALID_ARG;
+  }
+  int depth = (int)args.depth;
+
+  // the set grows with visited messages, a large limit doesn't take memory up front
+  if (cli_idset_init(&w.visited, w.max < CLI_WALK_MAX ? w.max : CLI_WALK_MAX) != 0) {
+    return CLI_ERR_OOM;
+  }
+  if (walk_visit(&w, msg_id_str) != 1) {
+    printf("Invalid message ID\n");
+    cli_idset_free(&w.visited);
+    free(w.next);
+    return CLI_ERR_INVALID_ARG;
+  }
+  if ((w.fp = fopen(args.file, "w")) == NULL) {
+    printf("open %s failed\n", args.file);
+    cli_idset_free(&w.visited);
+    free(w.next);
+    return CLI_ERR_FAILED;
+  }
+
+  struct timespec ts_start, ts_end;
+  clock_gettime(CLOCK_MONOTONIC, &ts_start);
+  int level = 0;
+  size_t fetched = 0;
+  cli_err_t ret = CLI_OK;
+  // level-synchronous BFS, messages of a level are fetched concurrently
+  while (level < depth && w.next_len > 0 && !w.write_failed) {
+    size_t n = w.next_len;
+    free(w.frontier);
+    w.frontier = w.next;
+    w.next = NULL;
+    w.next_len = w.next_cap = 0;
+
+    if ((w.results = calloc(n, sizeof(walk_result_t))) == NULL) {
+      ret = CLI_ERR_OOM;
+      break;
+    }
+    size_t emitted = cli_parallel_for(n, CLI_WALK_INFLIGHT, walk_task, walk_emit, &w);
+    // results are not emitted after a write error
+    for (size_t i = emitted; i < n; i++) {
+      free(w.results[i].ids);
+    }
+    free(w.results);
+    w.results = NULL;
+    fetched += n;
+    level++;
+  }
+  clock_gettime(CLOCK_MONOTONIC, &ts_end);
+
+  if (fclose(w.fp) != 0) {
+    printf("Err: close file failed\n");
+    w.write_failed = true;
+  }
+
+  double elapsed = (ts_end.tv_sec - ts_start.tv_sec) + (ts_end.tv_nsec - ts_start.tv_nsec) / 1e9;
+  printf("walked %s of %s: %zu messages, %zu edges, depth %d in %0.3fs, %0.1f requests/s, %zu failed\n",
+         w.parents ? "parents" : "children", msg_id_str, w.visited.len, w.edges, level, elapsed,
+         elapsed > 0 ? fetched / elapsed : 0.0, w.failed);
+  if (w.visited.len >= w.max) {
+    printf("stopped at the count limit %zu\n", w.max);
+  } else if (w.next_len > 0) {
+    printf("stopped at the depth limit %d, %zu messages are not expanded\n", depth, w.next_len);
+  }
+  if (cli_out_structured()) {
+    cli_out_record_begin("walk");
+    cli_out_str("msg_id", msg_id_str);
+    cli_out_str("direction", w.parents ? "parents" : "children");
+    cli_out_str("file", args.file);
+    cli_out_u64("messages", w.visited.len);
+    cli_out_u64("edges", w.edges);
+    cli_out_i64("depth", level);
+    cli_out_u64("unexpanded", w.next_len);
+    cli_out_u64("failed", w.failed);
+    cli_out_double("elapsed", elapsed);
+    cli_out_record_end();
+  }
+
+  cli_idset_free(&w.visited);
+  free(w.frontier);
+  free(w.next);
+  if (ret == CLI_OK && (w.failed || w.write_failed)) {
+    ret = CLI_ERR_FAILED;
+  }
+  return ret;
+}
+
+static void register_walk() {
+  cli_cmd_t cmd = {
+      .command = "walk",
+      .help = "Walk the Tangle from a message and write edges to a file",
+      .hint = " <Message ID> <children|parents> <file> [depth] [count]",
+      .func = &fn_walk,
+      .args = walk_schema,
+  };
+  utarray_push_back(cli_ctx.cmd_array, &cmd);
+}
+
+/* 'api_address_outputs' command */
+typedef struct {
+  char const *addr;
+} api_address_outputs_args_t;
+
+static cli_arg_t const api_address_outputs_schema[] = {
+    CLI_ARG_BECH32(api_address_outputs_args_t, addr, "<Address>", "Address hash"),
+    CLI_ARGS_END,
+};
+
+static int fn_api_address_outputs(int argc, char **argv) {
+  api_address_outputs_args_t args = {};
+  int nerrors = cli_args_parse(api_address_outputs_schema, argc, argv, &args);
+  if (nerrors != 0) {
+    return -1;
+  }
+
+  // check the network of the address
+  char const *const bech32_add_str = args.addr;
+  if (strncmp(bech32_add_str, cli_ctx.wallet->bech32HRP, strlen(cli_ctx.wallet->bech32HRP)) != 0) {
+    printf("Invalid address hash\n");
+    return -2;
+  }
+
+  res_outputs_address_t *res = res_outputs_address_new();
+  if (!res) {
+    printf("Allocate res_outputs_address_t failed\n");
+    return -3;
+  } else {
+    nerrors = api_address_outputs(bech32_add_str, false, res);
+    if (nerrors != 0) {
+      printf("get_outputs_from_address error\n");
+    } else {
+      if (res->is_error) {
+        printf("%s\n", res->u.error->msg);
+        nerrors = CLI_NODE_ERROR_RESPONSE;
+      } else {
+        if (!cli_out_structured()) {
+          printf("Output IDs:\n");
+        }
+        // a record per output ID
+        for (uint32_t i = 0; i < res_outputs_address_output_id_count(res); i++) {
+          if (cli_out_structured()) {
+            cli_out_record_begin("address_output");
+            cli_out_str("address", bech32_add_str);
+            cli_out_str("output_id", res_outputs_address_output_id(res, i));
+            cli_out_record_end();
+          } else {
+            printf("%s\n", res_outputs_address_output_id(res, i));
+          }
+          hint_value_add(res_outputs_address_output_id(res, i));
+        }
+      }
+    }
+
+    res_outputs_address_free(res);
+  }
+
+  return nerrors;
+}
+
+static void register_api_address_outputs() {
+  cli_cmd_t cmd = {
+      .command = "api_address_outputs",
+      .help = "Get output ID list from a given address",
+      .hint = " <Address>",
+      .func = &fn_api_address_outputs,
+      .args = api_address_outputs_schema,
+      .needs = CLI_NEED_WALLET | CLI_NEED_NODE,
+  };
+  utarray_push_back(cli_ctx.cmd_array, &cmd);
+}
+
+/* 'tip_pool' command */
+static cli_err_t fn_tip_pool(int argc, char **argv) {
+  cli_tip_pool_stats_t stats = {};
+  cli_tip_pool_stats(&cli_ctx.tip_pool, &stats);
+  if (cli_out_structured()) {
+    cli_out_record_begin("tip_pool");
+    cli_out_u64("tips", stats.tips);
+    cli_out_double("age", stats.age);
+    cli_out_u64("refresh_ms", CLI_TIP_REFRESH_MS);
+    cli_out_u64("max_age_ms", CLI_TIP_MAX_AGE_MS);
+    cli_out_u64("served", stats.served);
+    cli_out_u64("missed", stats.missed);
+    cli_out_u64("refreshes", stats.refreshes);
+    cli_out_u64("failed", stats.failed);
+    cli_out_u64("dropped", stats.dropped);
+    cli_out_record_end();
+    return CLI_OK;
+  }
+  printf("Tips: %zu, age: %0.1fs, refresh: %dms, max age: %dms\n", stats.tips, stats.age, CLI_TIP_REFRESH_MS,
+         CLI_TIP_MAX_AGE_MS);
+  printf("Served: %" PRIu64 ", missed: %" PRIu64 "\n", stats.served, stats.missed);
+  printf("Refreshes: %" PRIu64 ", failed: %" PRIu64 ", stale dropped: %" PRIu64 "\n", stats.refreshes, stats.failed,
+         stats.dropped);
+  return CLI_OK;
+}
+
+static void register_tip_pool() {
+  cli_cmd_t cmd = {
+      .command = "tip_pool",
+      .help = "Show the tip pool",
+      .hint = NULL,
+      .func = &fn_tip_pool,
+      .args = NULL,
+      .needs = CLI_NEED_NODE,
+  };
+  utarray_push_back(cli_ctx.cmd_array, &cmd);
+}
+
+/* 'stats' command */
+typedef struct {
+  char const *action;
+} stats_args_t;
+
+static cli_arg_t const stats_schema[] = {
+    CLI_ARG_STR_OPT(stats_args_t, action, "<reset>", "reset the statistics"),
+    CLI_ARGS_END,
+};
+
+static char const *const stats_timer_names[CLI_STATS_TIMERS] = {"wall", "net", "cpu"};
+
+static void stats_print_hist(char const name[], uint64_t calls, uint64_t errors, char const timer[],
+                             cli_hist_t const *h) {
+  cli_out_printf("%-28s %8" PRIu64 " %6" PRIu64 " %-4s %10.3f %10.3f %10.3f %10.3f\n", name, calls, errors, timer,
+                 cli_hist_percentile(h, 50) / 1000.0, cli_hist_percentile(h, 90) / 1000.0,
+                 cli_hist_percentile(h, 99) / 1000.0, h->max / 1000.0);
+}
+
+static void stats_out_hist(char const key[], cli_hist_t const *h) {
+  cli_out_object_begin(key);
+  cli_out_u64("p50_us", cli_hist_percentile(h, 50));
+  cli_out_u64("p90_us", cli_hist_percentile(h, 90));
+  cli_out_u64("p99_us", cli_hist_percentile(h, 99));
+  cli_out_u64("max_us", h->max);
+  cli_out_double("mean_us", h->count ? (double)h->sum / h->count : 0.0);
+  cli_out_object_end();
+}
+
+static void stats_dump(cli_stats_kind_t kind) {
+  cli_stats_entry_t *entries = NULL;
+  size_t n = cli_stats_snapshot(&cli_ctx.stats, kind, &entries);
+  size_t timers = kind == CLI_STATS_CMD ? CLI_STATS_TIMERS : 1;
+
+  if (!cli_out_structured()) {
+    cli_out_printf("%-28s %8s %6s %-4s %10s %10s %10s %10s\n", kind == CLI_STATS_CMD ? "Command" : "Node API", "calls",
+                   "errors", "time", "p50 ms", "p90 ms", "p99 ms", "max ms");
+  }
+  for (size_t i = 0; i < n; i++) {
+    cli_stats_entry_t const *e = &entries[i];
+    uint64_t calls = e->hist[CLI_STATS_WALL].count;
+    if (cli_out_structured()) {
+      cli_out_record_begin(kind == CLI_STATS_CMD ? "command_stats" : "api_stats");
+      cli_out_str("name", e->name);
+      cli_out_u64("calls", calls);
+      cli_out_u64("errors", e->errors);
+      for (size_t t = 0; t < timers; t++) {
+        stats_out_hist(stats_timer_names[t], &e->hist[t]);
+      }
+      cli_out_record_end();
+    } else {
+      for (size_t t = 0; t < timers; t++) {
+        stats_print_hist(t == 0 ? e->name : "", calls, e->errors, stats_timer_names[t], &e->hist[t]);
+      }
+    }
+  }
+  free(entries);
+}
+
+static cli_err_t fn_stats(int argc, char **argv) {
+  stats_args_t args = {};
+  if (cli_args_parse(stats_schema, argc, argv, &args) != 0) {
+    return CLI_ERR_INVALID_ARG;
+  }
+
+  if (args.action != NULL) {
+    if (strcmp(args.action, "reset") != 0) {
+      printf("unknown action: %s\n", args.action);
+      return CLI_ERR_INVALID_ARG;
+    }
+    cli_stats_reset(&cli_ctx.stats);
+    return CLI_OK;
+  }
+
+  // the wall time of commands is split into the time waiting for the node and the CPU time of local work
+  stats_dump(CLI_STATS_CMD);
+  stats_dump(CLI_STATS_API);
+
+  // memory of the largest command line so far
+  if (cli_out_structured()) {
+    cli_out_record_begin("arena_stats");
+    cli_out_u64("block_bytes", cli_ctx.arena.cap);
+    cli_out_u64("high_bytes", cli_ctx.arena.high);
+    cli_out_u64("max_bytes", cli_ctx.arena.max);
+    cli_out_record_end();
+  } else {
+    cli_out_printf("Command arena: %zu bytes, high-water mark %zu bytes\n", cli_ctx.arena.cap, cli_ctx.arena.high);
+  }
+  return CLI_OK;
 }
 
-static void register_api_msg_meta() {
-  api_msg_meta_args.msg_id = arg_str1(NULL, NULL, "<Message ID>", "Message ID");
-  api_msg_meta_args.end = arg_end(2);
+static void register_stats() {
   cli_cmd_t cmd = {
-      .command = "api_msg_meta",
-      .help = "Get metadata from a given message ID",
-      .hint = " <Message ID>",
-      .func = &fn_api_msg_meta,
-      .argtable = &api_msg_meta_args,
+      .command = "stats",
+      .help = "Show latency statistics of commands and node API calls",
+      .hint = " [reset]",
+      .func = &fn_stats,
+      .args = stats_schema,
   };
   utarray_push_back(cli_ctx.cmd_array, &cmd);
 }
 
-/* 'api_address_outputs' command */
-static struct {
-  struct arg_str *addr;
-  struct arg_end *end;
-} api_address_outputs_args;
+/* 'cache' command */
+typedef struct {
+  char const *action;
+} cache_args_t;
 
-static int fn_api_address_outputs(int argc, char **argv) {
-  int nerrors = arg_parse(argc, argv, (void **)&api_address_outputs_args);
-  if (nerrors != 0) {
-    arg_print_errors(stderr, api_address_outputs_args.end, argv[0]);
-    return -1;
-  }
+static cli_arg_t const cache_schema[] = {
+    CLI_ARG_STR_OPT(cache_args_t, action, "clear", "Remove cached responses"),
+    CLI_ARGS_END,
+};
 
-  // check address
-  char const *const bech32_add_str = api_address_outputs_args.addr->sval[0];
-  if (strncmp(bech32_add_str, cli_ctx.wallet->bech32HRP, strlen(cli_ctx.wallet->bech32HRP)) != 0) {
-    printf("Invalid address hash\n");
-    return -2;
+static cli_err_t fn_cache(int argc, char **argv) {
+  char const *const kinds[CLI_RESP_KINDS] = {"message", "metadata", "output"};
+
+  cache_args_t args = {};
+  if (cli_args_parse(cache_schema, argc, argv, &args) != 0) {
+    return CLI_ERR_INVALID_ARG;
   }
 
-  res_outputs_address_t *res = res_outputs_address_new();
-  if (!res) {
-    printf("Allocate res_outputs_address_t failed\n");
-    return -3;
-  } else {
-    nerrors = get_outputs_from_address(&cli_ctx.wallet->endpoint, true, bech32_add_str, res);
-    if (nerrors != 0) {
-      printf("get_outputs_from_address error\n");
-    } else {
-      if (res->is_error) {
-        printf("%s\n", res->u.error->msg);
-      } else {
-        printf("Output IDs:\n");
-        for (uint32_t i = 0; i < res_outputs_address_output_id_count(res); i++) {
-          printf("%s\n", res_outputs_address_output_id(res, i));
-        }
-      }
+  if (args.action != NULL) {
+    if (strcmp(args.action, "clear") != 0) {
+      printf("unknown action: %s\n", args.action);
+      return CLI_ERR_INVALID_ARG;
     }
+    cli_resp_cache_clear(&cli_ctx.resp_cache);
+  }
+
+  cli_resp_cache_stats_t stats = {};
+  cli_resp_cache_stats(&cli_ctx.resp_cache, &stats);
+  if (cli_out_structured()) {
+    cli_out_record_begin("cache");
+    cli_out_u64("entries", stats.entries);
+    cli_out_u64("bytes", stats.bytes);
+    cli_out_u64("max_bytes", cli_ctx.resp_cache.max_bytes);
+    cli_out_u64("evictions", stats.evictions);
+    for (int i = 0; i < CLI_RESP_KINDS; i++) {
+      cli_out_object_begin(kinds[i]);
+      cli_out_u64("hits", stats.hits[i]);
+      cli_out_u64("misses", stats.misses[i]);
+      cli_out_u64("not_cacheable", stats.refused[i]);
+      cli_out_object_end();
+    }
+    cli_out_record_end();
+    return CLI_OK;
+  }
+  printf("Entries: %zu, memory: %zu/%zu bytes, evictions: %" PRIu64 "\n", stats.entries, stats.bytes,
+         cli_ctx.resp_cache.max_bytes, stats.evictions);
+  for (int i = 0; i < CLI_RESP_KINDS; i++) {
+    uint64_t lookups = stats.hits[i] + stats.misses[i];
+    printf("%s: hits %" PRIu64 ", misses %" PRIu64 ", hit rate %0.2f%%, not cacheable %" PRIu64 "\n", kinds[i],
+           stats.hits[i], stats.misses[i], lookups ? (double)stats.hits[i] * 100 / lookups : 0.0, stats.refused[i]);
+  }
+  return CLI_OK;
+}
 
-    res_outputs_address_free(res);
+static void register_cache() {
+  cli_cmd_t cmd = {
+      .command = "cache",
+      .help = "Show statistics of the response cache of messages, referenced metadata, and spent outputs",
+      .hint = " [clear]",
+      .func = &fn_cache,
+      .args = cache_schema,
+  };
+  utarray_push_back(cli_ctx.cmd_array, &cmd);
+}
+
+/* 'msg_store' command */
+static cli_err_t fn_msg_store(int argc, char **argv) {
+  if (cli_ctx.msg_store == NULL) {
+    printf("message store is not available%s\n", cli_ctx.data_dir[0] ? "" : ", the data directory is not set");
+    return CLI_ERR_FAILED;
   }
 
-  return nerrors;
+  cli_msg_store_stats_t stats = {};
+  cli_msg_store_stats(cli_ctx.msg_store, &stats);
+  if (cli_out_structured()) {
+    cli_out_record_begin("msg_store");
+    cli_out_str("path", cli_msg_store_path(cli_ctx.msg_store));
+    cli_out_str("network_id", cli_ctx.network_id);
+    cli_out_u64("messages", stats.records);
+    cli_out_u64("file_size", stats.file_size);
+    cli_out_u64("truncated", stats.truncated);
+    cli_out_u64("corrupted", stats.corrupted);
+    cli_out_u64("hits", stats.hits);
+    cli_out_u64("misses", stats.misses);
+    cli_out_record_end();
+    return CLI_OK;
+  }
+  printf("Path: %s, network: %s\n", cli_msg_store_path(cli_ctx.msg_store), cli_ctx.network_id);
+  printf("Messages: %zu, file size: %zu bytes, truncated at open: %zu bytes, corrupted: %zu bytes\n", stats.records,
+         stats.file_size, stats.truncated, stats.corrupted);
+  printf("Hits: %" PRIu64 ", misses: %" PRIu64 "\n", stats.hits, stats.misses);
+  return CLI_OK;
 }
 
-static void register_api_address_outputs() {
-  api_address_outputs_args.addr = arg_str1(NULL, NULL, "<Address>", "Address hash");
-  api_address_outputs_args.end = arg_end(2);
+static void register_msg_store() {
   cli_cmd_t cmd = {
-      .command = "api_address_outputs",
-      .help = "Get output ID list from a given address",
-      .hint = " <Address>",
-      .func = &fn_api_address_outputs,
-      .argtable = &api_address_outputs_args,
+      .command = "msg_store",
+      .help = "Show statistics of the on-disk message store",
+      .hint = NULL,
+      .func = &fn_msg_store,
+      .args = NULL,
+      .needs = CLI_NEED_NODE,
   };
   utarray_push_back(cli_ctx.cmd_array, &cmd);
 }
 
 /* 'api_get_output' command */
-static struct {
-  struct arg_str *output_id;
-  struct arg_end *end;
-} api_get_output_args;
+// a transaction ID and an output index of 2 bytes, hex encoded
+#define OUTPUT_ID_HEX_LEN (2 * (IOTA_MESSAGE_ID_BYTES + 2))
+
+typedef struct {
+  char const *output_id;
+} api_get_output_args_t;
+
+static cli_arg_t const api_get_output_schema[] = {
+    CLI_ARG_HEX(api_get_output_args_t, output_id, "<Output ID>", "An output ID", OUTPUT_ID_HEX_LEN),
+    CLI_ARGS_END,
+};
 
 static int fn_api_get_output(int argc, char **argv) {
-  int nerrors = arg_parse(argc, argv, (void **)&api_get_output_args);
+  api_get_output_args_t args = {};
+  int nerrors = cli_args_parse(api_get_output_schema, argc, argv, &args);
   if (nerrors != 0) {
-    arg_print_errors(stderr, api_get_output_args.end, argv[0]);
     return -1;
   }
 
   res_output_t res = {};
-  nerrors = get_output(&cli_ctx.wallet->endpoint, api_get_output_args.output_id->sval[0], &res);
+  nerrors = api_output(args.output_id, &res);
   if (nerrors != 0) {
     printf("get_output error\n");
     return -2;
   } else {
     if (res.is_error) {
       printf("%s\n", res.u.error->msg);
+      nerrors = CLI_NODE_ERROR_RESPONSE;
       res_err_free(res.u.error);
+    } else if (cli_out_structured()) {
+      cli_out_record_begin("output");
+      cli_out_str("output_id", args.output_id);
+      cli_out_str("msg_id", res.u.output.msg_id);
+      cli_out_str("tx_id", res.u.output.tx_id);
+      cli_out_u64("output_index", res.u.output.output_idx);
+      cli_out_bool("is_spent", res.u.output.is_spent);
+      cli_out_u64("ledger_index", res.u.output.ledger_idx);
+      cli_out_str("address", res.u.output.addr);
+      cli_out_u64("amount", res.u.output.amount);
+      cli_out_record_end();
     } else {
       dump_output_response(&res);
     }
@@ -743,14 +2159,12 @@ static int fn_api_get_output(int argc, char **argv) {
 }
 
 static void register_api_get_output() {
-  api_get_output_args.output_id = arg_str1(NULL, NULL, "<Output ID>", "An output ID");
-  api_get_output_args.end = arg_end(2);
   cli_cmd_t cmd = {
       .command = "api_get_output",
       .help = "Get the output object from a given output ID",
       .hint = " <Output ID>",
       .func = &fn_api_get_output,
-      .argtable = &api_get_output_args,
+      .args = api_get_output_schema,
   };
   utarray_push_back(cli_ctx.cmd_array, &cmd);
 }
@@ -764,15 +2178,29 @@ static int fn_api_tips(int argc, char **argv) {
     return -1;
   }
 
-  err = get_tips(&cli_ctx.wallet->endpoint, res);
+  err = api_tips(res);
   if (err != 0) {
     printf("get_tips error\n");
   } else {
     if (res->is_error) {
       printf("%s\n", res->u.error->msg);
+      err = CLI_NODE_ERROR_RESPONSE;
     } else {
+      if (cli_out_structured()) {
+        cli_out_record_begin("tips");
+        cli_out_array_begin("tips");
+      }
       for (size_t i = 0; i < get_tips_id_count(res); i++) {
-        printf("%s\n", get_tips_id(res, i));
+        if (cli_out_structured()) {
+          cli_out_str(NULL, get_tips_id(res, i));
+        } else {
+          printf("%s\n", get_tips_id(res, i));
+        }
+        hint_value_add(get_tips_id(res, i));
+      }
+      if (cli_out_structured()) {
+        cli_out_array_end();
+        cli_out_record_end();
       }
     }
   }
@@ -793,136 +2221,805 @@ static void register_api_tips() {
 
 /* 'api_get_output' command */
 
+// decode a hex string to a NUL terminated string, it's freed by the caller
+static char *hex_to_str(byte_buf_t const *hex) {
+  size_t hex_len = strlen((char const *)hex->data);
+  char *str = malloc(hex_len / 2 + 1);
+  if (str == NULL) {
+    return NULL;
+  }
+  if (cli_hex_decode((char const *)hex->data, hex_len, (uint8_t *)str, hex_len / 2) != 0) {
+    free(str);
+    return NULL;
+  }
+  str[hex_len / 2] = '\0';
+  return str;
+}
+
 static void dump_index_payload(payload_index_t *idx) {
   // dump Indexaction message
 
-  byte_buf_t *index_str = byte_buf_hex2str(idx->index);
-  byte_buf_t *data_str = byte_buf_hex2str(idx->data);
+  char *index_str = hex_to_str(idx->index);
+  char *data_str = hex_to_str(idx->data);
   if (index_str != NULL && data_str != NULL) {
-    printf("Index: %s\n\t%s\n", idx->index->data, index_str->data);
-    printf("Data: %s\n\t%s\n", idx->data->data, data_str->data);
+    cli_out_printf("Index: %s\n\t%s\n", idx->index->data, index_str);
+    cli_out_printf("Data: %s\n\t%s\n", idx->data->data, data_str);
   } else {
-    printf("buffer allocate failed\n");
+    cli_out_printf("buffer allocate failed\n");
+  }
+  free(index_str);
+  free(data_str);
+}
+
+// the bech32 address of an input, it's derived from the public key of the unlock block
+static int tx_input_address(payload_tx_t *tx, size_t i, char bech32[]) {
+  byte_t addr[ED25519_ADDRESS_BYTES] = {};
+  byte_t pub_key_bin[ED_PUBLIC_KEY_BYTES] = {};
+  if (cli_hex_decode(payload_tx_blocks_public_key(tx, payload_tx_inputs_tx_output_index(tx, i) - 1),
+                     ED_PUBLIC_KEY_BYTES * 2, pub_key_bin, sizeof(pub_key_bin)) != 0 ||
+      address_from_ed25519_pub(pub_key_bin, addr) != 0) {
+    return -1;
+  }
+  return cli_bech32_encode(cli_ctx.wallet->bech32HRP, addr, bech32);
+}
+
+static int tx_output_address(payload_tx_t *tx, size_t i, char bech32[]) {
+  byte_t addr[ED25519_ADDRESS_BYTES] = {};
+  if (cli_hex_decode(payload_tx_outputs_address(tx, i), ED25519_ADDRESS_BYTES * 2, addr, sizeof(addr)) != 0) {
+    return -1;
   }
-  byte_buf_free(index_str);
-  byte_buf_free(data_str);
+  return cli_bech32_encode(cli_ctx.wallet->bech32HRP, addr, bech32);
 }
 
 static void dump_tx_payload(payload_tx_t *tx) {
   char temp_addr[128] = {};
-  byte_t addr[IOTA_ADDRESS_BYTES] = {};
-  byte_t pub_key_bin[ED_PUBLIC_KEY_BYTES] = {};
 
-  // inputs
-  printf("Inputs:\n");
-  for (size_t i = 0; i < payload_tx_inputs_count(tx); i++) {
-    printf("\ttx ID[%zu]: %s\n\ttx output index[%zu]: %" PRIu32 "\n", i, payload_tx_inputs_tx_id(tx, i), i,
-           payload_tx_inputs_tx_output_index(tx, i));
+  // inputs
+  cli_out_printf("Inputs:\n");
+  for (size_t i = 0; i < payload_tx_inputs_count(tx); i++) {
+    cli_out_printf("\ttx ID[%zu]: %s\n\ttx output index[%zu]: %" PRIu32 "\n", i, payload_tx_inputs_tx_id(tx, i), i,
+                   payload_tx_inputs_tx_output_index(tx, i));
+
+    // get input address from public key
+    if (tx_input_address(tx, i, temp_addr) == 0) {
+      cli_out_printf("\taddress[%zu]: %s\n", i, temp_addr);
+      hint_value_add(temp_addr);
+    } else {
+      cli_out_printf("get address from public key error\n");
+    }
+  }
+
+  // outputs
+  cli_out_printf("Outputs:\n");
+  for (size_t i = 0; i < payload_tx_outputs_count(tx); i++) {
+    if (tx_output_address(tx, i, temp_addr) == 0) {
+      cli_out_printf("\tAddress[%zu]: %s\n\tAmount[%zu]: %" PRIu64 "\n", i, temp_addr, i,
+                     payload_tx_outputs_amount(tx, i));
+      hint_value_add(temp_addr);
+    } else {
+      cli_out_printf("[%s:%d] converting address failed\n", __FILE__, __LINE__);
+    }
+  }
+
+  // unlock blocks
+  cli_out_printf("Unlock blocks:\n");
+  for (size_t i = 0; i < payload_tx_blocks_count(tx); i++) {
+    cli_out_printf("\tPublic Key[%zu]: %s\n\tSignature[%zu]: %s\n", i, payload_tx_blocks_public_key(tx, i), i,
+                   payload_tx_blocks_signature(tx, i));
+  }
+
+  // payload?
+  if (tx->payload != NULL && tx->type == MSG_PAYLOAD_INDEXATION) {
+    dump_index_payload((payload_index_t *)tx->payload);
+  }
+}
+
+// output an indexation payload as fields of the current record
+static void out_index_payload(char const key[], payload_index_t *idx) {
+  char *index_str = hex_to_str(idx->index);
+  char *data_str = hex_to_str(idx->data);
+  cli_out_object_begin(key);
+  cli_out_str("type", "indexation");
+  cli_out_str("index", (char const *)idx->index->data);
+  cli_out_str("index_str", index_str);
+  cli_out_str("data", (char const *)idx->data->data);
+  cli_out_str("data_str", data_str);
+  cli_out_object_end();
+  free(index_str);
+  free(data_str);
+}
+
+// output a transaction payload as fields of the current record
+static void out_tx_payload(char const key[], payload_tx_t *tx) {
+  char temp_addr[128] = {};
+
+  cli_out_object_begin(key);
+  cli_out_str("type", "transaction");
+  cli_out_array_begin("inputs");
+  for (size_t i = 0; i < payload_tx_inputs_count(tx); i++) {
+    cli_out_object_begin(NULL);
+    cli_out_str("tx_id", payload_tx_inputs_tx_id(tx, i));
+    cli_out_u64("tx_output_index", payload_tx_inputs_tx_output_index(tx, i));
+    bool has_addr = tx_input_address(tx, i, temp_addr) == 0;
+    cli_out_str("address", has_addr ? temp_addr : NULL);
+    if (has_addr) {
+      hint_value_add(temp_addr);
+    }
+    cli_out_object_end();
+  }
+  cli_out_array_end();
+
+  cli_out_array_begin("outputs");
+  for (size_t i = 0; i < payload_tx_outputs_count(tx); i++) {
+    cli_out_object_begin(NULL);
+    bool has_addr = tx_output_address(tx, i, temp_addr) == 0;
+    cli_out_str("address", has_addr ? temp_addr : NULL);
+    if (has_addr) {
+      hint_value_add(temp_addr);
+    }
+    cli_out_u64("amount", payload_tx_outputs_amount(tx, i));
+    cli_out_object_end();
+  }
+  cli_out_array_end();
+
+  cli_out_array_begin("unlock_blocks");
+  for (size_t i = 0; i < payload_tx_blocks_count(tx); i++) {
+    cli_out_object_begin(NULL);
+    cli_out_str("public_key", payload_tx_blocks_public_key(tx, i));
+    cli_out_str("signature", payload_tx_blocks_signature(tx, i));
+    cli_out_object_end();
+  }
+  cli_out_array_end();
+
+  if (tx->payload != NULL && tx->type == MSG_PAYLOAD_INDEXATION) {
+    out_index_payload("payload", (payload_index_t *)tx->payload);
+  }
+  cli_out_object_end();
+}
+
+/* 'api_send_msg' command */
+// build an indexation message on the given parents, do PoW locally and send it out
+static int send_indexation_on(char const *const parents[], size_t parents_len, char const index[], byte_t const data[],
+                              size_t data_len, size_t pow_threads, cli_pow_result_t *pow, double *submit_secs,
+                              res_send_message_t *res) {
+  if (cli_ctx.network_id[0] == '\0') {
+    printf("network of the node is unknown\n");
+    return -1;
+  }
+
+  byte_buf_t *msg = byte_buf_new();
+  if (msg == NULL) {
+    return -1;
+  }
+  int ret =
+      cli_msg_indexation(cli_msg_network_id(cli_ctx.network_id), parents, parents_len, index, data, data_len, msg);
+  if (ret != 0) {
+    printf("build message failed\n");
+  } else if ((ret = cli_pow_message(msg->data, msg->len, cli_ctx.min_pow_score, pow_threads, pow)) != 0) {
+    printf("PoW failed\n");
+  } else {
+    struct timespec ts_start, ts_end;
+    clock_gettime(CLOCK_MONOTONIC, &ts_start);
+    ret = api_post_message("application/octet-stream", msg->data, msg->len, res);
+    clock_gettime(CLOCK_MONOTONIC, &ts_end);
+    if (submit_secs) {
+      *submit_secs = (ts_end.tv_sec - ts_start.tv_sec) + (ts_end.tv_nsec - ts_start.tv_nsec) / 1e9;
+    }
+  }
+  byte_buf_free(msg);
+  return ret;
+}
+
+// send an indexation message on tips
+static int send_indexation_local(char const index[], char const data[], res_send_message_t *res) {
+  char tips[CLI_MSG_PARENTS_MAX][CLI_TIP_ID_BUF];
+  char const *parents[CLI_MSG_PARENTS_MAX] = {};
+  size_t parents_len = get_parents(tips, CLI_MSG_PARENTS_MAX);
+  if (parents_len == 0) {
+    printf("get_tips error\n");
+    return -1;
+  }
+  for (size_t i = 0; i < parents_len; i++) {
+    parents[i] = tips[i];
+  }
+
+  cli_pow_result_t pow = {};
+  int ret = send_indexation_on(parents, parents_len, index, (byte_t const *)data, strlen(data), CLI_POW_THREADS, &pow,
+                               NULL, res);
+  if (ret == 0) {
+    printf("PoW: %u zeros in %0.3fs, %0.1f kH/s with %zu threads\n", pow.zeros, pow.elapsed,
+           pow.elapsed > 0 ? pow.hashes / pow.elapsed / 1000 : 0.0, pow.threads);
+  }
+  return ret;
+}
+
+// send an indexation message without parents and nonce, the node picks tips and does PoW
+static int send_indexation_remote(char const index[], char const data[], res_send_message_t *res) {
+  static char const head[] = "{\"payload\":{\"type\":2,\"index\":\"";
+  static char const mid[] = "\",\"data\":\"";
+  static char const tail[] = "\"}}";
+  size_t index_len = strlen(index), data_len = strlen(data);
+  char *body = malloc(sizeof(head) + sizeof(mid) + sizeof(tail) + (index_len + data_len) * 2);
+  if (body == NULL) {
+    return -1;
+  }
+
+  char *p = body;
+  memcpy(p, head, sizeof(head) - 1);
+  p += sizeof(head) - 1;
+  cli_hex_encode((uint8_t const *)index, index_len, p);
+  p += index_len * 2;
+  memcpy(p, mid, sizeof(mid) - 1);
+  p += sizeof(mid) - 1;
+  cli_hex_encode((uint8_t const *)data, data_len, p);
+  p += data_len * 2;
+  memcpy(p, tail, sizeof(tail));
+  p += sizeof(tail) - 1;
+
+  int ret = api_post_message("application/json", (byte_t const *)body, (size_t)(p - body), res);
+  free(body);
+  return ret;
+}
+
+typedef struct {
+  char const *index;
+  char const *data;
+  bool remote;
+} api_send_msg_args_t;
+
+static cli_arg_t const api_send_msg_schema[] = {
+    CLI_ARG_STR(api_send_msg_args_t, index, "<Index>", "Message Index"),
+    CLI_ARG_STR(api_send_msg_args_t, data, "<Data>", "Message data"),
+    CLI_ARG_FLAG(api_send_msg_args_t, remote, 'r', "remote", "PoW on the node"),
+    CLI_ARGS_END,
+};
+
+static int fn_api_send_msg(int argc, char **argv) {
+  api_send_msg_args_t args = {};
+  int nerrors = cli_args_parse(api_send_msg_schema, argc, argv, &args);
+  if (nerrors != 0) {
+    return -1;
+  }
+  // send indexaction payload
+  res_send_message_t res = {};
+  if (args.remote) {
+    nerrors = send_indexation_remote(args.index, args.data, &res);
+  } else {
+    nerrors = send_indexation_local(args.index, args.data, &res);
+  }
+  if (nerrors != 0) {
+    printf("send_indexation_msg error\n");
+  } else {
+    if (res.is_error) {
+      printf("%s\n", res.u.error->msg);
+      nerrors = CLI_NODE_ERROR_RESPONSE;
+      res_err_free(res.u.error);
+    } else {
+      if (cli_out_structured()) {
+        cli_out_record_begin("msg_sent");
+        cli_out_str("msg_id", res.u.msg_id);
+        cli_out_record_end();
+      } else {
+        printf("Message ID: %s\n", res.u.msg_id);
+      }
+      hint_value_add(res.u.msg_id);
+    }
+  }
+  return nerrors;
+}
+
+static void register_api_send_msg() {
+  cli_cmd_t cmd = {
+      .command = "api_send_msg",
+      .help = "Send out a data message to the Tangle",
+      .hint = " <Index> <Data> [--remote]",
+      .func = &fn_api_send_msg,
+      .args = api_send_msg_schema,
+      .needs = CLI_NEED_WALLET | CLI_NEED_NODE,
+  };
+  utarray_push_back(cli_ctx.cmd_array, &cmd);
+}
+
+/* 'api_send_bulk' command */
+typedef struct {
+  size_t line;    /*!< line number of the record */
+  char *record;   /*!< the record line, the index and data point into it */
+  size_t record_cap;
+  char const *index;
+  char const *data;
+  char parents[CLI_MSG_PARENTS_MAX][CLI_TIP_ID_BUF];
+  size_t parents_len;
+  char msg_id[IOTA_MESSAGE_ID_HEX_BYTES + 1];
+  char err[128];
+  double latency; /*!< submit latency in seconds */
+} bulk_rec_t;
+
+typedef struct {
+  FILE *fp;
+  size_t line_no;
+  bulk_rec_t *recs;            /*!< records of the slots of the stream */
+  char(*tips)[CLI_TIP_ID_BUF]; /*!< tips shared by CLI_BULK_CHUNK records */
+  size_t tips_len;
+  size_t tips_uses;            /*!< number of records sent on the tips */
+  bool tips_failed;            /*!< the stream is ended by a failed tips request */
+  size_t pow_threads;          /*!< PoW threads per message */
+  size_t sent;
+  size_t failed;
+  double *latency;             /*!< submit latencies of sent messages */
+  size_t latency_len;
+  size_t latency_cap;
+} bulk_t;
+
+// split a record line into the index and data, return false if it's not a record
+static bool bulk_parse(char *line, char const **index, char const **data) {
+  line[strcspn(line, "\r\n")] = '\0';
+  if (line[0] == '\0' || line[0] == '#') {
+    return false;
+  }
+  // "<index> <data>", data is the rest of the line
+  char *sep = line + strcspn(line, " \t");
+  *index = line;
+  if (*sep != '\0') {
+    *sep++ = '\0';
+  }
+  *data = sep;
+  return true;
+}
+
+// read the next record into a slot, the window of in-flight messages is refilled as soon as one is done
+static bool bulk_fetch(void *ctx, size_t slot) {
+  bulk_t *b = (bulk_t *)ctx;
+  bulk_rec_t *rec = &b->recs[slot];
+
+  do {
+    if (getline(&rec->record, &rec->record_cap, b->fp) < 0) {
+      return false;
+    }
+    b->line_no++;
+  } while (!bulk_parse(rec->record, &rec->index, &rec->data));
+  rec->line = b->line_no;
+  rec->msg_id[0] = '\0';
+  rec->err[0] = '\0';
+  rec->latency = 0;
+
+  if (b->tips_len == 0 || b->tips_uses == CLI_BULK_CHUNK) {
+    if ((b->tips_len = get_parents(b->tips, CLI_TIP_POOL_MAX)) == 0) {
+      printf("get_tips error\n");
+      b->tips_failed = true;
+      return false;
+    }
+    b->tips_uses = 0;
+  }
+  // messages on the same tips approve different subsets of them
+  rec->parents_len = b->tips_len < CLI_MSG_PARENTS_MAX ? b->tips_len : CLI_MSG_PARENTS_MAX;
+  for (size_t i = 0; i < rec->parents_len; i++) {
+    memcpy(rec->parents[i], b->tips[(b->tips_uses + i) % b->tips_len], CLI_TIP_ID_BUF);
+  }
+  b->tips_uses++;
+  return true;
+}
+
+static void bulk_task(void *ctx, size_t idx) {
+  bulk_t *b = (bulk_t *)ctx;
+  bulk_rec_t *rec = &b->recs[idx];
+  char const *parents[CLI_MSG_PARENTS_MAX] = {};
+  size_t parents_len = rec->parents_len;
+
+  for (size_t i = 0; i < parents_len; i++) {
+    parents[i] = rec->parents[i];
+  }
+
+  res_send_message_t res = {};
+  cli_pow_result_t pow = {};
+  if (send_indexation_on(parents, parents_len, rec->index, (byte_t const *)rec->data, strlen(rec->data),
+                         b->pow_threads, &pow, &rec->latency, &res) != 0) {
+    snprintf(rec->err, sizeof(rec->err), "send failed");
+  } else if (res.is_error) {
+    snprintf(rec->err, sizeof(rec->err), "%s", res.u.error->msg);
+    res_err_free(res.u.error);
+  } else {
+    strncpy(rec->msg_id, res.u.msg_id, IOTA_MESSAGE_ID_HEX_BYTES);
+  }
+}
+
+static bool bulk_emit(void *ctx, size_t idx) {
+  bulk_t *b = (bulk_t *)ctx;
+  bulk_rec_t *rec = &b->recs[idx];
+
+  if (rec->err[0]) {
+    printf("line %zu: Err: %s\n", rec->line, rec->err);
+    b->failed++;
+    return true;
+  }
+
+  if (cli_out_structured()) {
+    cli_out_record_begin("msg_sent");
+    cli_out_u64("line", rec->line);
+    cli_out_str("msg_id", rec->msg_id);
+    cli_out_double("latency", rec->latency);
+    cli_out_record_end();
+  } else {
+    printf("line %zu: %s\n", rec->line, rec->msg_id);
+  }
+  hint_value_add(rec->msg_id);
+  b->sent++;
+  if (b->latency_len == b->latency_cap) {
+    size_t cap = b->latency_cap ? b->latency_cap * 2 : CLI_BULK_CHUNK;
+    double *latency = realloc(b->latency, cap * sizeof(double));
+    if (latency == NULL) {
+      // stats are not collected anymore
+      return true;
+    }
+    b->latency = latency;
+    b->latency_cap = cap;
+  }
+  b->latency[b->latency_len++] = rec->latency;
+  return true;
+}
+
+static int latency_cmp(void const *a, void const *b) {
+  double x = *(double const *)a, y = *(double const *)b;
+  return x < y ? -1 : x > y;
+}
+
+typedef struct {
+  char const *file;
+  uint32_t inflight;
+} api_send_bulk_args_t;
+
+static cli_arg_t const api_send_bulk_schema[] = {
+    CLI_ARG_STR(api_send_bulk_args_t, file, "<file|->", "records of \"<Index> <Data>\" per line, - for stdin"),
+    CLI_ARG_U32_OPT(api_send_bulk_args_t, inflight, "<inflight>", "max number of in-flight messages", 1,
+                    CLI_BULK_INFLIGHT_MAX, CLI_BULK_INFLIGHT),
+    CLI_ARGS_END,
+};
+
+static cli_err_t fn_api_send_bulk(int argc, char **argv) {
+  api_send_bulk_args_t args = {};
+  if (cli_args_parse(api_send_bulk_schema, argc, argv, &args) != 0) {
+    return CLI_ERR_INVALID_ARG;
+  }
+
+  int inflight = (int)args.inflight;
+  char const *path = args.file;
+  bool from_stdin = strcmp(path, "-") == 0;
+  if (from_stdin && cli_ctx.stdin_reserved) {
+    printf("stdin is used for commands, records must be in a file\n");
+    return CLI_ERR_INVALID_ARG;
+  }
+  FILE *fp = from_stdin ? stdin : fopen(path, "r");
+  if (fp == NULL) {
+    printf("open %s failed\n", path);
+    return CLI_ERR_FAILED;
+  }
+
+  bulk_t b = {.fp = fp};
+  // PoW of in-flight messages share the CPUs
+  long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+  b.pow_threads = cpus > inflight ? (size_t)(cpus / inflight) : 1;
+  // a slow message holds the output order, the others go on in the extra slots
+  size_t slots = (size_t)inflight * 2;
+  b.recs = calloc(slots, sizeof(bulk_rec_t));
+  b.tips = malloc(CLI_TIP_POOL_MAX * CLI_TIP_ID_BUF);
+  if (b.recs == NULL || b.tips == NULL) {
+    free(b.recs);
+    free(b.tips);
+    if (!from_stdin) {
+      fclose(fp);
+    }
+    return CLI_ERR_OOM;
+  }
+
+  struct timespec ts_start, ts_end;
+  clock_gettime(CLOCK_MONOTONIC, &ts_start);
+  cli_parallel_stream((size_t)inflight, slots, bulk_fetch, bulk_task, bulk_emit, &b);
+  clock_gettime(CLOCK_MONOTONIC, &ts_end);
+  cli_err_t ret = b.tips_failed ? CLI_ERR_FAILED : CLI_OK;
+  for (size_t i = 0; i < slots; i++) {
+    free(b.recs[i].record);
+  }
+  free(b.recs);
+  free(b.tips);
+  if (!from_stdin) {
+    fclose(fp);
+  }
+
+  double elapsed = (ts_end.tv_sec - ts_start.tv_sec) + (ts_end.tv_nsec - ts_start.tv_nsec) / 1e9;
+  printf("sent %zu messages in %0.3fs, %0.1f messages/s with %d in flight, %zu failed\n", b.sent, elapsed,
+         elapsed > 0 ? b.sent / elapsed : 0.0, inflight, b.failed);
+  double p50 = 0, p99 = 0;
+  if (b.latency_len > 0) {
+    qsort(b.latency, b.latency_len, sizeof(double), latency_cmp);
+    p50 = b.latency[(b.latency_len - 1) / 2];
+    p99 = b.latency[(b.latency_len - 1) * 99 / 100];
+    printf("submit latency p50: %0.1fms, p99: %0.1fms\n", p50 * 1000, p99 * 1000);
+  }
+  if (cli_out_structured()) {
+    cli_out_record_begin("bulk_summary");
+    cli_out_u64("sent", b.sent);
+    cli_out_u64("failed", b.failed);
+    cli_out_i64("inflight", inflight);
+    cli_out_double("elapsed", elapsed);
+    cli_out_double("latency_p50", p50);
+    cli_out_double("latency_p99", p99);
+    cli_out_record_end();
+  }
+  free(b.latency);
+  if (ret == CLI_OK && b.failed) {
+    ret = CLI_ERR_FAILED;
+  }
+  return ret;
+}
+
+static void register_api_send_bulk() {
+  cli_cmd_t cmd = {
+      .command = "api_send_bulk",
+      .help = "Send out data messages of records in a file",
+      .hint = " <file|-> [inflight]",
+      .func = &fn_api_send_bulk,
+      .args = api_send_bulk_schema,
+      .needs = CLI_NEED_NODE,
+  };
+  utarray_push_back(cli_ctx.cmd_array, &cmd);
+}
+
+/* 'pow_bench' command */
+typedef struct {
+  uint32_t threads;
+  uint32_t rounds;
+} pow_bench_args_t;
+
+static cli_arg_t const pow_bench_schema[] = {
+    CLI_ARG_U32_OPT(pow_bench_args_t, threads, "<threads>", "number of threads, 0 for the number of CPUs", 0, INT32_MAX,
+                    CLI_POW_THREADS),
+    CLI_ARG_U32_OPT(pow_bench_args_t, rounds, "<rounds>", "number of nonce searches", 1, INT32_MAX,
+                    CLI_POW_BENCH_ROUNDS),
+    CLI_ARGS_END,
+};
+
+static cli_err_t fn_pow_bench(int argc, char **argv) {
+  pow_bench_args_t args = {};
+  if (cli_args_parse(pow_bench_schema, argc, argv, &args) != 0) {
+    return CLI_ERR_INVALID_ARG;
+  }
+
+  int threads = (int)args.threads;
+  int rounds = (int)args.rounds;
+
+  // the difficulty of a typical message on the connected node
+  uint64_t score = cli_ctx.min_pow_score ? cli_ctx.min_pow_score : CLI_POW_BENCH_SCORE;
+  unsigned zeros = cli_pow_target_zeros(score, CLI_POW_BENCH_MSG_LEN);
+  printf("PoW score %" PRIu64 ", %d bytes message, %u trailing zeros\n", score, CLI_POW_BENCH_MSG_LEN, zeros);
+
+  uint64_t hashes = 0;
+  double elapsed = 0;
+  size_t used = 0;
+  for (int r = 0; r < rounds; r++) {
+    // a different digest per round
+    byte_t seed[sizeof(int) + sizeof(struct timespec)] = {};
+    byte_t digest[CLI_POW_DIGEST_BYTES];
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    memcpy(seed, &r, sizeof(int));
+    memcpy(seed + sizeof(int), &ts, sizeof(ts));
+    iota_blake2b_sum(seed, sizeof(seed), digest, sizeof(digest));
+
+    cli_pow_result_t pow = {};
+    if (cli_pow_search(digest, zeros, (size_t)threads, &pow) != 0) {
+      printf("Err: PoW failed\n");
+      return CLI_ERR_FAILED;
+    }
+    printf("round %d: nonce %" PRIu64 ", %u zeros, %" PRIu64 " hashes in %0.3fs\n", r, pow.nonce, pow.zeros,
+           pow.hashes, pow.elapsed);
+    hashes += pow.hashes;
+    elapsed += pow.elapsed;
+    used = pow.threads;
+  }
+
+  double rate = elapsed > 0 ? hashes / elapsed : 0.0;
+  printf("%zu threads: %0.1f kH/s, %0.3fs per message on average, %0.2f messages/s\n", used, rate / 1000,
+         elapsed / rounds, elapsed > 0 ? rounds / elapsed : 0.0);
+  if (cli_out_structured()) {
+    cli_out_record_begin("pow_bench");
+    cli_out_u64("score", score);
+    cli_out_u64("zeros", zeros);
+    cli_out_u64("threads", used);
+    cli_out_i64("rounds", rounds);
+    cli_out_u64("hashes", hashes);
+    cli_out_double("elapsed", elapsed);
+    cli_out_double("hashes_per_sec", rate);
+    cli_out_record_end();
+  }
+  return CLI_OK;
+}
+
+static void register_pow_bench() {
+  cli_cmd_t cmd = {
+      .command = "pow_bench",
+      .help = "Benchmark the local PoW at the min PoW score of the node",
+      .hint = " [threads] [rounds]",
+      .func = &fn_pow_bench,
+      .args = pow_bench_schema,
+  };
+  utarray_push_back(cli_ctx.cmd_array, &cmd);
+}
+
+/* 'codec_bench' command */
+typedef struct {
+  uint32_t count;
+} codec_bench_args_t;
+
+static cli_arg_t const codec_bench_schema[] = {
+    CLI_ARG_U32_OPT(codec_bench_args_t, count, "<count>", "number of addresses", 1, INT32_MAX, CLI_CODEC_BENCH_COUNT),
+    CLI_ARGS_END,
+};
+
+typedef enum { CODEC_HEX_ENCODE = 0, CODEC_HEX_DECODE, CODEC_BECH32 } codec_op_t;
 
-    // get input address from public key
-    if (hex_2_bin(payload_tx_blocks_public_key(tx, payload_tx_inputs_tx_output_index(tx, i) - 1),
-                  API_PUB_KEY_HEX_STR_LEN, pub_key_bin, ED_PUBLIC_KEY_BYTES) == 0) {
-      if (address_from_ed25519_pub(pub_key_bin, addr + 1) == 0) {
-        addr[0] = ADDRESS_VER_ED25519;
-        // address bin to bech32 hex string
-        if (address_2_bech32(addr, cli_ctx.wallet->bech32HRP, temp_addr) == 0) {
-          printf("\taddress[%zu]: %s\n", i, temp_addr);
-        } else {
-          printf("convert address to bech32 error\n");
-        }
-      } else {
-        printf("get address from public key error\n");
-      }
+static char const *const codec_op_names[] = {"hex encode", "hex decode", "bech32"};
+
+typedef struct {
+  size_t count;     /*!< number of addresses */
+  byte_t *bin;      /*!< ed25519 addresses */
+  char *ref_hex;    /*!< hex strings by iota.c */
+  char *ref_bech32; /*!< bech32 addresses by iota.c */
+  byte_t *out_bin;  /*!< decoded addresses */
+  char *out_hex;    /*!< encoded hex strings */
+  char *out_bech32; /*!< encoded bech32 addresses */
+} codec_bench_t;
+
+#define CODEC_HEX_BUF (ED25519_ADDRESS_BYTES * 2 + 1)
+
+static double mono_secs() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// run an operation on all addresses with the iota.c functions, returns the elapsed seconds
+static double codec_bench_ref(codec_bench_t *b, codec_op_t op) {
+  byte_t addr[IOTA_ADDRESS_BYTES] = {ADDRESS_VER_ED25519};
+  double start = mono_secs();
+  for (size_t i = 0; i < b->count; i++) {
+    byte_t *bin = b->bin + i * ED25519_ADDRESS_BYTES;
+    if (op == CODEC_HEX_ENCODE) {
+      bin_2_hex(bin, ED25519_ADDRESS_BYTES, b->ref_hex + i * CODEC_HEX_BUF, CODEC_HEX_BUF);
+    } else if (op == CODEC_HEX_DECODE) {
+      hex_2_bin(b->ref_hex + i * CODEC_HEX_BUF, ED25519_ADDRESS_BYTES * 2, b->out_bin + i * ED25519_ADDRESS_BYTES,
+                ED25519_ADDRESS_BYTES);
     } else {
-      printf("convert pub key to binary failed\n");
+      memcpy(addr + 1, bin, ED25519_ADDRESS_BYTES);
+      address_2_bech32(addr, cli_ctx.wallet->bech32HRP, b->ref_bech32 + i * CLI_BECH32_ADDR_BUF);
     }
   }
+  return mono_secs() - start;
+}
 
-  // outputs
-  printf("Outputs:\n");
-  for (size_t i = 0; i < payload_tx_outputs_count(tx); i++) {
-    addr[0] = ADDRESS_VER_ED25519;
-    // address hex to bin
-    if (hex_2_bin(payload_tx_outputs_address(tx, i), IOTA_ADDRESS_HEX_BYTES + 1, addr + 1, ED25519_ADDRESS_BYTES) ==
-        0) {
-      // address bin to bech32
-      if (address_2_bech32(addr, cli_ctx.wallet->bech32HRP, temp_addr) == 0) {
-        printf("\tAddress[%zu]: %s\n\tAmount[%zu]: %" PRIu64 "\n", i, temp_addr, i, payload_tx_outputs_amount(tx, i));
-      } else {
-        printf("[%s:%d] converting bech32 address failed\n", __FILE__, __LINE__);
-      }
-    } else {
-      printf("[%s:%d] converting binary address failed\n", __FILE__, __LINE__);
+// run an operation on all addresses with cli_codec, returns the elapsed seconds
+static double codec_bench_cli(codec_bench_t *b, codec_op_t op) {
+  double start = mono_secs();
+  if (op == CODEC_HEX_ENCODE) {
+    for (size_t i = 0; i < b->count; i++) {
+      cli_hex_encode(b->bin + i * ED25519_ADDRESS_BYTES, ED25519_ADDRESS_BYTES, b->out_hex + i * CODEC_HEX_BUF);
+    }
+  } else if (op == CODEC_HEX_DECODE) {
+    for (size_t i = 0; i < b->count; i++) {
+      cli_hex_decode(b->ref_hex + i * CODEC_HEX_BUF, ED25519_ADDRESS_BYTES * 2, b->out_bin + i * ED25519_ADDRESS_BYTES,
+                     ED25519_ADDRESS_BYTES);
     }
+  } else {
+    cli_bech32_encode_batch(cli_ctx.wallet->bech32HRP, b->bin, ED25519_ADDRESS_BYTES, b->count, b->out_bech32,
+                            CLI_BECH32_ADDR_BUF);
   }
+  return mono_secs() - start;
+}
 
-  // unlock blocks
-  printf("Unlock blocks:\n");
-  for (size_t i = 0; i < payload_tx_blocks_count(tx); i++) {
-    printf("\tPublic Key[%zu]: %s\n\tSignature[%zu]: %s\n", i, payload_tx_blocks_public_key(tx, i), i,
-           payload_tx_blocks_signature(tx, i));
+// count results which are different from iota.c
+static size_t codec_bench_verify(codec_bench_t *b, codec_op_t op) {
+  size_t mismatches = 0;
+  for (size_t i = 0; i < b->count; i++) {
+    if (op == CODEC_HEX_ENCODE) {
+      mismatches += strcmp(b->out_hex + i * CODEC_HEX_BUF, b->ref_hex + i * CODEC_HEX_BUF) != 0;
+    } else if (op == CODEC_HEX_DECODE) {
+      mismatches += memcmp(b->out_bin + i * ED25519_ADDRESS_BYTES, b->bin + i * ED25519_ADDRESS_BYTES,
+                           ED25519_ADDRESS_BYTES) != 0;
+    } else {
+      mismatches += strcmp(b->out_bech32 + i * CLI_BECH32_ADDR_BUF, b->ref_bech32 + i * CLI_BECH32_ADDR_BUF) != 0;
+    }
   }
+  return mismatches;
+}
 
-  // payload?
-  if (tx->payload != NULL && tx->type == MSG_PAYLOAD_INDEXATION) {
-    dump_index_payload((payload_index_t *)tx->payload);
+static void codec_bench_report(codec_op_t op, char const impl[], size_t count, double secs, double ref_secs,
+                               size_t mismatches) {
+  double ns = count ? secs * 1e9 / count : 0.0;
+  double speedup = secs > 0 ? ref_secs / secs : 0.0;
+  printf("%-10s %-7s %8.1f ns/addr %6.2fx%s\n", codec_op_names[op], impl, ns, speedup,
+         mismatches ? " MISMATCH" : "");
+  if (cli_out_structured()) {
+    cli_out_record_begin("codec_bench");
+    cli_out_str("op", codec_op_names[op]);
+    cli_out_str("impl", impl);
+    cli_out_u64("count", count);
+    cli_out_double("ns_per_addr", ns);
+    cli_out_double("speedup", speedup);
+    cli_out_u64("mismatches", mismatches);
+    cli_out_record_end();
   }
 }
 
-/* 'api_send_msg' command */
-static struct {
-  struct arg_str *index;
-  struct arg_str *data;
-  struct arg_end *end;
-} api_send_msg_args;
-
-static int fn_api_send_msg(int argc, char **argv) {
-  int nerrors = arg_parse(argc, argv, (void **)&api_send_msg_args);
-  if (nerrors != 0) {
-    arg_print_errors(stderr, api_send_msg_args.end, argv[0]);
-    return -1;
+static cli_err_t fn_codec_bench(int argc, char **argv) {
+  codec_bench_args_t args = {};
+  if (cli_args_parse(codec_bench_schema, argc, argv, &args) != 0) {
+    return CLI_ERR_INVALID_ARG;
   }
-  // send indexaction payload
-  res_send_message_t res = {};
-  nerrors = send_indexation_msg(&cli_ctx.wallet->endpoint, api_send_msg_args.index->sval[0],
-                                api_send_msg_args.data->sval[0], &res);
-  if (nerrors != 0) {
-    printf("send_indexation_msg error\n");
-  } else {
-    if (res.is_error) {
-      printf("%s\n", res.u.error->msg);
-      res_err_free(res.u.error);
-    } else {
-      printf("Message ID: %s\n", res.u.msg_id);
+
+  codec_bench_t b = {.count = args.count};
+  b.bin = malloc(b.count * ED25519_ADDRESS_BYTES);
+  b.out_bin = malloc(b.count * ED25519_ADDRESS_BYTES);
+  b.ref_hex = malloc(b.count * CODEC_HEX_BUF);
+  b.out_hex = malloc(b.count * CODEC_HEX_BUF);
+  b.ref_bech32 = calloc(b.count, CLI_BECH32_ADDR_BUF);
+  b.out_bech32 = calloc(b.count, CLI_BECH32_ADDR_BUF);
+  cli_err_t ret = CLI_OK;
+  if (!b.bin || !b.out_bin || !b.ref_hex || !b.out_hex || !b.ref_bech32 || !b.out_bech32) {
+    ret = CLI_ERR_OOM;
+    goto done;
+  }
+  srand((unsigned)time(NULL));
+  for (size_t i = 0; i < b.count * ED25519_ADDRESS_BYTES; i++) {
+    b.bin[i] = (byte_t)rand();
+  }
+
+  cli_codec_isa_t isa = cli_codec_isa();
+  printf("%zu addresses, %s is available\n", b.count, cli_codec_isa_name(isa));
+  for (codec_op_t op = CODEC_HEX_ENCODE; op <= CODEC_BECH32; op++) {
+    double ref_secs = codec_bench_ref(&b, op);
+    codec_bench_report(op, "iota.c", b.count, ref_secs, ref_secs, 0);
+    for (cli_codec_isa_t i = CLI_CODEC_SCALAR; i <= isa; i++) {
+      cli_codec_set_isa(i);
+      double secs = codec_bench_cli(&b, op);
+      codec_bench_report(op, cli_codec_isa_name(i), b.count, secs, ref_secs, codec_bench_verify(&b, op));
     }
+    cli_codec_set_isa(isa);
   }
-  return nerrors;
+
+done:
+  free(b.bin);
+  free(b.out_bin);
+  free(b.ref_hex);
+  free(b.out_hex);
+  free(b.ref_bech32);
+  free(b.out_bech32);
+  return ret;
 }
 
-static void register_api_send_msg() {
-  api_send_msg_args.index = arg_str1(NULL, NULL, "<Index>", "Message Index");
-  api_send_msg_args.data = arg_str1(NULL, NULL, "<Data>", "Message data");
-  api_send_msg_args.end = arg_end(3);
+static void register_codec_bench() {
   cli_cmd_t cmd = {
-      .command = "api_send_msg",
-      .help = "Send out a data message to the Tangle",
-      .hint = " <Index> <Data>",
-      .func = &fn_api_send_msg,
-      .argtable = &api_send_msg_args,
+      .command = "codec_bench",
+      .help = "Benchmark hex and bech32 codecs against iota.c",
+      .hint = " [count]",
+      .func = &fn_codec_bench,
+      .args = codec_bench_schema,
+      .needs = CLI_NEED_WALLET,
   };
   utarray_push_back(cli_ctx.cmd_array, &cmd);
 }
 
 /* 'api_get_msg' command */
-static struct {
-  struct arg_str *msg_id;
-  struct arg_end *end;
-} api_get_msg_args;
+typedef struct {
+  char const *msg_id;
+} api_get_msg_args_t;
+
+static cli_arg_t const api_get_msg_schema[] = {
+    CLI_ARG_HEX(api_get_msg_args_t, msg_id, "<Message ID>", "Message ID", IOTA_MESSAGE_ID_HEX_BYTES),
+    CLI_ARGS_END,
+};
 
 static int fn_api_get_msg(int argc, char **argv) {
-  int nerrors = arg_parse(argc, argv, (void **)&api_get_msg_args);
+  api_get_msg_args_t args = {};
+  int nerrors = cli_args_parse(api_get_msg_schema, argc, argv, &args);
   if (nerrors != 0) {
-    arg_print_errors(stderr, api_get_msg_args.end, argv[0]);
     return -1;
   }
 
@@ -931,23 +3028,44 @@ static int fn_api_get_msg(int argc, char **argv) {
     return CLI_ERR_OOM;
   }
 
-  nerrors = get_message_by_id(&cli_ctx.wallet->endpoint, api_get_msg_args.msg_id->sval[0], res);
+  nerrors = api_message(args.msg_id, res);
   if (nerrors == 0) {
     if (res->is_error) {
       printf("%s\n", res->u.error->msg);
+      nerrors = CLI_NODE_ERROR_RESPONSE;
+    } else if (cli_out_structured()) {
+      message_t *msg = res->u.msg;
+      cli_out_record_begin("message");
+      cli_out_str("msg_id", args.msg_id);
+      cli_out_str("network_id", msg->net_id);
+      cli_out_array_begin("parents");
+      for (size_t i = 0; i < api_message_parent_count(msg); i++) {
+        cli_out_str(NULL, api_message_parent_id(msg, i));
+        hint_value_add(api_message_parent_id(msg, i));
+      }
+      cli_out_array_end();
+      if (msg->type == MSG_PAYLOAD_INDEXATION) {
+        out_index_payload("payload", (payload_index_t *)msg->payload);
+      } else if (msg->type == MSG_PAYLOAD_TRANSACTION) {
+        out_tx_payload("payload", (payload_tx_t *)msg->payload);
+      } else {
+        cli_out_i64("payload_type", msg->type);
+      }
+      cli_out_record_end();
     } else {
       message_t *msg = res->u.msg;
-      printf("Network ID: %s\n", msg->net_id);
-      printf("Parent Message ID:\n");
+      cli_out_printf("Network ID: %s\n", msg->net_id);
+      cli_out_printf("Parent Message ID:\n");
       for (size_t i = 0; i < api_message_parent_count(msg); i++) {
-        printf("\t%s\n", api_message_parent_id(msg, i));
+        cli_out_printf("\t%s\n", api_message_parent_id(msg, i));
+        hint_value_add(api_message_parent_id(msg, i));
       }
       if (msg->type == MSG_PAYLOAD_INDEXATION) {
         dump_index_payload((payload_index_t *)msg->payload);
       } else if (msg->type == MSG_PAYLOAD_TRANSACTION) {
         dump_tx_payload((payload_tx_t *)msg->payload);
       } else {
-        printf("TODO: payload type: %d\n", msg->type);
+        cli_out_printf("TODO: payload type: %d\n", msg->type);
       }
     }
   } else {
@@ -959,100 +3077,215 @@ static int fn_api_get_msg(int argc, char **argv) {
 }
 
 static void register_api_get_msg() {
-  api_get_msg_args.msg_id = arg_str1(NULL, NULL, "<Message ID>", "Message ID");
-  api_get_msg_args.end = arg_end(2);
   cli_cmd_t cmd = {
       .command = "api_get_msg",
       .help = "Get a message from a given message ID",
       .hint = " <Message ID>",
       .func = &fn_api_get_msg,
-      .argtable = &api_get_msg_args,
+      .args = api_get_msg_schema,
+      .needs = CLI_NEED_WALLET | CLI_NEED_NODE,
   };
   utarray_push_back(cli_ctx.cmd_array, &cmd);
 }
 
 /* 'balance' command */
+// derive the ed25519 address and the bech32 address of an index
+static int derive_address(iota_wallet_t *w, bool is_change, uint32_t index, byte_t addr[], char bech32[]) {
+  return cli_addr_cache_get(&cli_ctx.addr_cache, w, is_change, index, addr, bech32);
+}
+
+// start an address record, the caller adds fields and ends it
+static void out_address_begin(char const type[], uint32_t index, bool is_change, byte_t const addr[],
+                              char const bech32[]) {
+  char hex[ED25519_ADDRESS_BYTES * 2 + 1] = {};
+  cli_hex_encode(addr, ED25519_ADDRESS_BYTES, hex);
+  cli_out_record_begin(type);
+  cli_out_u64("index", index);
+  cli_out_bool("is_change", is_change);
+  cli_out_str("ed25519", hex);
+  cli_out_str("bech32", bech32);
+}
+
+// print an address, or output an address record
+static void print_address(uint32_t index, bool is_change, byte_t const addr[], char const bech32[]) {
+  hint_value_add(bech32);
+  if (cli_out_structured()) {
+    out_address_begin("address", index, is_change, addr, bech32);
+    cli_out_record_end();
+    return;
+  }
+  // print ed25519 address without version filed.
+  char hex[ED25519_ADDRESS_BYTES * 2 + 1] = {};
+  cli_hex_encode(addr, ED25519_ADDRESS_BYTES, hex);
+  printf("Addr[%" PRIu32 "]\n\t%s\n\t%s\n", index, hex, bech32);
+}
+
 static void dump_address(iota_wallet_t *w, uint32_t index, bool is_change) {
-  char tmp_bech32_addr[65];
+  char tmp_bech32_addr[CLI_BECH32_ADDR_BUF];
   byte_t tmp_addr[ED25519_ADDRESS_BYTES];
 
-  wallet_bech32_from_index(w, is_change, index, tmp_bech32_addr);
-  wallet_address_from_index(w, is_change, index, tmp_addr);
+  if (derive_address(w, is_change, index, tmp_addr, tmp_bech32_addr) != 0) {
+    printf("Err: derive address failed on index %" PRIu32 "\n", index);
+    return;
+  }
+  print_address(index, is_change, tmp_addr, tmp_bech32_addr);
+}
+
+typedef struct {
+  byte_t addr[ED25519_ADDRESS_BYTES];
+  char bech32[CLI_BECH32_ADDR_BUF];
+  uint64_t balance;
+  int err; /*!< 0 on success, -1 on derivation error, -2 on API error */
+} balance_result_t;
 
-  printf("Addr[%" PRIu32 "]\n", index);
-  // print ed25519 address without version filed.
-  printf("\t");
-  dump_hex_str(tmp_addr, ED25519_ADDRESS_BYTES);
-  // print out
-  printf("\t%s\n", tmp_bech32_addr);
+typedef struct {
+  uint32_t start;
+  bool is_change;
+  balance_result_t *results;
+  uint64_t total;
+  uint32_t failed;
+} balance_scan_t;
+
+static void balance_scan_task(void *ctx, size_t idx) {
+  balance_scan_t *scan = (balance_scan_t *)ctx;
+  balance_result_t *r = &scan->results[idx];
+
+  if (derive_address(cli_ctx.wallet, scan->is_change, scan->start + (uint32_t)idx, r->addr, r->bech32) != 0) {
+    r->err = -1;
+    return;
+  }
+
+  res_balance_t *res = res_balance_new();
+  if (res == NULL) {
+    r->err = -2;
+    return;
+  }
+  if (api_balance(r->bech32, res) != 0 || res->is_error) {
+    r->err = -2;
+  } else {
+    r->balance = res->u.output_balance->balance;
+  }
+  res_balance_free(res);
+}
+
+static bool balance_scan_emit(void *ctx, size_t idx) {
+  balance_scan_t *scan = (balance_scan_t *)ctx;
+  balance_result_t *r = &scan->results[idx];
+  uint32_t index = scan->start + (uint32_t)idx;
+
+  if (r->err == -1) {
+    printf("Err: derive address failed on index %" PRIu32 "\n", index);
+    scan->failed++;
+    return true;
+  }
+
+  if (r->err) {
+    printf("Err: get balance failed on index %" PRIu32 "\n", index);
+    scan->failed++;
+  } else if (cli_out_structured()) {
+    hint_value_add(r->bech32);
+    out_address_begin("address_balance", index, scan->is_change, r->addr, r->bech32);
+    cli_out_u64("balance", r->balance);
+    cli_out_record_end();
+    scan->total += r->balance;
+  } else {
+    print_address(index, scan->is_change, r->addr, r->bech32);
+    printf("balance: %" PRIu64 "\n", r->balance);
+    scan->total += r->balance;
+  }
+  return true;
 }
 
-static struct {
-  struct arg_dbl *idx_start;
-  struct arg_dbl *idx_count;
-  struct arg_int *is_change;
-  struct arg_end *end;
-} get_balance_args;
+typedef struct {
+  uint32_t idx_start;
+  uint32_t idx_count;
+  bool is_change;
+} get_balance_args_t;
+
+static cli_arg_t const get_balance_schema[] = {
+    CLI_ARG_U32(get_balance_args_t, idx_start, "<start>", "start index", 0, UINT32_MAX),
+    CLI_ARG_U32(get_balance_args_t, idx_count, "<count>", "number of address", 0, UINT32_MAX),
+    CLI_ARG_BOOL(get_balance_args_t, is_change, "<is_change>", "0 or 1"),
+    CLI_ARGS_END,
+};
 
 static int fn_get_balance(int argc, char **argv) {
-  int nerrors = arg_parse(argc, argv, (void **)&get_balance_args);
-  uint64_t balance = 0;
+  get_balance_args_t args = {};
+  int nerrors = cli_args_parse(get_balance_schema, argc, argv, &args);
   if (nerrors != 0) {
-    arg_print_errors(stderr, get_balance_args.end, argv[0]);
     return -1;
   }
 
-  uint32_t start = get_balance_args.idx_start->dval[0];
-  uint32_t count = get_balance_args.idx_count->dval[0];
-  bool is_change = get_balance_args.is_change->ival[0];
+  balance_scan_t scan = {
+      .start = args.idx_start,
+      .is_change = args.is_change,
+  };
+  uint32_t count = args.idx_count;
+  if (count == 0) {
+    return 0;
+  }
 
-  for (uint32_t i = start; i < start + count; i++) {
-    if (wallet_balance_by_index(cli_ctx.wallet, is_change, i, &balance) != 0) {
-      printf("Err: get balance failed on index %u\n", i);
-      return -2;
-    }
-    dump_address(cli_ctx.wallet, i, is_change);
-    printf("balance: %" PRIu64 "\n", balance);
+  if ((scan.results = calloc(count, sizeof(balance_result_t))) == NULL) {
+    return CLI_ERR_OOM;
   }
-  return 0;
+
+  // addresses are derived and queried concurrently, results are printed in index order
+  cli_parallel_for(count, CLI_SCAN_WORKERS, balance_scan_task, balance_scan_emit, &scan);
+  printf("Total balance: %" PRIu64 " in %" PRIu32 " addresses, %" PRIu32 " failed\n", scan.total,
+         count - scan.failed, scan.failed);
+  if (cli_out_structured()) {
+    cli_out_record_begin("balance_total");
+    cli_out_u64("balance", scan.total);
+    cli_out_u64("addresses", count - scan.failed);
+    cli_out_u64("failed", scan.failed);
+    cli_out_record_end();
+  }
+
+  free(scan.results);
+  return scan.failed ? -2 : 0;
 }
 
 static void register_get_balance() {
-  get_balance_args.idx_start = arg_dbl1(NULL, NULL, "<start>", "start index");
-  get_balance_args.idx_count = arg_dbl1(NULL, NULL, "<count>", "number of address");
-  get_balance_args.is_change = arg_int1(NULL, NULL, "<is_change>", "0 or 1");
-  get_balance_args.end = arg_end(5);
   cli_cmd_t cmd = {
       .command = "balance",
       .help = "Get the balance from a range of address index",
       .hint = " <start> <count> <is_change>",
       .func = &fn_get_balance,
-      .argtable = &get_balance_args,
+      .args = get_balance_schema,
+      .needs = CLI_NEED_WALLET | CLI_NEED_NODE,
   };
   utarray_push_back(cli_ctx.cmd_array, &cmd);
 }
 
 /* 'address' command */
-static struct {
-  struct arg_dbl *start_idx;
-  struct arg_dbl *count;
-  struct arg_int *is_change;
-  struct arg_end *end;
-} get_addresses_args;
+typedef struct {
+  uint32_t start_idx;
+  uint32_t count;
+  bool is_change;
+} get_addresses_args_t;
+
+static cli_arg_t const get_addresses_schema[] = {
+    CLI_ARG_U32(get_addresses_args_t, start_idx, "<start>", "start index", 0, UINT32_MAX),
+    CLI_ARG_U32(get_addresses_args_t, count, "<count>", "number of addresses", 0, UINT32_MAX),
+    CLI_ARG_BOOL(get_addresses_args_t, is_change, "<is_change>", "0 or 1"),
+    CLI_ARGS_END,
+};
 
 static cli_err_t fn_get_addresses(int argc, char **argv) {
   byte_t addr_with_version[IOTA_ADDRESS_BYTES] = {};
   char tmp_bech32_addr[100] = {};
-  int nerrors = arg_parse(argc, argv, (void **)&get_addresses_args);
+  get_addresses_args_t args = {};
+  int nerrors = cli_args_parse(get_addresses_schema, argc, argv, &args);
   if (nerrors != 0) {
-    arg_print_errors(stderr, get_addresses_args.end, argv[0]);
     return -1;
   }
-  uint32_t start = (uint32_t)get_addresses_args.start_idx->dval[0];
-  uint32_t count = (uint32_t)get_addresses_args.count->dval[0];
-  bool is_change = get_addresses_args.is_change->ival[0];
+  uint32_t start = args.start_idx;
+  uint32_t count = args.count;
+  bool is_change = args.is_change;
 
-  printf("list addresses with change %d\n", is_change);
+  if (!cli_out_structured()) {
+    printf("list addresses with change %d\n", is_change);
+  }
   for (uint32_t i = start; i < start + count; i++) {
     dump_address(cli_ctx.wallet, i, is_change);
   }
@@ -1060,39 +3293,416 @@ static cli_err_t fn_get_addresses(int argc, char **argv) {
 }
 
 static void register_get_addresses() {
-  get_addresses_args.start_idx = arg_dbl1(NULL, NULL, "<start>", "start index");
-  get_addresses_args.count = arg_dbl1(NULL, NULL, "<count>", "number of addresses");
-  get_addresses_args.is_change = arg_int1(NULL, NULL, "<is_change>", "0 or 1");
-  get_addresses_args.end = arg_end(5);
   cli_cmd_t cmd = {
       .command = "address",
       .help = "Get addresses from an index",
       .hint = " <start> <count> <is_change>",
       .func = &fn_get_addresses,
-      .argtable = &get_addresses_args,
+      .args = get_addresses_schema,
+      .needs = CLI_NEED_WALLET,
+  };
+  utarray_push_back(cli_ctx.cmd_array, &cmd);
+}
+
+/* 'address_export' command */
+typedef struct {
+  byte_t addr[ED25519_ADDRESS_BYTES];
+  char bech32[CLI_BECH32_ADDR_BUF];
+  int err;
+} export_result_t;
+
+typedef struct {
+  FILE *fp;
+  bool is_change;
+  uint32_t start;   /*!< the first index of the current chunk */
+  uint32_t written; /*!< addresses written to the file */
+  uint32_t failed;
+  export_result_t *results;
+} export_t;
+
+static void export_task(void *ctx, size_t idx) {
+  export_t *e = (export_t *)ctx;
+  export_result_t *r = &e->results[idx];
+  // bulk addresses bypass the cache, they would evict the working set.
+  r->err = cli_addr_derive(cli_ctx.wallet, e->is_change, e->start + (uint32_t)idx, r->addr, r->bech32);
+}
+
+static bool export_emit(void *ctx, size_t idx) {
+  export_t *e = (export_t *)ctx;
+  export_result_t *r = &e->results[idx];
+  uint32_t index = e->start + (uint32_t)idx;
+  char hex[ED25519_ADDRESS_BYTES * 2 + 1] = {};
+
+  if (r->err) {
+    printf("Err: derive address failed on index %" PRIu32 "\n", index);
+    e->failed++;
+    return true;
+  }
+  cli_hex_encode(r->addr, ED25519_ADDRESS_BYTES, hex);
+  if (fprintf(e->fp, "%" PRIu32 " %s %s\n", index, hex, r->bech32) < 0) {
+    printf("Err: write file failed\n");
+    e->failed++;
+    return false;
+  }
+  e->written++;
+  return true;
+}
+
+typedef struct {
+  char const *file;
+  uint32_t start_idx;
+  uint32_t count;
+  bool is_change;
+  uint32_t threads;
+} address_export_args_t;
+
+static cli_arg_t const address_export_schema[] = {
+    CLI_ARG_STR(address_export_args_t, file, "<file>", "output file"),
+    CLI_ARG_U32(address_export_args_t, start_idx, "<start>", "start index", 0, UINT32_MAX),
+    CLI_ARG_U32(address_export_args_t, count, "<count>", "number of addresses", 1, UINT32_MAX),
+    CLI_ARG_BOOL(address_export_args_t, is_change, "<is_change>", "0 or 1"),
+    // 0 is never parsed, it's the number of CPUs
+    CLI_ARG_U32_OPT(address_export_args_t, threads, "<threads>", "number of threads, default is the number of CPUs", 1,
+                    INT32_MAX, 0),
+    CLI_ARGS_END,
+};
+
+static cli_err_t fn_address_export(int argc, char **argv) {
+  address_export_args_t args = {};
+  if (cli_args_parse(address_export_schema, argc, argv, &args) != 0) {
+    return CLI_ERR_INVALID_ARG;
+  }
+
+  uint32_t start = args.start_idx;
+  uint32_t count = args.count;
+  long threads = args.threads ? (long)args.threads : sysconf(_SC_NPROCESSORS_ONLN);
+  if (threads <= 0) {
+    threads = 1;
+  }
+  if (start > UINT32_MAX - count) {
+    printf("invalid index range\n");
+    return CLI_ERR_INVALID_ARG;
+  }
+
+  export_t e = {.is_change = args.is_change};
+  if ((e.fp = fopen(args.file, "w")) == NULL) {
+    printf("open %s failed\n", args.file);
+    return CLI_ERR_FAILED;
+  }
+
+  // results are buffered per chunk to bound the memory
+  uint32_t chunk = count < CLI_EXPORT_CHUNK ? count : CLI_EXPORT_CHUNK;
+  if ((e.results = calloc(chunk, sizeof(export_result_t))) == NULL) {
+    fclose(e.fp);
+    return CLI_ERR_OOM;
+  }
+
+  struct timespec ts_start, ts_end;
+  clock_gettime(CLOCK_MONOTONIC, &ts_start);
+  uint32_t done = 0;
+  while (done < count) {
+    uint32_t n = count - done < chunk ? count - done : chunk;
+    e.start = start + done;
+    if (cli_parallel_for(n, (size_t)threads, export_task, export_emit, &e) != n) {
+      break;
+    }
+    done += n;
+  }
+  clock_gettime(CLOCK_MONOTONIC, &ts_end);
+
+  free(e.results);
+  if (fclose(e.fp) != 0) {
+    printf("Err: close file failed\n");
+    e.failed++;
+  }
+
+  double elapsed = (ts_end.tv_sec - ts_start.tv_sec) + (ts_end.tv_nsec - ts_start.tv_nsec) / 1e9;
+  printf("exported %" PRIu32 " addresses to %s in %0.3fs, %0.1f addresses/s with %ld threads, %" PRIu32 " failed\n",
+         e.written, args.file, elapsed, elapsed > 0 ? done / elapsed : 0.0, threads, e.failed);
+  if (cli_out_structured()) {
+    cli_out_record_begin("address_export");
+    cli_out_str("file", args.file);
+    cli_out_u64("exported", e.written);
+    cli_out_u64("failed", e.failed);
+    cli_out_i64("threads", threads);
+    cli_out_double("elapsed", elapsed);
+    cli_out_record_end();
+  }
+  return e.failed ? CLI_ERR_FAILED : CLI_OK;
+}
+
+static void register_address_export() {
+  cli_cmd_t cmd = {
+      .command = "address_export",
+      .help = "Export addresses of an index range to a file",
+      .hint = " <file> <start> <count> <is_change> [threads]",
+      .func = &fn_address_export,
+      .args = address_export_schema,
+      .needs = CLI_NEED_WALLET,
+  };
+  utarray_push_back(cli_ctx.cmd_array, &cmd);
+}
+
+/* 'discover' command */
+typedef struct {
+  uint32_t index;
+  byte_t addr[ED25519_ADDRESS_BYTES];
+  char bech32[CLI_BECH32_ADDR_BUF];
+  size_t outputs;
+  uint32_t retries; /*!< failed attempts before the result */
+  int err;
+} discover_result_t;
+
+typedef struct {
+  bool is_change;
+  uint32_t gap;    /*!< number of consecutive unused addresses to stop */
+  uint32_t unused; /*!< consecutive unused addresses so far */
+  uint32_t used;   /*!< number of used addresses */
+  uint32_t next;   /*!< the next index to check */
+  uint32_t fetch;  /*!< the next index to look up */
+  bool end;        /*!< all indexes are fetched */
+  uint32_t failed; /*!< number of failed lookups, retries included */
+  bool aborted;    /*!< a lookup failed after retries, the result is incomplete */
+  discover_result_t *results;
+} discover_t;
+
+static bool discover_fetch(void *ctx, size_t slot) {
+  discover_t *d = (discover_t *)ctx;
+  if (d->end) {
+    return false;
+  }
+  d->results[slot].index = d->fetch;
+  if (d->fetch == UINT32_MAX) {
+    d->end = true;
+  } else {
+    d->fetch++;
+  }
+  return true;
+}
+
+static int discover_lookup(discover_t const *d, discover_result_t *r) {
+  if (derive_address(cli_ctx.wallet, d->is_change, r->index, r->addr, r->bech32) != 0) {
+    return -1;
+  }
+
+  res_outputs_address_t *res = res_outputs_address_new();
+  if (res == NULL) {
+    return -2;
+  }
+  int err = 0;
+  // spent outputs are counted, an address is used once it received any output.
+  if (api_address_outputs(r->bech32, true, res) != 0 || res->is_error) {
+    err = -2;
+  } else {
+    r->outputs = res_outputs_address_output_id_count(res);
+  }
+  res_outputs_address_free(res);
+  return err;
+}
+
+static void discover_task(void *ctx, size_t slot) {
+  discover_t *d = (discover_t *)ctx;
+  discover_result_t *r = &d->results[slot];
+  uint32_t index = r->index;
+  memset(r, 0, sizeof(discover_result_t));
+  r->index = index;
+
+  // an error is not an unused address, a transient one would end the scan early. Retries back off on the worker,
+  // other lookups go on meanwhile.
+  while ((r->err = discover_lookup(d, r)) != 0 && r->retries < CLI_DISCOVER_RETRIES) {
+    uint64_t ms = (uint64_t)CLI_DISCOVER_BACKOFF_MS << r->retries;
+    struct timespec ts = {.tv_sec = (time_t)(ms / 1000), .tv_nsec = (long)(ms % 1000) * 1000000L};
+    nanosleep(&ts, NULL);
+    r->retries++;
+  }
+}
+
+static bool discover_emit(void *ctx, size_t slot) {
+  discover_t *d = (discover_t *)ctx;
+  discover_result_t *r = &d->results[slot];
+
+  d->failed += r->retries;
+  if (r->err) {
+    printf("Err: lookup failed on index %" PRIu32 " after %" PRIu32 " retries, the scan is aborted\n", r->index,
+           r->retries);
+    d->failed++;
+    d->aborted = true;
+    return false;
+  }
+  if (r->retries) {
+    printf("lookup on index %" PRIu32 " is done after %" PRIu32 " retries\n", r->index, r->retries);
+  }
+
+  d->next = r->index + 1;
+  if (r->outputs > 0) {
+    if (cli_out_structured()) {
+      hint_value_add(r->bech32);
+      out_address_begin("address_used", r->index, d->is_change, r->addr, r->bech32);
+      cli_out_u64("outputs", r->outputs);
+      cli_out_record_end();
+    } else {
+      print_address(r->index, d->is_change, r->addr, r->bech32);
+      printf("outputs: %zu\n", r->outputs);
+    }
+    d->used++;
+    d->unused = 0;
+  } else {
+    d->unused++;
+  }
+  // stop lookups beyond the gap
+  return d->unused < d->gap;
+}
+
+typedef struct {
+  uint32_t gap;
+} discover_args_t;
+
+static cli_arg_t const discover_schema[] = {
+    CLI_ARG_U32_OPT(discover_args_t, gap, "<gap>", "number of consecutive unused addresses to stop", 1, INT32_MAX,
+                    CLI_DISCOVER_GAP),
+    CLI_ARGS_END,
+};
+
+static cli_err_t fn_discover(int argc, char **argv) {
+  discover_args_t args = {};
+  if (cli_args_parse(discover_schema, argc, argv, &args) != 0) {
+    return CLI_ERR_INVALID_ARG;
+  }
+
+  uint32_t gap = args.gap;
+
+  // lookups run ahead of the frontier up to the window, it's bounded whatever the gap is
+  uint32_t window = gap > CLI_SCAN_WORKERS * 2 ? gap : CLI_SCAN_WORKERS * 2;
+  window = window < CLI_DISCOVER_WINDOW_MAX ? window : CLI_DISCOVER_WINDOW_MAX;
+  discover_result_t *results = calloc(window, sizeof(discover_result_t));
+  if (results == NULL) {
+    return CLI_ERR_OOM;
+  }
+
+  bool aborted = false;
+  for (int change = 0; change < 2; change++) {
+    discover_t d = {.is_change = change, .gap = gap, .results = results};
+    printf("scanning %s addresses, gap limit %" PRIu32 "\n", change ? "change" : "non-change", gap);
+    // a free worker looks up the next index at once, no barrier at the window edges
+    cli_parallel_stream(CLI_SCAN_WORKERS, window, discover_fetch, discover_task, discover_emit, &d);
+    if (d.aborted) {
+      printf("%s: %" PRIu32 " used addresses before index %" PRIu32 ", the scan is incomplete\n",
+             change ? "change" : "non-change", d.used, d.next);
+    } else {
+      printf("%s: %" PRIu32 " used addresses, next unused index %" PRIu32 "\n", change ? "change" : "non-change",
+             d.used, d.next - d.unused);
+    }
+    if (cli_out_structured()) {
+      cli_out_record_begin("discover");
+      cli_out_bool("is_change", change);
+      cli_out_u64("used", d.used);
+      cli_out_u64("next_unused", d.next - d.unused);
+      cli_out_u64("gap", gap);
+      cli_out_u64("failed", d.failed);
+      cli_out_bool("complete", !d.aborted);
+      cli_out_record_end();
+    }
+    aborted |= d.aborted;
+  }
+
+  free(results);
+  return aborted ? CLI_ERR_FAILED : CLI_OK;
+}
+
+static void register_discover() {
+  cli_cmd_t cmd = {
+      .command = "discover",
+      .help = "Discover used addresses until the gap limit",
+      .hint = " [gap]",
+      .func = &fn_discover,
+      .args = discover_schema,
+      .needs = CLI_NEED_WALLET | CLI_NEED_NODE,
+  };
+  utarray_push_back(cli_ctx.cmd_array, &cmd);
+}
+
+/* 'addr_cache' command */
+typedef struct {
+  char const *action;
+} addr_cache_args_t;
+
+static cli_arg_t const addr_cache_schema[] = {
+    CLI_ARG_STR_OPT(addr_cache_args_t, action, "clear", "Remove cached addresses"),
+    CLI_ARGS_END,
+};
+
+static cli_err_t fn_addr_cache(int argc, char **argv) {
+  addr_cache_args_t args = {};
+  if (cli_args_parse(addr_cache_schema, argc, argv, &args) != 0) {
+    return CLI_ERR_INVALID_ARG;
+  }
+
+  if (args.action != NULL) {
+    if (strcmp(args.action, "clear") != 0) {
+      printf("unknown action: %s\n", args.action);
+      return CLI_ERR_INVALID_ARG;
+    }
+    cli_addr_cache_clear(&cli_ctx.addr_cache);
+  }
+
+  cli_addr_cache_stats_t stats = {};
+  cli_addr_cache_stats(&cli_ctx.addr_cache, &stats);
+  if (cli_out_structured()) {
+    cli_out_record_begin("addr_cache");
+    cli_out_u64("entries", stats.entries);
+    cli_out_u64("max", cli_ctx.addr_cache.max);
+    cli_out_u64("hits", stats.hits);
+    cli_out_u64("misses", stats.misses);
+    cli_out_u64("evictions", stats.evictions);
+    cli_out_u64("flushes", stats.flushes);
+    cli_out_record_end();
+    return CLI_OK;
+  }
+  uint64_t lookups = stats.hits + stats.misses;
+  printf("Entries: %" PRIu32 "/%" PRIu32 "\n", stats.entries, cli_ctx.addr_cache.max);
+  printf("Hits: %" PRIu64 ", misses: %" PRIu64 ", hit rate: %0.2f%%\n", stats.hits, stats.misses,
+         lookups ? (double)stats.hits * 100 / lookups : 0.0);
+  printf("Evictions: %" PRIu64 ", flushes: %" PRIu64 "\n", stats.evictions, stats.flushes);
+  return CLI_OK;
+}
+
+static void register_addr_cache() {
+  cli_cmd_t cmd = {
+      .command = "addr_cache",
+      .help = "Show statistics of the derived address cache",
+      .hint = " [clear]",
+      .func = &fn_addr_cache,
+      .args = addr_cache_schema,
   };
   utarray_push_back(cli_ctx.cmd_array, &cmd);
 }
 
 /* 'send' command */
-static struct {
-  struct arg_dbl *sender;
-  struct arg_str *receiver;
-  struct arg_dbl *balance;
-  struct arg_end *end;
-} send_msg_args;
+typedef struct {
+  uint32_t sender;
+  char const *receiver;
+  uint64_t balance;
+} send_msg_args_t;
+
+static cli_arg_t const send_msg_schema[] = {
+    CLI_ARG_U32(send_msg_args_t, sender, "<index>", "Address index", 0, UINT32_MAX),
+    // a bech32 or an ed25519 hex address
+    CLI_ARG_STR(send_msg_args_t, receiver, "<receiver>", "Receiver address"),
+    CLI_ARG_U64(send_msg_args_t, balance, "<balance>", "balance", 0, UINT64_MAX / 1000000),
+    CLI_ARGS_END,
+};
 
 static int fn_send_msg(int argc, char **argv) {
   char msg_id[IOTA_MESSAGE_ID_HEX_BYTES + 1] = {};
   char data[] = "sent from iota_cmder";
-  int nerrors = arg_parse(argc, argv, (void **)&send_msg_args);
+  send_msg_args_t args = {};
+  int nerrors = cli_args_parse(send_msg_schema, argc, argv, &args);
   byte_t recv[IOTA_ADDRESS_BYTES] = {};
   if (nerrors != 0) {
-    arg_print_errors(stderr, send_msg_args.end, argv[0]);
     return -1;
   }
 
-  char const *const recv_addr = send_msg_args.receiver->sval[0];
+  char const *const recv_addr = args.receiver;
   // validating receiver address
   if (strncmp(recv_addr, cli_ctx.wallet->bech32HRP, strlen(cli_ctx.wallet->bech32HRP)) == 0) {
     // convert bech32 address to binary
@@ -1113,101 +3723,111 @@ static int fn_send_msg(int argc, char **argv) {
   }
 
   // balance = number * Mi
-  uint64_t balance = (uint64_t)send_msg_args.balance->dval[0] * 1000000;
+  uint64_t balance = args.balance * 1000000;
 
   if (balance > 0) {
-    printf("send %" PRIu64 "Mi to %s\n", (uint64_t)send_msg_args.balance->dval[0], recv_addr);
+    printf("send %" PRIu64 "Mi to %s\n", args.balance, recv_addr);
   } else {
     printf("send indexation payload to tangle\n");
   }
 
-  nerrors = wallet_send(cli_ctx.wallet, false, (uint32_t)send_msg_args.sender->dval[0], recv + 1, balance,
+  nerrors = wallet_send(cli_ctx.wallet, false, args.sender, recv + 1, balance,
                         "iota_comder", (byte_t *)data, sizeof(data), msg_id, sizeof(msg_id));
   if (nerrors) {
     printf("send message failed\n");
     return -5;
   }
-  printf("Message Hash: %s\n", msg_id);
+  if (cli_out_structured()) {
+    cli_out_record_begin("msg_sent");
+    cli_out_str("msg_id", msg_id);
+    cli_out_str("receiver", recv_addr);
+    cli_out_u64("amount", balance);
+    cli_out_record_end();
+  } else {
+    printf("Message Hash: %s\n", msg_id);
+  }
+  hint_value_add(msg_id);
   return nerrors;
 }
 
 static void register_send_tokens() {
-  send_msg_args.sender = arg_dbl1(NULL, NULL, "<index>", "Address index");
-  send_msg_args.receiver = arg_str1(NULL, NULL, "<receiver>", "Receiver address");
-  send_msg_args.balance = arg_dbl1(NULL, NULL, "<balance>", "balance");
-  send_msg_args.end = arg_end(20);
   cli_cmd_t cmd = {
       .command = "send",
       .help = "send message to tangle",
       .hint = " <addr_index> <receiver> <balance>",
       .func = &fn_send_msg,
-      .argtable = &send_msg_args,
+      .args = send_msg_schema,
+      .needs = CLI_NEED_WALLET | CLI_NEED_NODE,
   };
   utarray_push_back(cli_ctx.cmd_array, &cmd);
 }
 
 /* 'mnemonic_gen' command */
-static struct {
-  struct arg_int *language_id;
-  struct arg_end *end;
-} mnemonic_gen_args;
+typedef struct {
+  uint32_t language_id;
+} mnemonic_gen_args_t;
+
+static cli_arg_t const mnemonic_gen_schema[] = {
+    CLI_ARG_U32(mnemonic_gen_args_t, language_id, "<language id>", "0 to 8", MS_LAN_EN, MS_LAN_PT),
+    CLI_ARGS_END,
+};
 
 static cli_err_t fn_mnemonic_gen(int argc, char **argv) {
   char buf[512] = {};
 
-  int nerrors = arg_parse(argc, argv, (void **)&mnemonic_gen_args);
-  if (nerrors != 0) {
-    arg_print_errors(stderr, mnemonic_gen_args.end, argv[0]);
+  mnemonic_gen_args_t args = {};
+  if (cli_args_parse(mnemonic_gen_schema, argc, argv, &args) != 0) {
     return CLI_ERR_CMD_PARSING;
   }
 
-  int lan_id = mnemonic_gen_args.language_id->ival[0];
-  // validate id
-  if (lan_id < MS_LAN_EN || lan_id > MS_LAN_PT) {
-    printf("invalid language id, id value is %d to %d\n", MS_LAN_EN, MS_LAN_PT);
-    return CLI_ERR_INVALID_ARG;
+  mnemonic_generator(MS_ENTROPY_256, args.language_id, buf, sizeof(buf));
+  if (cli_out_structured()) {
+    cli_out_record_begin("mnemonic");
+    cli_out_str("mnemonic", buf);
+    cli_out_record_end();
+  } else {
+    printf("%s\n", buf);
   }
-
-  mnemonic_generator(MS_ENTROPY_256, lan_id, buf, sizeof(buf));
-  printf("%s\n", buf);
   return CLI_OK;
 }
 
 static void register_mnemonic_gen() {
-  mnemonic_gen_args.language_id = arg_int1(NULL, NULL, "<language id>", "0 to 8");
-  mnemonic_gen_args.end = arg_end(2);
   cli_cmd_t cmd = {
       .command = "mnemonic_gen",
       .help = "generate a random mnemonic sentence",
       .hint = " <language id>",
       .func = &fn_mnemonic_gen,
-      .argtable = &mnemonic_gen_args,
+      .args = mnemonic_gen_schema,
   };
   utarray_push_back(cli_ctx.cmd_array, &cmd);
 }
 
 /* 'mnemonic_update' command */
 
-static struct {
-  struct arg_str *ms;
-  struct arg_end *end;
-} ms_update_args;
+typedef struct {
+  char const *ms;
+} ms_update_args_t;
+
+static cli_arg_t const ms_update_schema[] = {
+    CLI_ARG_STR(ms_update_args_t, ms, "<mnemonic>", "Mnemonic sentence"),
+    CLI_ARGS_END,
+};
 
 static cli_err_t fn_mnemonic_update(int argc, char **argv) {
   byte_t new_seed[64] = {};
 
-  int nerrors = arg_parse(argc, argv, (void **)&ms_update_args);
-  if (nerrors != 0) {
-    arg_print_errors(stderr, ms_update_args.end, argv[0]);
+  ms_update_args_t args = {};
+  if (cli_args_parse(ms_update_schema, argc, argv, &args) != 0) {
     return -1;
   }
 
-  char const *const ms = ms_update_args.ms->sval[0];
+  char const *const ms = args.ms;
 
   if (mnemonic_to_seed(ms, "", new_seed, sizeof(new_seed)) == 0) {
     // dump_hex_str(new_seed, sizeof(new_seed));
     // replace seed
     memcpy(cli_ctx.wallet->seed, new_seed, IOTA_SEED_BYTES);
+    cli_addr_cache_clear(&cli_ctx.addr_cache);
     printf("mnemonic is changed to\n%s\n", ms);
     return CLI_OK;
   }
@@ -1218,26 +3838,48 @@ static cli_err_t fn_mnemonic_update(int argc, char **argv) {
 }
 
 static void register_mnemonic_update() {
-  ms_update_args.ms = arg_str1(NULL, NULL, "<mnemonic>", "Mnemonic sentence");
-  ms_update_args.end = arg_end(2);
   cli_cmd_t cmd = {
       .command = "mnemonic_update",
       .help = "Replace current mnemonic",
       .hint = " <mnemonic>",
       .func = &fn_mnemonic_update,
-      .argtable = &ms_update_args,
+      .args = ms_update_schema,
+      .needs = CLI_NEED_WALLET,
   };
   utarray_push_back(cli_ctx.cmd_array, &cmd);
 }
 
 //==========END OF COMMANDS==========
 
-cli_err_t cli_command_init() {
-  // init command line paring buffer
-  cli_ctx.parsing_buf = calloc(CLI_LINE_BUFFER, 1);
-  if (cli_ctx.parsing_buf == NULL) {
-    return CLI_ERR_OOM;
+cli_err_t cli_command_set_node(char const host[], uint16_t port, bool use_tls) {
+  iota_client_conf_t *endpoint = &cli_ctx.startup.endpoint;
+  if (host == NULL || host[0] == '\0' || strlen(host) >= sizeof(endpoint->host)) {
+    return CLI_ERR_INVALID_ARG;
   }
+  strcpy(endpoint->host, host);
+  endpoint->port = port;
+  endpoint->use_tls = use_tls;
+  return CLI_OK;
+}
+
+cli_err_t cli_command_set_data_dir(char const dir[]) {
+  if (dir == NULL || strlen(dir) >= sizeof(cli_ctx.data_dir)) {
+    return CLI_ERR_INVALID_ARG;
+  }
+  strcpy(cli_ctx.data_dir, dir);
+  cli_ctx.data_dir_set = true;
+  return CLI_OK;
+}
+
+void cli_command_reserve_stdin() { cli_ctx.stdin_reserved = true; }
+
+cli_err_t cli_command_init() {
+  cli_ctx.startup.start_ns = cli_stats_now_ns();
+  pthread_mutex_init(&cli_ctx.startup.lock, NULL);
+  pthread_cond_init(&cli_ctx.startup.cond, NULL);
+
+  // the command line and argv are sized to the input, the memory is reused by later commands
+  cli_arena_init(&cli_ctx.arena, CLI_ARENA_INIT, CLI_ARENA_MAX);
 
   // create cmd list
   utarray_new(cli_ctx.cmd_array, &cli_cmd_icd);
@@ -1259,57 +3901,160 @@ cli_err_t cli_command_init() {
   register_api_get_balance();
   register_api_msg_children();
   register_api_msg_meta();
+  register_walk();
   register_api_address_outputs();
   register_api_get_output();
   register_api_tips();
+  register_tip_pool();
   register_api_send_msg();
+  register_api_send_bulk();
+  register_pow_bench();
+  register_codec_bench();
   register_api_get_msg();
+  register_cache();
+  register_stats();
+  register_msg_store();
 
   // wallet APIs
   register_seed();
   register_seed_set();
   register_get_addresses();
+  register_address_export();
   register_get_balance();
+  register_discover();
+  register_addr_cache();
   register_send_tokens();
   register_mnemonic_gen();
   register_mnemonic_update();
 
+  // the command array is not changed after here, index it for the lookup and completion
+  if (cmd_index_build() != CLI_OK || cmd_trie_build() != CLI_OK) {
+    return CLI_ERR_OOM;
+  }
+
+  if ((cli_ctx.value_trie = cli_trie_new(CLI_HINT_VALUE_NODES)) == NULL) {
+    return CLI_ERR_OOM;
+  }
+
+  if (cli_http_pool_init(&cli_ctx.http, CLI_HTTP_POOL_SIZE) != 0) {
+    return CLI_ERR_FAILED;
+  }
+  cli_http_pool_set_timeouts(&cli_ctx.http, CLI_HTTP_CONNECT_TIMEOUT_MS, CLI_HTTP_TIMEOUT_MS);
+  cli_addr_cache_init(&cli_ctx.addr_cache, CLI_ADDR_CACHE_MAX);
+  cli_resp_cache_init(&cli_ctx.resp_cache, CLI_RESP_CACHE_BYTES);
+  cli_stats_init(&cli_ctx.stats);
+  // the message store is opened once the network of the node is known
+  if (!cli_ctx.data_dir_set) {
+    data_dir_default(cli_ctx.data_dir, sizeof(cli_ctx.data_dir));
+  }
+
   return cli_wallet_init();
 }
 
+cli_err_t cli_command_register(cli_cmd_t const *cmd) {
+  if (cli_ctx.cmd_array == NULL || cli_ctx.cmd_trie == NULL) {
+    return CLI_ERR_NULL_POINTER;
+  }
+  if (cmd == NULL || cmd->command == NULL || cmd->command[0] == '\0' || strchr(cmd->command, ' ') || cmd->func == NULL) {
+    return CLI_ERR_INVALID_CMD;
+  }
+  if (cli_command_find(cmd->command, strlen(cmd->command)) != NULL) {
+    printf("duplicated command: %s\n", cmd->command);
+    return CLI_ERR_INVALID_CMD;
+  }
+
+  utarray_push_back(cli_ctx.cmd_array, cmd);
+  cli_cmd_t *added = (cli_cmd_t *)utarray_back(cli_ctx.cmd_array);
+  cli_err_t ret = cmd_index_add(added);
+  if (ret != CLI_OK) {
+    utarray_pop_back(cli_ctx.cmd_array);
+    return ret;
+  }
+  if (cli_trie_insert(cli_ctx.cmd_trie, added->command) != 0) {
+    printf("command completion is not available: %s\n", added->command);
+  }
+  return CLI_OK;
+}
+
 cli_err_t cli_command_end() {
-  wallet_destroy(cli_ctx.wallet);
-  free(cli_ctx.parsing_buf);
+  // a handshake on an unresponsive node doesn't hold the exit until its timeout
+  cli_http_pool_abort(&cli_ctx.http);
+  // the node handshake starts the tip pool
+  for (size_t i = 0; i < cli_ctx.startup.threads_len; i++) {
+    pthread_join(cli_ctx.startup.threads[i], NULL);
+  }
+  cli_ctx.startup.threads_len = 0;
+  // the refresher uses the connection pool
+  cli_tip_pool_stop(&cli_ctx.tip_pool);
+  if (cli_ctx.startup.wallet) {
+    wallet_destroy(cli_ctx.startup.wallet);
+  }
+  pthread_cond_destroy(&cli_ctx.startup.cond);
+  pthread_mutex_destroy(&cli_ctx.startup.lock);
+  cli_http_pool_cleanup(&cli_ctx.http);
+  cli_addr_cache_cleanup(&cli_ctx.addr_cache);
+  cli_resp_cache_cleanup(&cli_ctx.resp_cache);
+  cli_stats_cleanup(&cli_ctx.stats);
+  cli_msg_store_close(cli_ctx.msg_store);
+  cli_arena_cleanup(&cli_ctx.arena);
+  cmd_index_free();
+  cli_trie_free(cli_ctx.cmd_trie);
+  cli_trie_free(cli_ctx.value_trie);
   utarray_free(cli_ctx.cmd_array);
   return CLI_OK;
 }
 
 cli_err_t cli_command_run(char const *const cmdline, cli_err_t *cmd_ret) {
-  if (cli_ctx.parsing_buf == NULL) {
+  if (cmdline == NULL) {
     return CLI_ERR_NULL_POINTER;
   }
 
-  char **argv = (char **)calloc(CLI_MAX_ARGC, sizeof(char *));
-  if (argv == NULL) {
-    return CLI_ERR_OOM;
+  size_t len = strlen(cmdline);
+  size_t argv_size = cli_split_argc_max(cmdline, len) + 1;
+  char *line = cli_arena_alloc(&cli_ctx.arena, len + 1);
+  char **argv = cli_arena_alloc(&cli_ctx.arena, argv_size * sizeof(char *));
+  cli_err_t ret = CLI_OK;
+  if (line == NULL || argv == NULL) {
+    printf(cli_ctx.arena.max ? "command line is too long: %zu bytes\n" : "OOM, command line of %zu bytes\n", len);
+    ret = CLI_ERR_OOM;
+    goto done;
   }
-
-  strncpy(cli_ctx.parsing_buf, cmdline, CLI_LINE_BUFFER);
+  memcpy(line, cmdline, len + 1);
 
   // split command line
-  size_t argc = esp_console_split_argv(cli_ctx.parsing_buf, argv, CLI_MAX_ARGC);
+  size_t argc = cli_split_argv(line, len, argv, argv_size);
   if (argc == 0) {
-    free(argv);
-    return CLI_ERR_INVALID_ARG;
+    ret = CLI_ERR_INVALID_ARG;
+    goto done;
   }
 
   // run command
-  cli_cmd_t *cmd_p = NULL;
-  while ((cmd_p = (cli_cmd_t *)utarray_next(cli_ctx.cmd_array, cmd_p))) {
-    if (!strcmp(cmd_p->command, argv[0])) {
-      *cmd_ret = (*cmd_p->func)(argc, argv);
-    }
-  }
-  free(argv);
-  return CLI_OK;
+  cli_cmd_t const *cmd_p = cli_command_find(argv[0], strlen(argv[0]));
+  if (cmd_p == NULL) {
+    printf("command not found: %s\n", argv[0]);
+    ret = CLI_ERR_CMD_NOT_FOUND;
+    goto done;
+  }
+  uint64_t start[CLI_STATS_TIMERS] = {cli_stats_now_ns(), cli_stats_net_ns(&cli_ctx.stats), cli_stats_cpu_ns()};
+  cli_out_command_begin();
+  // waiting for the background startup is a part of the command latency
+  if ((*cmd_ret = startup_wait(cmd_p->needs)) == CLI_OK) {
+    *cmd_ret = (*cmd_p->func)((int)argc, argv);
+  }
+  if (*cmd_ret != CLI_OK && cli_out_structured()) {
+    // the reason is logged to stderr, the record tells consumers the command failed
+    cli_out_record_begin("error");
+    cli_out_str("command", cmd_p->command);
+    cli_out_i64("status", *cmd_ret);
+    cli_out_record_end();
+  }
+  cli_out_command_end();
+  uint64_t ns[CLI_STATS_TIMERS] = {cli_stats_now_ns() - start[CLI_STATS_WALL],
+                                   cli_stats_net_ns(&cli_ctx.stats) - start[CLI_STATS_NET],
+                                   cli_stats_cpu_ns() - start[CLI_STATS_CPU]};
+  cli_stats_command(&cli_ctx.stats, cmd_p->command, ns, *cmd_ret != 0);
+
+done:
+  cli_arena_reset(&cli_ctx.arena);
+  return ret;
 }
@@ -1,9 +1,11 @@
 #ifndef __CLI_CMD_H__
 #define __CLI_CMD_H__
 
+#include <stdbool.h>
 #include <stdint.h>
 #include <stdlib.h>
 
+#include "cli_args.h"
 #include "cli_config.h"
 #include "linenoise.h"
 
@@ -26,8 +28,6 @@ typedef struct {
   char *help;
   /**
    * Hint text, usually lists possible arguments.
-   * If set to NULL, and 'argtable' field is non-NULL, hint will be generated
-   * automatically
    */
   char *hint;
   /**
@@ -35,14 +35,22 @@ typedef struct {
    */
   cli_cmd_cb_t func;
   /**
-   * Array or structure of pointers to arg_xxx structures, may be NULL.
-   * Used to generate hint text if 'hint' is set to NULL.
-   * Array/structure which this field points to must end with an arg_end.
-   * Only used for the duration of esp_console_cmd_register call.
+   * Schema of the arguments, may be NULL. It must end with CLI_ARGS_END and stay valid while the command is
+   * registered. The command parses its argv with cli_args_parse, 'help' prints the glossary of it.
    */
-  void *argtable;
+  cli_arg_t const *args;
+  /**
+   * Resources the command uses, a mask of CLI_NEED_* flags.
+   * They are initialized in the background on startup, the command waits for them before running
+   * and it fails if one of them is not available.
+   */
+  uint32_t needs;
 } cli_cmd_t;
 
+// resources of commands, they are initialized in the background on startup
+#define CLI_NEED_WALLET 0x01 /*!< the wallet and its seed */
+#define CLI_NEED_NODE 0x02   /*!< the node handshake: HRP, network ID and min PoW score */
+
 #define HINT_COLOR_RED 31
 #define HINT_COLOR_GREEN 32
 #define HINT_COLOR_YELLOW 33
@@ -62,6 +70,8 @@ typedef struct {
 #define CLI_ERR_INVALID_ARG 0x0204
 
 #define CLI_NODE_INFO_FAILED 0x0301
+#define CLI_WALLET_FAILED 0x0302
+#define CLI_NODE_ERROR_RESPONSE 0x0303 /*!< the node responded with an error, e.g. an unknown message */
 
 #ifdef __cplusplus
 extern "C" {
@@ -96,10 +106,57 @@ size_t esp_console_split_argv(char *line, char **argv, size_t argv_size);
 void completion_callback(char const *buf, linenoiseCompletions *lc);
 char *hints_callback(char const *buf, int *color, int *bold);
 
+/**
+ * @brief Set the node to connect instead of CLIENT_CONFIG_NODE, it must be called before cli_command_init
+ *
+ * @param host the host name
+ * @param port the port number
+ * @param use_tls use HTTPS
+ * @return cli_err_t CLI_OK on success
+ */
+cli_err_t cli_command_set_node(char const host[], uint16_t port, bool use_tls);
+
+/**
+ * @brief Set the directory of the message stores instead of the default one, it must be called before cli_command_init
+ *
+ * Messages are stored per network in the directory, it's created if it doesn't exist.
+ *
+ * @param dir the directory, an empty one disables the stores
+ * @return cli_err_t CLI_OK on success
+ */
+cli_err_t cli_command_set_data_dir(char const dir[]);
+
+/**
+ * @brief Tell commands that stdin is not theirs, e.g. commands are read from it, "-" for stdin is rejected
+ *
+ */
+void cli_command_reserve_stdin();
+
 cli_err_t cli_command_init();
 cli_err_t cli_command_end();
 cli_err_t cli_command_run(char const *const cmdline, cli_err_t *cmd_ret);
 
+/**
+ * @brief Register a command after cli_command_init, it's added to the lookup and the completion
+ *
+ * Strings of the command are copied, the argument schema is used as is.
+ *
+ * @param cmd the command, the name must be unique
+ * @return cli_err_t CLI_OK on success
+ */
+cli_err_t cli_command_register(cli_cmd_t const *cmd);
+
+/**
+ * @brief Find a registered command by name
+ *
+ * The lookup is backed by a hash index which is built in cli_command_init.
+ *
+ * @param name the command name, not need to be null-terminated
+ * @param len the length of the name
+ * @return cli_cmd_t const* a pointer to the command or NULL if not found
+ */
+cli_cmd_t const *cli_command_find(char const *const name, size_t len);
+
 #ifdef __cplusplus
 }
 #endif
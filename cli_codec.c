@@ -0,0 +1,428 @@
+#include <string.h>
+
+#include "cli_codec.h"
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#define CODEC_X86 1
+#include <immintrin.h>
+#else
+#define CODEC_X86 0
+#endif
+
+// the version byte of ed25519 addresses
+#define CODEC_ADDR_VER_ED25519 0
+// 5-bit groups of a version byte and an ed25519 address, 33 bytes
+#define CODEC_ADDR_GROUPS ((8 * (1 + CLI_CODEC_ED25519_BYTES) + 4) / 5)
+#define CODEC_CHECKSUM_LEN 6
+// addresses per step of the AVX2 checksum
+#define CODEC_LANES 8
+
+static char const hex_digits[] = "0123456789abcdef";
+static char const bech32_charset[] = "qpzry9x8gf2tvdw0s3jn54khce6mua7l";
+
+// hex digit values with 0x10 set, 0 for invalid digits
+static uint8_t const hex_values[256] = {
+    ['0'] = 0x10, ['1'] = 0x11, ['2'] = 0x12, ['3'] = 0x13, ['4'] = 0x14, ['5'] = 0x15, ['6'] = 0x16, ['7'] = 0x17,
+    ['8'] = 0x18, ['9'] = 0x19, ['a'] = 0x1A, ['b'] = 0x1B, ['c'] = 0x1C, ['d'] = 0x1D, ['e'] = 0x1E, ['f'] = 0x1F,
+    ['A'] = 0x1A, ['B'] = 0x1B, ['C'] = 0x1C, ['D'] = 0x1D, ['E'] = 0x1E, ['F'] = 0x1F,
+};
+
+// XOR of the BCH generators selected by the 5 bits shifted out of a checksum step
+static uint32_t const bech32_gen[32] = {
+    0x00000000, 0x3b6a57b2, 0x26508e6d, 0x1d3ad9df, 0x1ea119fa, 0x25cb4e48, 0x38f19797, 0x039bc025,
+    0x3d4233dd, 0x0628646f, 0x1b12bdb0, 0x2078ea02, 0x23e32a27, 0x18897d95, 0x05b3a44a, 0x3ed9f3f8,
+    0x2a1462b3, 0x117e3501, 0x0c44ecde, 0x372ebb6c, 0x34b57b49, 0x0fdf2cfb, 0x12e5f524, 0x298fa296,
+    0x1756516e, 0x2c3c06dc, 0x3106df03, 0x0a6c88b1, 0x09f74894, 0x329d1f26, 0x2fa7c6f9, 0x14cd914b,
+};
+
+static int codec_detected = -1;
+static int codec_in_use = -1;
+
+static cli_codec_isa_t codec_detect() {
+  int isa = __atomic_load_n(&codec_detected, __ATOMIC_RELAXED);
+  if (isa < 0) {
+    isa = CLI_CODEC_SCALAR;
+#if CODEC_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+      isa = CLI_CODEC_AVX2;
+    } else if (__builtin_cpu_supports("ssse3")) {
+      isa = CLI_CODEC_SSSE3;
+    }
+#endif
+    __atomic_store_n(&codec_detected, isa, __ATOMIC_RELAXED);
+  }
+  return (cli_codec_isa_t)isa;
+}
+
+cli_codec_isa_t cli_codec_isa() {
+  int isa = __atomic_load_n(&codec_in_use, __ATOMIC_RELAXED);
+  if (isa < 0) {
+    isa = codec_detect();
+    __atomic_store_n(&codec_in_use, isa, __ATOMIC_RELAXED);
+  }
+  return (cli_codec_isa_t)isa;
+}
+
+cli_codec_isa_t cli_codec_set_isa(cli_codec_isa_t isa) {
+  cli_codec_isa_t max = codec_detect();
+  if (isa > max) {
+    isa = max;
+  }
+  __atomic_store_n(&codec_in_use, (int)isa, __ATOMIC_RELAXED);
+  return isa;
+}
+
+char const *cli_codec_isa_name(cli_codec_isa_t isa) {
+  switch (isa) {
+    case CLI_CODEC_SSSE3:
+      return "ssse3";
+    case CLI_CODEC_AVX2:
+      return "avx2";
+    default:
+      return "scalar";
+  }
+}
+
+static void hex_encode_scalar(uint8_t const bin[], size_t len, char hex[]) {
+  for (size_t i = 0; i < len; i++) {
+    hex[i * 2] = hex_digits[bin[i] >> 4];
+    hex[i * 2 + 1] = hex_digits[bin[i] & 0xF];
+  }
+}
+
+static int hex_decode_scalar(char const hex[], size_t bin_len, uint8_t bin[]) {
+  for (size_t i = 0; i < bin_len; i++) {
+    uint8_t hi = hex_values[(uint8_t)hex[i * 2]];
+    uint8_t lo = hex_values[(uint8_t)hex[i * 2 + 1]];
+    if (!hi || !lo) {
+      return -1;
+    }
+    bin[i] = (uint8_t)((hi & 0xF) << 4 | (lo & 0xF));
+  }
+  return 0;
+}
+
+#if CODEC_X86
+__attribute__((target("ssse3"))) static void hex_encode_ssse3(uint8_t const bin[], size_t len, char hex[]) {
+  __m128i const lut = _mm_loadu_si128((__m128i const *)hex_digits);
+  __m128i const mask = _mm_set1_epi8(0x0F);
+  size_t i = 0;
+  for (; i + 16 <= len; i += 16) {
+    __m128i v = _mm_loadu_si128((__m128i const *)(bin + i));
+    __m128i hi = _mm_shuffle_epi8(lut, _mm_and_si128(_mm_srli_epi16(v, 4), mask));
+    __m128i lo = _mm_shuffle_epi8(lut, _mm_and_si128(v, mask));
+    _mm_storeu_si128((__m128i *)(hex + i * 2), _mm_unpacklo_epi8(hi, lo));
+    _mm_storeu_si128((__m128i *)(hex + i * 2 + 16), _mm_unpackhi_epi8(hi, lo));
+  }
+  hex_encode_scalar(bin + i, len - i, hex + i * 2);
+}
+
+// values of 16 hex digits, valid lanes are set in ok
+__attribute__((target("ssse3"))) static inline __m128i hex_nibbles_ssse3(__m128i c, __m128i *ok) {
+  __m128i d = _mm_sub_epi8(c, _mm_set1_epi8('0'));
+  __m128i is_d = _mm_cmpeq_epi8(_mm_min_epu8(d, _mm_set1_epi8(9)), d);
+  __m128i a = _mm_sub_epi8(_mm_or_si128(c, _mm_set1_epi8(0x20)), _mm_set1_epi8('a'));
+  __m128i is_a = _mm_cmpeq_epi8(_mm_min_epu8(a, _mm_set1_epi8(5)), a);
+  *ok = _mm_or_si128(is_d, is_a);
+  return _mm_or_si128(_mm_and_si128(is_d, d), _mm_and_si128(is_a, _mm_add_epi8(a, _mm_set1_epi8(10))));
+}
+
+__attribute__((target("ssse3"))) static int hex_decode_ssse3(char const hex[], size_t bin_len, uint8_t bin[]) {
+  // high nibble * 16 + low nibble of each digit pair
+  __m128i const weights = _mm_set1_epi16(0x0110);
+  size_t i = 0;
+  for (; i + 16 <= bin_len; i += 16) {
+    __m128i ok0, ok1;
+    __m128i v0 = hex_nibbles_ssse3(_mm_loadu_si128((__m128i const *)(hex + i * 2)), &ok0);
+    __m128i v1 = hex_nibbles_ssse3(_mm_loadu_si128((__m128i const *)(hex + i * 2 + 16)), &ok1);
+    if (_mm_movemask_epi8(_mm_and_si128(ok0, ok1)) != 0xFFFF) {
+      return -1;
+    }
+    __m128i b = _mm_packus_epi16(_mm_maddubs_epi16(v0, weights), _mm_maddubs_epi16(v1, weights));
+    _mm_storeu_si128((__m128i *)(bin + i), b);
+  }
+  return hex_decode_scalar(hex + i * 2, bin_len - i, bin + i);
+}
+
+__attribute__((target("avx2"))) static void hex_encode_avx2(uint8_t const bin[], size_t len, char hex[]) {
+  __m256i const lut = _mm256_broadcastsi128_si256(_mm_loadu_si128((__m128i const *)hex_digits));
+  __m256i const mask = _mm256_set1_epi8(0x0F);
+  size_t i = 0;
+  for (; i + 32 <= len; i += 32) {
+    __m256i v = _mm256_loadu_si256((__m256i const *)(bin + i));
+    __m256i hi = _mm256_shuffle_epi8(lut, _mm256_and_si256(_mm256_srli_epi16(v, 4), mask));
+    __m256i lo = _mm256_shuffle_epi8(lut, _mm256_and_si256(v, mask));
+    // unpack works within 128-bit lanes, put the halves back in order
+    __m256i a = _mm256_unpacklo_epi8(hi, lo);
+    __m256i b = _mm256_unpackhi_epi8(hi, lo);
+    _mm256_storeu_si256((__m256i *)(hex + i * 2), _mm256_permute2x128_si256(a, b, 0x20));
+    _mm256_storeu_si256((__m256i *)(hex + i * 2 + 32), _mm256_permute2x128_si256(a, b, 0x31));
+  }
+  hex_encode_ssse3(bin + i, len - i, hex + i * 2);
+}
+
+__attribute__((target("avx2"))) static inline __m256i hex_nibbles_avx2(__m256i c, __m256i *ok) {
+  __m256i d = _mm256_sub_epi8(c, _mm256_set1_epi8('0'));
+  __m256i is_d = _mm256_cmpeq_epi8(_mm256_min_epu8(d, _mm256_set1_epi8(9)), d);
+  __m256i a = _mm256_sub_epi8(_mm256_or_si256(c, _mm256_set1_epi8(0x20)), _mm256_set1_epi8('a'));
+  __m256i is_a = _mm256_cmpeq_epi8(_mm256_min_epu8(a, _mm256_set1_epi8(5)), a);
+  *ok = _mm256_or_si256(is_d, is_a);
+  return _mm256_or_si256(_mm256_and_si256(is_d, d),
+                         _mm256_and_si256(is_a, _mm256_add_epi8(a, _mm256_set1_epi8(10))));
+}
+
+__attribute__((target("avx2"))) static int hex_decode_avx2(char const hex[], size_t bin_len, uint8_t bin[]) {
+  __m256i const weights = _mm256_set1_epi16(0x0110);
+  size_t i = 0;
+  for (; i + 32 <= bin_len; i += 32) {
+    __m256i ok0, ok1;
+    __m256i v0 = hex_nibbles_avx2(_mm256_loadu_si256((__m256i const *)(hex + i * 2)), &ok0);
+    __m256i v1 = hex_nibbles_avx2(_mm256_loadu_si256((__m256i const *)(hex + i * 2 + 32)), &ok1);
+    if (_mm256_movemask_epi8(_mm256_and_si256(ok0, ok1)) != -1) {
+      return -1;
+    }
+    __m256i b = _mm256_packus_epi16(_mm256_maddubs_epi16(v0, weights), _mm256_maddubs_epi16(v1, weights));
+    // pack works within 128-bit lanes
+    _mm256_storeu_si256((__m256i *)(bin + i), _mm256_permute4x64_epi64(b, 0xD8));
+  }
+  return hex_decode_ssse3(hex + i * 2, bin_len - i, bin + i);
+}
+#endif
+
+void cli_hex_encode(uint8_t const bin[], size_t len, char hex[]) {
+#if CODEC_X86
+  cli_codec_isa_t isa = cli_codec_isa();
+  if (isa == CLI_CODEC_AVX2) {
+    hex_encode_avx2(bin, len, hex);
+  } else if (isa == CLI_CODEC_SSSE3) {
+    hex_encode_ssse3(bin, len, hex);
+  } else {
+    hex_encode_scalar(bin, len, hex);
+  }
+#else
+  hex_encode_scalar(bin, len, hex);
+#endif
+  hex[len * 2] = '\0';
+}
+
+int cli_hex_decode(char const hex[], size_t hex_len, uint8_t bin[], size_t bin_len) {
+  if (hex_len % 2 != 0 || bin_len < hex_len / 2) {
+    return -1;
+  }
+#if CODEC_X86
+  cli_codec_isa_t isa = cli_codec_isa();
+  if (isa == CLI_CODEC_AVX2) {
+    return hex_decode_avx2(hex, hex_len / 2, bin);
+  } else if (isa == CLI_CODEC_SSSE3) {
+    return hex_decode_ssse3(hex, hex_len / 2, bin);
+  }
+#endif
+  return hex_decode_scalar(hex, hex_len / 2, bin);
+}
+
+static inline uint32_t bech32_step(uint32_t chk) { return (chk & 0x1FFFFFF) << 5 ^ bech32_gen[chk >> 25]; }
+
+// the checksum state after the expanded human readable part, it's shared by all addresses of a batch
+static int bech32_hrp_state(char const hrp[], size_t *hrp_len, uint32_t *chk) {
+  size_t len = strlen(hrp);
+  if (len == 0 || len > CLI_CODEC_HRP_MAX) {
+    return -1;
+  }
+  uint32_t c = 1;
+  for (size_t i = 0; i < len; i++) {
+    uint8_t ch = (uint8_t)hrp[i];
+    if (ch < 33 || ch > 126 || (ch >= 'A' && ch <= 'Z')) {
+      return -1;
+    }
+    c = bech32_step(c) ^ (ch >> 5);
+  }
+  c = bech32_step(c);
+  for (size_t i = 0; i < len; i++) {
+    c = bech32_step(c) ^ ((uint8_t)hrp[i] & 0x1F);
+  }
+  *hrp_len = len;
+  *chk = c;
+  return 0;
+}
+
+// split the version byte and the address into 5-bit groups, the last group is zero padded
+static void bech32_groups(uint8_t const addr[], uint8_t groups[]) {
+  uint32_t acc = CODEC_ADDR_VER_ED25519;
+  int bits = 8;
+  size_t n = 0;
+  for (size_t i = 0; i <= CLI_CODEC_ED25519_BYTES; i++) {
+    while (bits >= 5) {
+      bits -= 5;
+      groups[n++] = (acc >> bits) & 0x1F;
+    }
+    if (i < CLI_CODEC_ED25519_BYTES) {
+      acc = (acc << 8 | addr[i]) & 0xFFF;
+      bits += 8;
+    }
+  }
+  if (bits > 0) {
+    groups[n] = (acc << (5 - bits)) & 0x1F;
+  }
+}
+
+// write the address part and the checksum after the separator
+static void bech32_write(char out[], uint8_t const groups[], uint32_t chk) {
+  for (size_t i = 0; i < CODEC_ADDR_GROUPS; i++) {
+    out[i] = bech32_charset[groups[i]];
+  }
+  for (size_t i = 0; i < CODEC_CHECKSUM_LEN; i++) {
+    out[CODEC_ADDR_GROUPS + i] = bech32_charset[(chk >> (5 * (5 - i))) & 0x1F];
+  }
+  out[CODEC_ADDR_GROUPS + CODEC_CHECKSUM_LEN] = '\0';
+}
+
+static void bech32_encode_one(char const hrp[], size_t hrp_len, uint32_t hrp_chk, uint8_t const addr[],
+                              char bech32[]) {
+  uint8_t groups[CODEC_ADDR_GROUPS];
+  bech32_groups(addr, groups);
+  uint32_t chk = hrp_chk;
+  for (size_t i = 0; i < CODEC_ADDR_GROUPS; i++) {
+    chk = bech32_step(chk) ^ groups[i];
+  }
+  for (size_t i = 0; i < CODEC_CHECKSUM_LEN; i++) {
+    chk = bech32_step(chk);
+  }
+  memcpy(bech32, hrp, hrp_len);
+  bech32[hrp_len] = '1';
+  bech32_write(bech32 + hrp_len + 1, groups, chk ^ 1);
+}
+
+#if CODEC_X86
+// checksums of 8 addresses, groups are interleaved by lane
+__attribute__((target("avx2"))) static void bech32_checksum_avx2(uint32_t hrp_chk,
+                                                                 uint32_t const groups[][CODEC_LANES],
+                                                                 uint32_t chk[]) {
+  __m256i const gen0 = _mm256_loadu_si256((__m256i const *)(bech32_gen + 0));
+  __m256i const gen1 = _mm256_loadu_si256((__m256i const *)(bech32_gen + 8));
+  __m256i const gen2 = _mm256_loadu_si256((__m256i const *)(bech32_gen + 16));
+  __m256i const gen3 = _mm256_loadu_si256((__m256i const *)(bech32_gen + 24));
+  __m256i const low = _mm256_set1_epi32(0x1FFFFFF);
+  __m256i c = _mm256_set1_epi32((int)hrp_chk);
+
+  for (size_t i = 0; i < CODEC_ADDR_GROUPS + CODEC_CHECKSUM_LEN; i++) {
+    __m256i b = _mm256_srli_epi32(c, 25);
+    // look up the 32-entry table, the low 3 bits select within a register and bits 3, 4 select the register
+    __m256i g01 = _mm256_castps_si256(_mm256_blendv_ps(_mm256_castsi256_ps(_mm256_permutevar8x32_epi32(gen0, b)),
+                                                       _mm256_castsi256_ps(_mm256_permutevar8x32_epi32(gen1, b)),
+                                                       _mm256_castsi256_ps(_mm256_slli_epi32(b, 28))));
+    __m256i g23 = _mm256_castps_si256(_mm256_blendv_ps(_mm256_castsi256_ps(_mm256_permutevar8x32_epi32(gen2, b)),
+                                                       _mm256_castsi256_ps(_mm256_permutevar8x32_epi32(gen3, b)),
+                                                       _mm256_castsi256_ps(_mm256_slli_epi32(b, 28))));
+    __m256i g = _mm256_castps_si256(_mm256_blendv_ps(_mm256_castsi256_ps(g01), _mm256_castsi256_ps(g23),
+                                                     _mm256_castsi256_ps(_mm256_slli_epi32(b, 27))));
+    c = _mm256_xor_si256(_mm256_slli_epi32(_mm256_and_si256(c, low), 5), g);
+    if (i < CODEC_ADDR_GROUPS) {
+      c = _mm256_xor_si256(c, _mm256_loadu_si256((__m256i const *)groups[i]));
+    }
+  }
+  _mm256_storeu_si256((__m256i *)chk, _mm256_xor_si256(c, _mm256_set1_epi32(1)));
+}
+#endif
+
+int cli_bech32_encode(char const hrp[], uint8_t const addr[], char bech32[]) {
+  size_t hrp_len = 0;
+  uint32_t hrp_chk = 0;
+  if (bech32_hrp_state(hrp, &hrp_len, &hrp_chk) != 0) {
+    return -1;
+  }
+  bech32_encode_one(hrp, hrp_len, hrp_chk, addr, bech32);
+  return 0;
+}
+
+int cli_bech32_encode_batch(char const hrp[], uint8_t const *addrs, size_t addr_stride, size_t n, char *bech32,
+                            size_t bech32_stride) {
+  size_t hrp_len = 0;
+  uint32_t hrp_chk = 0;
+  if (bech32_hrp_state(hrp, &hrp_len, &hrp_chk) != 0) {
+    return -1;
+  }
+
+  size_t i = 0;
+#if CODEC_X86
+  if (cli_codec_isa() == CLI_CODEC_AVX2) {
+    uint8_t groups[CODEC_LANES][CODEC_ADDR_GROUPS];
+    uint32_t lanes[CODEC_ADDR_GROUPS][CODEC_LANES];
+    uint32_t chk[CODEC_LANES];
+    for (; i + CODEC_LANES <= n; i += CODEC_LANES) {
+      for (size_t l = 0; l < CODEC_LANES; l++) {
+        bech32_groups(addrs + (i + l) * addr_stride, groups[l]);
+        for (size_t g = 0; g < CODEC_ADDR_GROUPS; g++) {
+          lanes[g][l] = groups[l][g];
+        }
+      }
+      bech32_checksum_avx2(hrp_chk, lanes, chk);
+      for (size_t l = 0; l < CODEC_LANES; l++) {
+        char *out = bech32 + (i + l) * bech32_stride;
+        memcpy(out, hrp, hrp_len);
+        out[hrp_len] = '1';
+        bech32_write(out + hrp_len + 1, groups[l], chk[l]);
+      }
+    }
+  }
+#endif
+  for (; i < n; i++) {
+    bech32_encode_one(hrp, hrp_len, hrp_chk, addrs + i * addr_stride, bech32 + i * bech32_stride);
+  }
+  return 0;
+}
+
+int cli_bech32_decode(char const bech32[], char hrp[], uint8_t addr[]) {
+  char const *sep = strrchr(bech32, '1');
+  if (sep == NULL || strlen(sep + 1) != CODEC_ADDR_GROUPS + CODEC_CHECKSUM_LEN) {
+    return -1;
+  }
+  char hrp_buf[CLI_CODEC_HRP_MAX + 1] = {};
+  size_t hrp_len = (size_t)(sep - bech32);
+  if (hrp_len == 0 || hrp_len > CLI_CODEC_HRP_MAX) {
+    return -1;
+  }
+  memcpy(hrp_buf, bech32, hrp_len);
+  uint32_t chk = 0;
+  if (bech32_hrp_state(hrp_buf, &hrp_len, &chk) != 0) {
+    return -1;
+  }
+
+  // 5-bit groups of the version byte and the address, then the checksum
+  uint8_t groups[CODEC_ADDR_GROUPS + CODEC_CHECKSUM_LEN];
+  for (size_t i = 0; i < sizeof(groups); i++) {
+    char const *p = strchr(bech32_charset, sep[1 + i]);
+    if (p == NULL || sep[1 + i] == '\0') {
+      return -1;
+    }
+    groups[i] = (uint8_t)(p - bech32_charset);
+    chk = bech32_step(chk) ^ groups[i];
+  }
+  if (chk != 1) {
+    return -1;
+  }
+
+  uint8_t bin[1 + CLI_CODEC_ED25519_BYTES];
+  uint32_t acc = 0;
+  int bits = 0;
+  size_t n = 0;
+  for (size_t i = 0; i < CODEC_ADDR_GROUPS; i++) {
+    acc = (acc << 5 | groups[i]) & 0xFFF;
+    bits += 5;
+    if (bits >= 8) {
+      bits -= 8;
+      bin[n++] = (acc >> bits) & 0xFF;
+    }
+  }
+  // the padding bits are zero, only ed25519 addresses are supported
+  if ((acc & ((1u << bits) - 1)) != 0 || bin[0] != CODEC_ADDR_VER_ED25519) {
+    return -1;
+  }
+  if (hrp) {
+    memcpy(hrp, hrp_buf, hrp_len + 1);
+  }
+  if (addr) {
+    memcpy(addr, bin + 1, CLI_CODEC_ED25519_BYTES);
+  }
+  return 0;
+}
@@ -0,0 +1,111 @@
+#ifndef __CLI_CODEC_H__
+#define __CLI_CODEC_H__
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// bytes of an ed25519 address without the version byte
+#define CLI_CODEC_ED25519_BYTES 32
+// max length of a bech32 human readable part
+#define CLI_CODEC_HRP_MAX 16
+
+/**
+ * @brief Instruction sets of the codecs
+ *
+ */
+typedef enum {
+  CLI_CODEC_SCALAR = 0, /*!< portable C */
+  CLI_CODEC_SSSE3,      /*!< 16 bytes per step */
+  CLI_CODEC_AVX2,       /*!< 32 bytes per step, 8 bech32 addresses per step */
+} cli_codec_isa_t;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Get the instruction set in use, it's the best one the CPU supports unless it's limited by
+ * cli_codec_set_isa
+ *
+ * @return cli_codec_isa_t
+ */
+cli_codec_isa_t cli_codec_isa();
+
+/**
+ * @brief Limit the instruction set, for benchmarks and debugging
+ *
+ * @param isa the highest instruction set to use
+ * @return cli_codec_isa_t the instruction set in use
+ */
+cli_codec_isa_t cli_codec_set_isa(cli_codec_isa_t isa);
+
+/**
+ * @brief Get the name of an instruction set
+ *
+ * @param isa the instruction set
+ * @return char const* the name
+ */
+char const *cli_codec_isa_name(cli_codec_isa_t isa);
+
+/**
+ * @brief Encode bytes to a lower case hex string
+ *
+ * @param bin the bytes
+ * @param len the length of bytes
+ * @param hex the output buffer, at least len * 2 + 1 bytes, it's NUL terminated
+ */
+void cli_hex_encode(uint8_t const bin[], size_t len, char hex[]);
+
+/**
+ * @brief Decode a hex string, upper and lower case digits are accepted
+ *
+ * @param hex the hex string
+ * @param hex_len the length of the hex string, it must be even
+ * @param bin the output buffer
+ * @param bin_len the size of the output buffer, at least hex_len / 2
+ * @return int 0 on success, -1 on an invalid digit or length
+ */
+int cli_hex_decode(char const hex[], size_t hex_len, uint8_t bin[], size_t bin_len);
+
+/**
+ * @brief Encode an ed25519 address to bech32, the output is the same as address_2_bech32
+ *
+ * @param hrp the lower case human readable part
+ * @param addr the ed25519 address without the version byte
+ * @param bech32 the output buffer, at least strlen(hrp) + 61 bytes
+ * @return int 0 on success
+ */
+int cli_bech32_encode(char const hrp[], uint8_t const addr[], char bech32[]);
+
+/**
+ * @brief Encode ed25519 addresses to bech32 in a batch, checksums of 8 addresses are computed at once with AVX2
+ *
+ * @param hrp the lower case human readable part
+ * @param addrs the first ed25519 address
+ * @param addr_stride bytes between addresses
+ * @param n the number of addresses
+ * @param bech32 the first output buffer, each one is at least strlen(hrp) + 61 bytes
+ * @param bech32_stride bytes between output buffers
+ * @return int 0 on success
+ */
+int cli_bech32_encode_batch(char const hrp[], uint8_t const *addrs, size_t addr_stride, size_t n, char *bech32,
+                            size_t bech32_stride);
+
+/**
+ * @brief Decode a bech32 ed25519 address, the checksum, the version byte and the padding are verified
+ *
+ * Only lower case addresses are accepted, as they are encoded by cli_bech32_encode.
+ *
+ * @param bech32 the address
+ * @param hrp the output of the human readable part, CLI_CODEC_HRP_MAX + 1 bytes, may be NULL
+ * @param addr the output of the ed25519 address without the version byte, may be NULL
+ * @return int 0 on success, -1 on an invalid address
+ */
+int cli_bech32_decode(char const bech32[], char hrp[], uint8_t addr[]);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // __CLI_CODEC_H__
@@ -3,8 +3,91 @@
 
 #define IOTA_CLIENT_DEBUG
 
-#define CLI_LINE_BUFFER 4096
-#define CLI_MAX_ARGC 16
+// initial size of the command arena, it grows to the largest command line and its arguments
+#define CLI_ARENA_INIT 4096
+// cap of the command arena, 0 for unlimited; embedded builds set it, e.g. -DCLI_ARENA_MAX=8192, then the arena is
+// a single block of the cap
+#ifndef CLI_ARENA_MAX
+#define CLI_ARENA_MAX 0
+#endif
+
+// max number of completions on a <tab>
+#define CLI_COMPLETION_MAX 32
+// node limit of the trie for argument values seen in the session, ~12 bytes per node
+#define CLI_HINT_VALUE_NODES (64 * 1024)
+// min length of an argument before hinting a known value
+#define CLI_HINT_VALUE_MIN_PREFIX 4
+
+// max number of idle keep-alive connections to the node
+#define CLI_HTTP_POOL_SIZE 8
+// timeouts of node requests, an unresponsive node fails commands instead of blocking them; 0 to disable
+#ifndef CLI_HTTP_CONNECT_TIMEOUT_MS
+#define CLI_HTTP_CONNECT_TIMEOUT_MS 5000
+#endif
+#ifndef CLI_HTTP_TIMEOUT_MS
+#define CLI_HTTP_TIMEOUT_MS 30000
+#endif
+
+// memory cap of the response cache of immutable objects
+#define CLI_RESP_CACHE_BYTES (4 * 1024 * 1024)
+
+// append-only stores of messages, one per network, they're reused by later sessions. The directory is --data-dir,
+// $IOTA_CMDER_DATA_DIR, $XDG_DATA_HOME/iota_cmder or ~/.local/share/iota_cmder; an empty one disables the stores
+#define CLI_DATA_DIR_ENV "IOTA_CMDER_DATA_DIR"
+#define CLI_DATA_DIR_NAME "iota_cmder"
+#define CLI_PATH_MAX 512
+
+// max number of concurrent tasks of address scanning
+#define CLI_SCAN_WORKERS 8
+// max number of cached addresses, 0 for unlimited
+#define CLI_ADDR_CACHE_MAX 4096
+// number of addresses are buffered by address_export
+#define CLI_EXPORT_CHUNK (16 * 1024)
+// default gap limit of the address discovery
+#define CLI_DISCOVER_GAP 20
+// lookups of an address are retried before the discovery is aborted, the delay doubles from the backoff
+#define CLI_DISCOVER_RETRIES 2
+#define CLI_DISCOVER_BACKOFF_MS 200
+// max number of addresses looked up ahead by the discovery
+#define CLI_DISCOVER_WINDOW_MAX 256
+
+// max number of in-flight requests of the DAG walker
+#define CLI_WALK_INFLIGHT 16
+// default depth limit of the DAG walker
+#define CLI_WALK_DEPTH 16
+// default limit of messages visited by the DAG walker, the set of visited IDs starts at this size and grows
+#define CLI_WALK_MAX 10000
+// max limit of messages visited by the DAG walker, 32 bytes of the ID set per message at least
+#define CLI_WALK_LIMIT_MAX (10 * 1000 * 1000)
+
+// number of PoW threads, 0 for the number of CPUs
+#define CLI_POW_THREADS 0
+// pow_bench defaults, the PoW score is used if the node info is not available
+#define CLI_POW_BENCH_ROUNDS 5
+#define CLI_POW_BENCH_SCORE 4000
+#define CLI_POW_BENCH_MSG_LEN 256
+
+// number of addresses of codec_bench
+#define CLI_CODEC_BENCH_COUNT 100000
+
+// refresh interval and age bound of the tip pool
+#define CLI_TIP_REFRESH_MS 2000
+#define CLI_TIP_MAX_AGE_MS 10000
+
+// default number of in-flight messages of api_send_bulk
+#define CLI_BULK_INFLIGHT 8
+#define CLI_BULK_INFLIGHT_MAX 256
+// number of records sent on a set of tips
+#define CLI_BULK_CHUNK 64
+
+// max number of connected clients of the daemon mode
+#define CLI_DAEMON_CLIENTS 64
+#define CLI_DAEMON_BACKLOG 16
+// receive buffer of a client, it grows to the max length of a command line
+#define CLI_DAEMON_LINE_INIT 4096
+#define CLI_DAEMON_LINE_MAX (1024 * 1024)
+// a client is dropped if it doesn't read its output in time
+#define CLI_DAEMON_SEND_TIMEOUT_MS 5000
 
 // comment out if using HTTP
 #define CLIENT_CONFIG_HTTPS
@@ -13,14 +96,18 @@
 
 #define WALLET_CONFIG_MNEMONIC "RANDOM"  // RANDOM or a mnemonic sentence
 
+// CLIENT_CONFIG_HRP is used for addresses until the node handshake is done, or without a node
+
 #ifdef CLIENT_CONFIG_MAINNET
 #define CLIENT_CONFIG_NODE "chrysalis-nodes.iota.org"
 #define CLIENT_CONFIG_PORT 443
 #define NODE_USE_TLS 1
+#define CLIENT_CONFIG_HRP "iota"
 #else  // chrysalis devnet
 #define CLIENT_CONFIG_NODE "api.lb-0.h.chrysalis-devnet.iota.cafe"
 #define CLIENT_CONFIG_PORT 443
 #define NODE_USE_TLS 1
+#define CLIENT_CONFIG_HRP "atoi"
 #endif
 
 #ifdef __cplusplus
@@ -0,0 +1,408 @@
+// struct ucred of SO_PEERCRED
+#define _GNU_SOURCE
+
+#include <errno.h>
+#include <poll.h>
+#include <signal.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "cli_cmd.h"
+#include "cli_daemon.h"
+#include "cli_out.h"
+
+typedef struct {
+  int fd;     /*!< the connection, -1 if the slot is free */
+  char *buf;  /*!< received bytes */
+  size_t cap; /*!< size of buf, it grows to CLI_DAEMON_LINE_MAX for a long line */
+  size_t len; /*!< length of received bytes */
+  bool eof;   /*!< the client has sent all commands, it's closed once they are done */
+} daemon_client_t;
+
+typedef struct {
+  int listen_fd;
+  FILE *capture; /*!< output of the running command */
+  FILE *log;     /*!< text of the running command in structured modes, records are in capture */
+  daemon_client_t clients[CLI_DAEMON_CLIENTS];
+} daemon_t;
+
+static volatile sig_atomic_t daemon_stop;
+
+static void daemon_signal(int sig) {
+  (void)sig;
+  daemon_stop = 1;
+}
+
+static int listen_unix(char const path[]) {
+  struct sockaddr_un addr = {.sun_family = AF_UNIX};
+  if (strlen(path) >= sizeof(addr.sun_path)) {
+    printf("socket path is too long: %s\n", path);
+    return -1;
+  }
+  strcpy(addr.sun_path, path);
+
+  // replace a socket of a previous run, but never a regular file
+  struct stat st;
+  if (lstat(path, &st) == 0) {
+    if (!S_ISSOCK(st.st_mode)) {
+      printf("%s exists and it's not a socket\n", path);
+      return -1;
+    }
+    unlink(path);
+  }
+
+  int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+  if (fd < 0) {
+    printf("create socket failed: %s\n", strerror(errno));
+    return -1;
+  }
+  // the socket runs commands with the wallet of the daemon, only its owner can connect
+  mode_t mask = umask(077);
+  int err = bind(fd, (struct sockaddr *)&addr, sizeof(addr));
+  umask(mask);
+  if (err != 0 || chmod(path, 0600) != 0 || listen(fd, CLI_DAEMON_BACKLOG) != 0) {
+    printf("listen on %s failed: %s\n", path, strerror(errno));
+    close(fd);
+    return -1;
+  }
+  return fd;
+}
+
+static int send_all(int fd, char const *buf, size_t len) {
+  while (len > 0) {
+    ssize_t n = send(fd, buf, len, MSG_NOSIGNAL);
+    if (n < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      return -1;
+    }
+    buf += n;
+    len -= (size_t)n;
+  }
+  return 0;
+}
+
+static void client_close(daemon_client_t *c) {
+  close(c->fd);
+  c->fd = -1;
+  c->len = 0;
+  c->eof = false;
+  // a buffer grown by a long line is not kept for the next client
+  if (c->cap > CLI_DAEMON_LINE_INIT) {
+    free(c->buf);
+    c->buf = NULL;
+    c->cap = 0;
+  }
+}
+
+// double the buffer of a client which is full without a complete line
+static bool client_grow(daemon_client_t *c) {
+  if (c->cap >= CLI_DAEMON_LINE_MAX) {
+    return false;
+  }
+  size_t cap = c->cap * 2 < CLI_DAEMON_LINE_MAX ? c->cap * 2 : CLI_DAEMON_LINE_MAX;
+  char *buf = realloc(c->buf, cap);
+  if (buf == NULL) {
+    return false;
+  }
+  c->buf = buf;
+  c->cap = cap;
+  return true;
+}
+
+// the peer runs as the user of the daemon, in case the socket is in a directory others can access
+static bool peer_is_owner(int fd) {
+#ifdef SO_PEERCRED
+  struct ucred cred;
+  socklen_t len = sizeof(cred);
+  if (getsockopt(fd, SOL_SOCKET, SO_PEERCRED, &cred, &len) != 0) {
+    return false;
+  }
+  return cred.uid == geteuid();
+#else
+  uid_t uid;
+  gid_t gid;
+  if (getpeereid(fd, &uid, &gid) != 0) {
+    return false;
+  }
+  return uid == geteuid();
+#endif
+}
+
+static void client_accept(daemon_t *d) {
+  int fd = accept(d->listen_fd, NULL, NULL);
+  if (fd < 0) {
+    return;
+  }
+  if (!peer_is_owner(fd)) {
+    printf("[daemon] connection of another user refused\n");
+    close(fd);
+    return;
+  }
+  for (size_t i = 0; i < CLI_DAEMON_CLIENTS; i++) {
+    daemon_client_t *c = &d->clients[i];
+    if (c->fd < 0 && (c->buf || (c->buf = malloc(CLI_DAEMON_LINE_INIT)) != NULL)) {
+      // a client which doesn't read its output would block all other clients
+      struct timeval tv = {.tv_sec = CLI_DAEMON_SEND_TIMEOUT_MS / 1000,
+                           .tv_usec = (CLI_DAEMON_SEND_TIMEOUT_MS % 1000) * 1000};
+      setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv));
+      c->fd = fd;
+      c->cap = CLI_DAEMON_LINE_INIT;
+      c->len = 0;
+      return;
+    }
+  }
+  printf("[daemon] too many clients, connection refused\n");
+  close(fd);
+}
+
+// restore stdout and stderr of redirect_output()
+static void restore_output(int saved[2]) {
+  fflush(stdout);
+  fflush(stderr);
+  for (int i = 0; i < 2; i++) {
+    if (saved[i] >= 0) {
+      dup2(saved[i], i == 0 ? STDOUT_FILENO : STDERR_FILENO);
+      close(saved[i]);
+      saved[i] = -1;
+    }
+  }
+}
+
+// point stdout and stderr to fd, the original ones are kept in saved
+static int redirect_output(int fd, int saved[2]) {
+  fflush(stdout);
+  fflush(stderr);
+  saved[0] = dup(STDOUT_FILENO);
+  saved[1] = dup(STDERR_FILENO);
+  if (saved[0] >= 0 && saved[1] >= 0 && dup2(fd, STDOUT_FILENO) >= 0 && dup2(fd, STDERR_FILENO) >= 0) {
+    return 0;
+  }
+  int err = errno;
+  restore_output(saved);
+  errno = err;
+  return -1;
+}
+
+// send the content of a capture file with a prefix on every line, then empty the file
+static int send_capture(int client_fd, FILE *fp, char const prefix[]) {
+  int fd = fileno(fp);
+  size_t prefix_len = prefix ? strlen(prefix) : 0;
+  bool line_start = true;
+  char buf[4096];
+  int err = 0;
+
+  fflush(fp);
+  off_t size = lseek(fd, 0, SEEK_CUR);
+  for (off_t off = 0; off < size && err == 0;) {
+    ssize_t n = pread(fd, buf, sizeof(buf), off);
+    if (n <= 0) {
+      break;
+    }
+    off += n;
+    if (prefix_len == 0) {
+      err = send_all(client_fd, buf, (size_t)n);
+      continue;
+    }
+    for (char *p = buf, *end = buf + n; p < end && err == 0;) {
+      char *nl = memchr(p, '\n', (size_t)(end - p));
+      char *next = nl ? nl + 1 : end;
+      if (line_start) {
+        err = send_all(client_fd, prefix, prefix_len);
+      }
+      if (err == 0) {
+        err = send_all(client_fd, p, (size_t)(next - p));
+      }
+      line_start = nl != NULL;
+      p = next;
+    }
+  }
+  if (err == 0 && !line_start) {
+    err = send_all(client_fd, "\n", 1);
+  }
+
+  rewind(fp);
+  if (ftruncate(fd, 0) != 0) {
+    printf("[daemon] reset capture failed: %s\n", strerror(errno));
+  }
+  return err;
+}
+
+// run a command with its output captured, then send the output and the status line to the client
+static int daemon_command(daemon_t *d, int client_fd, char const line[]) {
+  bool structured = cli_out_structured();
+  int saved[2] = {-1, -1};
+  FILE *records = NULL;
+  cli_err_t cmd_ret = 0;
+  cli_err_t ret = CLI_ERR_FAILED;
+  int err = 0;
+
+  // text and errors go to the client as well, as lines of #log in structured modes so records can be parsed
+  if (redirect_output(fileno(structured ? d->log : d->capture), saved) != 0) {
+    printf("[daemon] capture output failed: %s\n", strerror(errno));
+    goto status;
+  }
+  if (structured) {
+    records = cli_out_set_record_stream(d->capture);
+  }
+
+  ret = cli_command_run(line, &cmd_ret);
+
+  if (records) {
+    cli_out_set_record_stream(records);
+  }
+  restore_output(saved);
+
+status:
+  err = send_capture(client_fd, d->capture, NULL);
+  if (err == 0 && structured) {
+    err = send_capture(client_fd, d->log, "#log ");
+  }
+  if (err == 0) {
+    char buf[32];
+    int n = snprintf(buf, sizeof(buf), "#status %d\n", ret != CLI_OK ? ret : cmd_ret);
+    err = send_all(client_fd, buf, (size_t)n);
+  }
+  return err;
+}
+
+// run the first complete line of a client, returns true if more lines are pending
+static bool client_run_line(daemon_t *d, daemon_client_t *c) {
+  char *nl = memchr(c->buf, '\n', c->len);
+  if (nl == NULL) {
+    if (c->len == c->cap && !client_grow(c)) {
+      send_all(c->fd, "command line is too long\n#status -1\n", 36);
+      client_close(c);
+    }
+    return false;
+  }
+
+  *nl = '\0';
+  size_t line_len = (size_t)(nl - c->buf);
+  if (line_len > 0 && c->buf[line_len - 1] == '\r') {
+    c->buf[line_len - 1] = '\0';
+  }
+
+  int err = 0;
+  if (strcmp(c->buf, "exit") == 0) {
+    err = -1;
+  } else if (c->buf[0] != '\0' && c->buf[0] != '#' && c->buf[0] != '/') {
+    err = daemon_command(d, c->fd, c->buf);
+  } else {
+    // a status per line, clients match them to the lines they sent
+    err = send_all(c->fd, "#status 0\n", 10);
+  }
+  if (err != 0) {
+    client_close(c);
+    return false;
+  }
+
+  c->len -= line_len + 1;
+  memmove(c->buf, nl + 1, c->len);
+  return memchr(c->buf, '\n', c->len) != NULL;
+}
+
+static void client_read(daemon_client_t *c) {
+  ssize_t n = recv(c->fd, c->buf + c->len, c->cap - c->len, 0);
+  if (n > 0) {
+    c->len += (size_t)n;
+  } else if (n == 0) {
+    // the last command may come without a new line
+    if (c->len > 0 && c->buf[c->len - 1] != '\n' && (c->len < c->cap || client_grow(c))) {
+      c->buf[c->len++] = '\n';
+    }
+    c->eof = true;
+  } else if (errno != EINTR && errno != EAGAIN) {
+    client_close(c);
+  }
+}
+
+int cli_daemon_run(char const path[]) {
+  daemon_t d = {.listen_fd = -1};
+  struct pollfd fds[CLI_DAEMON_CLIENTS + 1];
+  bool pending[CLI_DAEMON_CLIENTS] = {};
+  struct sigaction sa = {.sa_handler = daemon_signal}, old_int, old_term;
+  int ret = -1;
+
+  for (size_t i = 0; i < CLI_DAEMON_CLIENTS; i++) {
+    d.clients[i].fd = -1;
+  }
+  if ((d.capture = tmpfile()) == NULL || (d.log = tmpfile()) == NULL) {
+    printf("create capture file failed: %s\n", strerror(errno));
+    if (d.capture) {
+      fclose(d.capture);
+    }
+    return -1;
+  }
+  if ((d.listen_fd = listen_unix(path)) < 0) {
+    fclose(d.capture);
+    fclose(d.log);
+    return -1;
+  }
+
+  // no SA_RESTART, poll returns on signals
+  sigemptyset(&sa.sa_mask);
+  sigaction(SIGINT, &sa, &old_int);
+  sigaction(SIGTERM, &sa, &old_term);
+  daemon_stop = 0;
+  printf("[daemon] listening on %s\n", path);
+  fflush(stdout);
+
+  while (!daemon_stop) {
+    bool busy = false;
+    fds[0] = (struct pollfd){.fd = d.listen_fd, .events = POLLIN};
+    for (size_t i = 0; i < CLI_DAEMON_CLIENTS; i++) {
+      // a client with a full buffer has to be served before reading more
+      bool full = d.clients[i].len == d.clients[i].cap;
+      fds[i + 1] = (struct pollfd){.fd = full || d.clients[i].eof ? -1 : d.clients[i].fd, .events = POLLIN};
+      busy |= pending[i];
+    }
+    if (poll(fds, CLI_DAEMON_CLIENTS + 1, busy ? 0 : -1) < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      printf("[daemon] poll failed: %s\n", strerror(errno));
+      goto done;
+    }
+
+    if (fds[0].revents & POLLIN) {
+      client_accept(&d);
+    }
+    // a line per client in turn, a client sending many commands doesn't block others
+    for (size_t i = 0; i < CLI_DAEMON_CLIENTS && !daemon_stop; i++) {
+      daemon_client_t *c = &d.clients[i];
+      if (c->fd >= 0 && fds[i + 1].fd == c->fd && (fds[i + 1].revents & (POLLIN | POLLHUP | POLLERR))) {
+        client_read(c);
+      }
+      pending[i] = c->fd >= 0 && client_run_line(&d, c);
+      if (c->fd >= 0 && c->eof && !pending[i]) {
+        client_close(c);
+      }
+    }
+  }
+  ret = 0;
+  printf("[daemon] shutting down\n");
+
+done:
+  sigaction(SIGINT, &old_int, NULL);
+  sigaction(SIGTERM, &old_term, NULL);
+  for (size_t i = 0; i < CLI_DAEMON_CLIENTS; i++) {
+    if (d.clients[i].fd >= 0) {
+      close(d.clients[i].fd);
+    }
+    free(d.clients[i].buf);
+  }
+  close(d.listen_fd);
+  unlink(path);
+  fclose(d.capture);
+  fclose(d.log);
+  return ret;
+}
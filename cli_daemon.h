@@ -0,0 +1,27 @@
+#ifndef __CLI_DAEMON_H__
+#define __CLI_DAEMON_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Serve commands on a Unix domain socket until SIGINT or SIGTERM
+ *
+ * Clients send a command per line. The output of a command is captured and sent back to the client which sent it,
+ * followed by a status line "#status <code>", 0 on success. In JSON modes the records are sent back and the text goes
+ * to the log of the daemon. Commands of all clients share the initialized context and run one at a time, "exit"
+ * closes the connection of a client.
+ *
+ * cli_command_init must be called before it.
+ *
+ * @param path the socket path, an existing socket file is replaced
+ * @return int 0 on a clean shutdown
+ */
+int cli_daemon_run(char const path[]);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // __CLI_DAEMON_H__
@@ -0,0 +1,359 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <curl/curl.h>
+
+#include "cli_http.h"
+
+// data shared by handles of the same endpoint, released by the last handle.
+struct cli_http_share {
+  CURLSH *sh;
+  pthread_mutex_t locks[CURL_LOCK_DATA_LAST];
+  size_t refs; /*!< the pool and the handles in use, protected by the pool lock */
+};
+
+// an in-use handle and the share it was created with
+typedef struct {
+  CURL *curl;
+  cli_http_share_t *share;
+} http_conn_t;
+
+static void share_lock_cb(CURL *handle, curl_lock_data data, curl_lock_access access, void *userptr) {
+  (void)handle;
+  (void)access;
+  pthread_mutex_lock(&((cli_http_share_t *)userptr)->locks[data]);
+}
+
+static void share_unlock_cb(CURL *handle, curl_lock_data data, void *userptr) {
+  (void)handle;
+  pthread_mutex_unlock(&((cli_http_share_t *)userptr)->locks[data]);
+}
+
+static cli_http_share_t *share_new() {
+  cli_http_share_t *s = calloc(1, sizeof(cli_http_share_t));
+  if (s == NULL) {
+    return NULL;
+  }
+
+  if ((s->sh = curl_share_init()) == NULL) {
+    free(s);
+    return NULL;
+  }
+
+  for (int i = 0; i < CURL_LOCK_DATA_LAST; i++) {
+    pthread_mutex_init(&s->locks[i], NULL);
+  }
+  curl_share_setopt(s->sh, CURLSHOPT_LOCKFUNC, share_lock_cb);
+  curl_share_setopt(s->sh, CURLSHOPT_UNLOCKFUNC, share_unlock_cb);
+  curl_share_setopt(s->sh, CURLSHOPT_USERDATA, s);
+  curl_share_setopt(s->sh, CURLSHOPT_SHARE, CURL_LOCK_DATA_DNS);
+  curl_share_setopt(s->sh, CURLSHOPT_SHARE, CURL_LOCK_DATA_SSL_SESSION);
+  curl_share_setopt(s->sh, CURLSHOPT_SHARE, CURL_LOCK_DATA_CONNECT);
+  s->refs = 1;
+  return s;
+}
+
+// must be called with the pool lock
+static void share_unref(cli_http_share_t *s) {
+  if (s && --s->refs == 0) {
+    curl_share_cleanup(s->sh);
+    for (int i = 0; i < CURL_LOCK_DATA_LAST; i++) {
+      pthread_mutex_destroy(&s->locks[i]);
+    }
+    free(s);
+  }
+}
+
+static size_t write_cb(void *data, size_t size, size_t nmemb, void *userp) {
+  size_t len = size * nmemb;
+  if (!byte_buf_append((byte_buf_t *)userp, (byte_t const *)data, len)) {
+    // abort the transfer
+    return 0;
+  }
+  return len;
+}
+
+// must be called with the pool lock
+static void pool_flush_idle(cli_http_pool_t *pool) {
+  for (size_t i = 0; i < pool->idle_len; i++) {
+    curl_easy_cleanup(pool->idle[i]);
+  }
+  pool->idle_len = 0;
+}
+
+int cli_http_pool_init(cli_http_pool_t *pool, size_t max_idle) {
+  if (pool == NULL || max_idle == 0) {
+    return -1;
+  }
+
+  memset(pool, 0, sizeof(cli_http_pool_t));
+  // it's not thread-safe, init libcurl before any worker is created.
+  if (curl_global_init(CURL_GLOBAL_ALL) != CURLE_OK) {
+    return -1;
+  }
+
+  if ((pool->idle = calloc(max_idle, sizeof(void *))) == NULL) {
+    curl_global_cleanup();
+    return -1;
+  }
+  pool->idle_max = max_idle;
+  pthread_mutex_init(&pool->lock, NULL);
+  return 0;
+}
+
+void cli_http_pool_cleanup(cli_http_pool_t *pool) {
+  if (pool == NULL || pool->idle == NULL) {
+    return;
+  }
+
+  pthread_mutex_lock(&pool->lock);
+  pool_flush_idle(pool);
+  share_unref(pool->share);
+  pool->share = NULL;
+  pthread_mutex_unlock(&pool->lock);
+
+  pthread_mutex_destroy(&pool->lock);
+  free(pool->idle);
+  pool->idle = NULL;
+  curl_global_cleanup();
+}
+
+int cli_http_pool_set_endpoint(cli_http_pool_t *pool, char const host[], uint16_t port, bool use_tls) {
+  char url[CLI_HTTP_URL_MAX] = {};
+  int n = snprintf(url, sizeof(url), "%s://%s:%u", use_tls ? "https" : "http", host, port);
+  if (n < 0 || (size_t)n >= sizeof(url)) {
+    return -1;
+  }
+
+  cli_http_share_t *share = share_new();
+  if (share == NULL) {
+    return -1;
+  }
+
+  pthread_mutex_lock(&pool->lock);
+  if (pool->share) {
+    pool->stats.invalidations++;
+  }
+  // handles in use are released to the old share when they're done.
+  pool_flush_idle(pool);
+  share_unref(pool->share);
+  pool->share = share;
+  memcpy(pool->base_url, url, sizeof(url));
+  pthread_mutex_unlock(&pool->lock);
+  return 0;
+}
+
+void cli_http_pool_set_timeouts(cli_http_pool_t *pool, long connect_ms, long total_ms) {
+  pthread_mutex_lock(&pool->lock);
+  pool->connect_timeout_ms = connect_ms;
+  pool->timeout_ms = total_ms;
+  pthread_mutex_unlock(&pool->lock);
+}
+
+void cli_http_pool_abort(cli_http_pool_t *pool) { __atomic_store_n(&pool->aborted, true, __ATOMIC_RELAXED); }
+
+// a non-zero return fails the transfer, it's called about once a second even if nothing is transferred
+static int abort_cb(void *clientp, curl_off_t dltotal, curl_off_t dlnow, curl_off_t ultotal, curl_off_t ulnow) {
+  cli_http_pool_t *pool = (cli_http_pool_t *)clientp;
+  return __atomic_load_n(&pool->aborted, __ATOMIC_RELAXED) ? 1 : 0;
+}
+
+static void handle_set_timeouts(cli_http_pool_t *pool, CURL *curl) {
+  pthread_mutex_lock(&pool->lock);
+  long connect_ms = pool->connect_timeout_ms;
+  long total_ms = pool->timeout_ms;
+  pthread_mutex_unlock(&pool->lock);
+  curl_easy_setopt(curl, CURLOPT_CONNECTTIMEOUT_MS, connect_ms);
+  curl_easy_setopt(curl, CURLOPT_TIMEOUT_MS, total_ms);
+  // cli_http_pool_abort doesn't wait for the timeouts
+  curl_easy_setopt(curl, CURLOPT_XFERINFOFUNCTION, abort_cb);
+  curl_easy_setopt(curl, CURLOPT_XFERINFODATA, pool);
+  curl_easy_setopt(curl, CURLOPT_NOPROGRESS, 0L);
+}
+
+static int pool_acquire(cli_http_pool_t *pool, char const path[], char *url, size_t url_len, http_conn_t *conn) {
+  int ret = 0;
+  conn->curl = NULL;
+  conn->share = NULL;
+
+  pthread_mutex_lock(&pool->lock);
+  if (pool->share == NULL) {
+    // endpoint is not set
+    ret = -1;
+  } else {
+    int n = snprintf(url, url_len, "%s%s", pool->base_url, path);
+    if (n < 0 || (size_t)n >= url_len) {
+      ret = -1;
+    } else {
+      conn->share = pool->share;
+      conn->share->refs++;
+      if (pool->idle_len > 0) {
+        conn->curl = pool->idle[--pool->idle_len];
+      }
+    }
+  }
+  pthread_mutex_unlock(&pool->lock);
+
+  if (ret == 0 && conn->curl == NULL) {
+    if ((conn->curl = curl_easy_init()) == NULL) {
+      pthread_mutex_lock(&pool->lock);
+      share_unref(conn->share);
+      pthread_mutex_unlock(&pool->lock);
+      return -1;
+    }
+    curl_easy_setopt(conn->curl, CURLOPT_SHARE, conn->share->sh);
+    curl_easy_setopt(conn->curl, CURLOPT_TCP_KEEPALIVE, 1L);
+    curl_easy_setopt(conn->curl, CURLOPT_HTTP_VERSION, (long)CURL_HTTP_VERSION_2TLS);
+    curl_easy_setopt(conn->curl, CURLOPT_NOSIGNAL, 1L);
+    curl_easy_setopt(conn->curl, CURLOPT_WRITEFUNCTION, write_cb);
+  }
+  if (ret == 0) {
+    // the timeouts could be changed since the handle was pooled
+    handle_set_timeouts(pool, conn->curl);
+  }
+  return ret;
+}
+
+static void pool_release(cli_http_pool_t *pool, http_conn_t *conn, CURLcode res) {
+  long connects = 0;
+  curl_easy_getinfo(conn->curl, CURLINFO_NUM_CONNECTS, &connects);
+
+  pthread_mutex_lock(&pool->lock);
+  pool->stats.requests++;
+  if (res != CURLE_OK) {
+    pool->stats.failed++;
+  }
+  if (connects > 0) {
+    pool->stats.connects += connects;
+  } else if (res == CURLE_OK) {
+    pool->stats.reused++;
+  }
+
+  // keep the handle warm if it belongs to the current endpoint
+  if (res == CURLE_OK && conn->share == pool->share && pool->idle_len < pool->idle_max) {
+    pool->idle[pool->idle_len++] = conn->curl;
+  } else {
+    curl_easy_cleanup(conn->curl);
+  }
+  share_unref(conn->share);
+  pthread_mutex_unlock(&pool->lock);
+}
+
+static int http_perform(cli_http_pool_t *pool, char const path[], struct curl_slist *headers, byte_t const body[],
+                        size_t body_len, byte_buf_t *res, long *status) {
+  char url[CLI_HTTP_URL_MAX + 256] = {};
+  http_conn_t conn = {};
+
+  if (pool == NULL || path == NULL || res == NULL) {
+    return -1;
+  }
+
+  if (pool_acquire(pool, path, url, sizeof(url), &conn) != 0) {
+    return -1;
+  }
+
+  CURL *curl = conn.curl;
+  curl_easy_setopt(curl, CURLOPT_URL, url);
+  curl_easy_setopt(curl, CURLOPT_WRITEDATA, res);
+  curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers);
+  if (body) {
+    curl_easy_setopt(curl, CURLOPT_POST, 1L);
+    curl_easy_setopt(curl, CURLOPT_POSTFIELDS, body);
+    curl_easy_setopt(curl, CURLOPT_POSTFIELDSIZE, (long)body_len);
+  } else {
+    curl_easy_setopt(curl, CURLOPT_HTTPGET, 1L);
+  }
+
+  CURLcode ret = curl_easy_perform(curl);
+  if (ret == CURLE_OK) {
+    if (status) {
+      curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, status);
+    }
+    byte_buf2str(res);
+  } else {
+    printf("[%s:%d] %s: %s\n", __func__, __LINE__, url, curl_easy_strerror(ret));
+  }
+
+  // the handle is reused, do not keep pointers to the caller's data
+  curl_easy_setopt(curl, CURLOPT_HTTPHEADER, NULL);
+  curl_easy_setopt(curl, CURLOPT_WRITEDATA, NULL);
+  curl_easy_setopt(curl, CURLOPT_POSTFIELDS, NULL);
+  pool_release(pool, &conn, ret);
+  return ret == CURLE_OK ? 0 : -1;
+}
+
+int cli_http_get(cli_http_pool_t *pool, char const path[], byte_buf_t *res, long *status) {
+  return http_perform(pool, path, NULL, NULL, 0, res, status);
+}
+
+int cli_http_get_endpoint(cli_http_pool_t *pool, char const host[], uint16_t port, bool use_tls, char const path[],
+                          byte_buf_t *res, long *status) {
+  char url[CLI_HTTP_URL_MAX + 256] = {};
+
+  if (pool == NULL || host == NULL || path == NULL || res == NULL) {
+    return -1;
+  }
+  int n = snprintf(url, sizeof(url), "%s://%s:%u%s", use_tls ? "https" : "http", host, port, path);
+  if (n < 0 || (size_t)n >= sizeof(url)) {
+    return -1;
+  }
+
+  CURL *curl = curl_easy_init();
+  if (curl == NULL) {
+    return -1;
+  }
+  curl_easy_setopt(curl, CURLOPT_URL, url);
+  curl_easy_setopt(curl, CURLOPT_NOSIGNAL, 1L);
+  curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, write_cb);
+  curl_easy_setopt(curl, CURLOPT_WRITEDATA, res);
+  handle_set_timeouts(pool, curl);
+
+  CURLcode ret = curl_easy_perform(curl);
+  if (ret == CURLE_OK) {
+    if (status) {
+      curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, status);
+    }
+    byte_buf2str(res);
+  } else {
+    printf("[%s:%d] %s: %s\n", __func__, __LINE__, url, curl_easy_strerror(ret));
+  }
+
+  long connects = 0;
+  curl_easy_getinfo(curl, CURLINFO_NUM_CONNECTS, &connects);
+  curl_easy_cleanup(curl);
+
+  pthread_mutex_lock(&pool->lock);
+  pool->stats.requests++;
+  pool->stats.connects += connects;
+  if (ret != CURLE_OK) {
+    pool->stats.failed++;
+  }
+  pthread_mutex_unlock(&pool->lock);
+  return ret == CURLE_OK ? 0 : -1;
+}
+
+int cli_http_post(cli_http_pool_t *pool, char const path[], char const content_type[], byte_t const body[],
+                  size_t body_len, byte_buf_t *res, long *status) {
+  char header[128] = {};
+  struct curl_slist *headers = NULL;
+
+  if (body == NULL) {
+    return -1;
+  }
+
+  snprintf(header, sizeof(header), "Content-Type: %s", content_type);
+  if ((headers = curl_slist_append(NULL, header)) == NULL) {
+    return -1;
+  }
+
+  int ret = http_perform(pool, path, headers, body, body_len, res, status);
+  curl_slist_free_all(headers);
+  return ret;
+}
+
+void cli_http_pool_stats(cli_http_pool_t *pool, cli_http_stats_t *stats) {
+  pthread_mutex_lock(&pool->lock);
+  memcpy(stats, &pool->stats, sizeof(cli_http_stats_t));
+  pthread_mutex_unlock(&pool->lock);
+}
@@ -0,0 +1,158 @@
+#ifndef __CLI_HTTP_H__
+#define __CLI_HTTP_H__
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "core/utils/byte_buffer.h"
+
+// max length of the endpoint URL, "https://" + host + ":" + port
+#define CLI_HTTP_URL_MAX 300
+
+typedef struct cli_http_share cli_http_share_t;
+
+/**
+ * @brief HTTP connection statistics
+ *
+ */
+typedef struct {
+  uint64_t requests;      /*!< number of requests */
+  uint64_t failed;        /*!< number of failed transfers */
+  uint64_t connects;      /*!< number of new connections, each one is a TCP/TLS handshake */
+  uint64_t reused;        /*!< number of requests on a warm connection, handshakes are avoided */
+  uint64_t invalidations; /*!< number of times the pool was flushed by an endpoint change */
+} cli_http_stats_t;
+
+/**
+ * @brief A pool of keep-alive HTTP handles to the connected node
+ *
+ * Idle handles keep their connections open, connections, TLS sessions, and DNS cache are shared among all handles
+ * of the same endpoint. It's safe to use the pool from multiple threads.
+ *
+ */
+typedef struct {
+  pthread_mutex_t lock;
+  char base_url[CLI_HTTP_URL_MAX]; /*!< scheme, host, and port of the endpoint */
+  cli_http_share_t *share;         /*!< shared data of the current endpoint */
+  void **idle;                     /*!< idle curl handles */
+  size_t idle_len;                 /*!< number of idle handles */
+  size_t idle_max;                 /*!< max number of idle handles */
+  long connect_timeout_ms;         /*!< timeout of connecting, 0 for the libcurl default */
+  long timeout_ms;                 /*!< timeout of a whole request, 0 for none */
+  bool aborted;                    /*!< requests fail at once, it's set on exit */
+  cli_http_stats_t stats;
+} cli_http_pool_t;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Initialize a connection pool
+ *
+ * @param pool the pool
+ * @param max_idle max number of idle handles are kept
+ * @return int 0 on success
+ */
+int cli_http_pool_init(cli_http_pool_t *pool, size_t max_idle);
+
+/**
+ * @brief Close all connections and release the pool
+ *
+ * @param pool the pool
+ */
+void cli_http_pool_cleanup(cli_http_pool_t *pool);
+
+/**
+ * @brief Set the endpoint of the pool
+ *
+ * Connections and TLS sessions of the previous endpoint are invalidated, in-flight requests are completed on the
+ * previous endpoint.
+ *
+ * @param pool the pool
+ * @param host the host name
+ * @param port the port number
+ * @param use_tls use HTTPS or not
+ * @return int 0 on success
+ */
+int cli_http_pool_set_endpoint(cli_http_pool_t *pool, char const host[], uint16_t port, bool use_tls);
+
+/**
+ * @brief Set timeouts of requests, a request on an unresponsive node fails instead of blocking
+ *
+ * @param pool the pool
+ * @param connect_ms timeout of connecting in milliseconds, 0 for the libcurl default
+ * @param total_ms timeout of a whole request in milliseconds, 0 for none
+ */
+void cli_http_pool_set_timeouts(cli_http_pool_t *pool, long connect_ms, long total_ms);
+
+/**
+ * @brief Abort in-flight requests and fail later ones, threads blocked on the node are joined at once on exit
+ *
+ * In-flight requests fail within a second, it's not reverted.
+ *
+ * @param pool the pool
+ */
+void cli_http_pool_abort(cli_http_pool_t *pool);
+
+/**
+ * @brief Perform a HTTP GET request
+ *
+ * The response is a null-terminated string in res.
+ *
+ * @param pool the pool
+ * @param path the path and query of the request, e.g. "/api/v1/info"
+ * @param res a buffer for the response body
+ * @param status the HTTP status code, can be NULL
+ * @return int 0 on success
+ */
+int cli_http_get(cli_http_pool_t *pool, char const path[], byte_buf_t *res, long *status);
+
+/**
+ * @brief Perform a HTTP GET request on an endpoint which is not the one of the pool, e.g. a node before it's set
+ *
+ * The request runs on a new connection which is not kept, the timeouts of the pool apply.
+ *
+ * @param pool the pool
+ * @param host the host name
+ * @param port the port number
+ * @param use_tls use HTTPS or not
+ * @param path the path and query of the request
+ * @param res a buffer for the response body
+ * @param status the HTTP status code, can be NULL
+ * @return int 0 on success
+ */
+int cli_http_get_endpoint(cli_http_pool_t *pool, char const host[], uint16_t port, bool use_tls, char const path[],
+                          byte_buf_t *res, long *status);
+
+/**
+ * @brief Perform a HTTP POST request
+ *
+ * The response is a null-terminated string in res.
+ *
+ * @param pool the pool
+ * @param path the path of the request
+ * @param content_type the content type of the request body
+ * @param body the request body
+ * @param body_len the length of the request body
+ * @param res a buffer for the response body
+ * @param status the HTTP status code, can be NULL
+ * @return int 0 on success
+ */
+int cli_http_post(cli_http_pool_t *pool, char const path[], char const content_type[], byte_t const body[],
+                  size_t body_len, byte_buf_t *res, long *status);
+
+/**
+ * @brief Get a snapshot of the statistics
+ *
+ * @param pool the pool
+ * @param stats the output statistics
+ */
+void cli_http_pool_stats(cli_http_pool_t *pool, cli_http_stats_t *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // __CLI_HTTP_H__
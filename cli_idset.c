@@ -0,0 +1,102 @@
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "cli_idset.h"
+
+#define IDSET_MIN_CAP 64
+
+static uint8_t const zero_id[CLI_IDSET_ID_BYTES] = {};
+
+static bool is_zero(uint8_t const id[]) { return memcmp(id, zero_id, CLI_IDSET_ID_BYTES) == 0; }
+
+static size_t id_hash(uint8_t const id[]) {
+  uint64_t h;
+  memcpy(&h, id, sizeof(h));
+  return (size_t)h;
+}
+
+// find the slot of the ID or the empty slot it should be put
+static uint8_t *idset_slot(uint8_t *slots, size_t cap, uint8_t const id[]) {
+  size_t mask = cap - 1;
+  for (size_t i = id_hash(id) & mask;; i = (i + 1) & mask) {
+    uint8_t *slot = slots + i * CLI_IDSET_ID_BYTES;
+    if (is_zero(slot) || memcmp(slot, id, CLI_IDSET_ID_BYTES) == 0) {
+      return slot;
+    }
+  }
+}
+
+static int idset_grow(cli_idset_t *set) {
+  if (set->cap > SIZE_MAX / 2 / CLI_IDSET_ID_BYTES) {
+    return -1;
+  }
+  size_t cap = set->cap * 2;
+  uint8_t *slots = calloc(cap, CLI_IDSET_ID_BYTES);
+  if (slots == NULL) {
+    return -1;
+  }
+
+  for (size_t i = 0; i < set->cap; i++) {
+    uint8_t const *id = set->slots + i * CLI_IDSET_ID_BYTES;
+    if (!is_zero(id)) {
+      memcpy(idset_slot(slots, cap, id), id, CLI_IDSET_ID_BYTES);
+    }
+  }
+  free(set->slots);
+  set->slots = slots;
+  set->cap = cap;
+  return 0;
+}
+
+int cli_idset_init(cli_idset_t *set, size_t init_cap) {
+  size_t cap = IDSET_MIN_CAP;
+  // keep the load factor under 0.5 for the expected IDs, the size of the table must not overflow
+  while (cap / 2 < init_cap && cap <= SIZE_MAX / 2 / CLI_IDSET_ID_BYTES) {
+    cap *= 2;
+  }
+
+  memset(set, 0, sizeof(cli_idset_t));
+  if ((set->slots = calloc(cap, CLI_IDSET_ID_BYTES)) == NULL) {
+    return -1;
+  }
+  set->cap = cap;
+  return 0;
+}
+
+void cli_idset_free(cli_idset_t *set) {
+  free(set->slots);
+  memset(set, 0, sizeof(cli_idset_t));
+}
+
+int cli_idset_add(cli_idset_t *set, uint8_t const id[]) {
+  // the all-zero ID marks empty slots
+  if (is_zero(id)) {
+    if (set->has_zero) {
+      return 0;
+    }
+    set->has_zero = true;
+    set->len++;
+    return 1;
+  }
+
+  // grow at the load factor of 0.7
+  if ((set->len + 1) * 10 > set->cap * 7 && idset_grow(set) != 0) {
+    return -1;
+  }
+
+  uint8_t *slot = idset_slot(set->slots, set->cap, id);
+  if (!is_zero(slot)) {
+    return 0;
+  }
+  memcpy(slot, id, CLI_IDSET_ID_BYTES);
+  set->len++;
+  return 1;
+}
+
+bool cli_idset_contains(cli_idset_t const *set, uint8_t const id[]) {
+  if (is_zero(id)) {
+    return set->has_zero;
+  }
+  return !is_zero(idset_slot(set->slots, set->cap, id));
+}
@@ -0,0 +1,67 @@
+#ifndef __CLI_IDSET_H__
+#define __CLI_IDSET_H__
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// size of an ID in the set, message IDs are 32-byte hashes
+#define CLI_IDSET_ID_BYTES 32
+
+/**
+ * @brief A compact hash set of 32-byte IDs
+ *
+ * IDs are stored inline in an open addressing table, IDs are hashes so the first bytes are used as the hash value.
+ * It's not thread-safe.
+ *
+ */
+typedef struct {
+  uint8_t *slots; /*!< IDs, an all-zero slot is empty */
+  size_t cap;     /*!< number of slots, power of 2 */
+  size_t len;     /*!< number of IDs */
+  bool has_zero;  /*!< the all-zero ID is in the set */
+} cli_idset_t;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Initialize an ID set
+ *
+ * @param set the set
+ * @param init_cap the expected number of IDs
+ * @return int 0 on success
+ */
+int cli_idset_init(cli_idset_t *set, size_t init_cap);
+
+/**
+ * @brief Release the ID set
+ *
+ * @param set the set
+ */
+void cli_idset_free(cli_idset_t *set);
+
+/**
+ * @brief Add an ID to the set
+ *
+ * @param set the set
+ * @param id the ID, CLI_IDSET_ID_BYTES
+ * @return int 1 if the ID is added, 0 if it's in the set already, -1 on failed
+ */
+int cli_idset_add(cli_idset_t *set, uint8_t const id[]);
+
+/**
+ * @brief Check if an ID is in the set
+ *
+ * @param set the set
+ * @param id the ID, CLI_IDSET_ID_BYTES
+ * @return true if found
+ */
+bool cli_idset_contains(cli_idset_t const *set, uint8_t const id[]);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // __CLI_IDSET_H__
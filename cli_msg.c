@@ -0,0 +1,74 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include "cli_msg.h"
+#include "core/models/message.h"
+#include "crypto/iota_crypto.h"
+
+#define MSG_PAYLOAD_TYPE_INDEXATION 2
+#define MSG_INDEX_MAX 64
+
+static bool append_uint(byte_buf_t *buf, uint64_t v, size_t bytes) {
+  byte_t le[8];
+  for (size_t i = 0; i < bytes; i++) {
+    le[i] = (byte_t)(v >> (8 * i));
+  }
+  return byte_buf_append(buf, le, bytes);
+}
+
+static int parent_cmp(void const *a, void const *b) { return memcmp(a, b, IOTA_MESSAGE_ID_BYTES); }
+
+uint64_t cli_msg_network_id(char const network[]) {
+  byte_t hash[32] = {};
+  uint64_t id = 0;
+  if (iota_blake2b_sum((byte_t const *)network, strlen(network), hash, sizeof(hash)) != 0) {
+    return 0;
+  }
+  for (int i = 0; i < 8; i++) {
+    id |= (uint64_t)hash[i] << (8 * i);
+  }
+  return id;
+}
+
+int cli_msg_indexation(uint64_t network_id, char const *const parents[], size_t parents_len, char const index[],
+                       byte_t const data[], size_t data_len, byte_buf_t *out) {
+  byte_t ids[CLI_MSG_PARENTS_MAX][IOTA_MESSAGE_ID_BYTES];
+  size_t index_len = strlen(index);
+
+  if (parents_len == 0 || parents_len > CLI_MSG_PARENTS_MAX || index_len == 0 || index_len > MSG_INDEX_MAX ||
+      data_len > UINT32_MAX) {
+    return -1;
+  }
+
+  for (size_t i = 0; i < parents_len; i++) {
+    if (strlen(parents[i]) != IOTA_MESSAGE_ID_HEX_BYTES ||
+        hex_2_bin(parents[i], IOTA_MESSAGE_ID_HEX_BYTES, ids[i], IOTA_MESSAGE_ID_BYTES) != 0) {
+      return -1;
+    }
+  }
+  // parents must be sorted and unique
+  qsort(ids, parents_len, IOTA_MESSAGE_ID_BYTES, parent_cmp);
+  size_t uniq = 1;
+  for (size_t i = 1; i < parents_len; i++) {
+    if (memcmp(ids[i], ids[uniq - 1], IOTA_MESSAGE_ID_BYTES) != 0) {
+      memmove(ids[uniq++], ids[i], IOTA_MESSAGE_ID_BYTES);
+    }
+  }
+
+  // type + index length + index + data length + data
+  uint64_t payload_len = 4 + 2 + index_len + 4 + data_len;
+  if (payload_len > UINT32_MAX) {
+    return -1;
+  }
+
+  bool ok = append_uint(out, network_id, 8) && append_uint(out, uniq, 1);
+  for (size_t i = 0; i < uniq && ok; i++) {
+    ok = byte_buf_append(out, ids[i], IOTA_MESSAGE_ID_BYTES);
+  }
+  ok = ok && append_uint(out, payload_len, 4) && append_uint(out, MSG_PAYLOAD_TYPE_INDEXATION, 4) &&
+       append_uint(out, index_len, 2) && byte_buf_append(out, (byte_t const *)index, index_len) &&
+       append_uint(out, data_len, 4) && (data_len == 0 || byte_buf_append(out, data, data_len));
+  // nonce
+  ok = ok && append_uint(out, 0, 8);
+  return ok ? 0 : -1;
+}
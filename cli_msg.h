@@ -0,0 +1,47 @@
+#ifndef __CLI_MSG_H__
+#define __CLI_MSG_H__
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "core/utils/byte_buffer.h"
+
+// max number of parents of a message
+#define CLI_MSG_PARENTS_MAX 8
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Get the network ID of a network name
+ *
+ * The network ID is the first 8 bytes of the BLAKE2b-256 hash of the network name, in little-endian.
+ *
+ * @param network the network name from the node info, e.g. "testnet7"
+ * @return uint64_t the network ID
+ */
+uint64_t cli_msg_network_id(char const network[]);
+
+/**
+ * @brief Serialize a message with an indexation payload
+ *
+ * Parents are sorted and deduplicated. The nonce is zero, it's at the last 8 bytes of the message.
+ *
+ * @param network_id the network ID
+ * @param parents hex strings of parent message IDs
+ * @param parents_len the number of parents, 1 to CLI_MSG_PARENTS_MAX
+ * @param index the index of the payload
+ * @param data the data of the payload
+ * @param data_len the length of the data
+ * @param out the serialized message
+ * @return int 0 on success
+ */
+int cli_msg_indexation(uint64_t network_id, char const *const parents[], size_t parents_len, char const index[],
+                       byte_t const data[], size_t data_len, byte_buf_t *out);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // __CLI_MSG_H__
@@ -0,0 +1,406 @@
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "cli_msg_store.h"
+#include "core/utils/byte_buffer.h"
+#include "uthash.h"
+
+#define STORE_MAGIC "ICMS"
+#define STORE_VERSION 1
+#define REC_MAGIC 0x4345524dU  // "MREC"
+#define STORE_ID_BYTES 32
+
+// file header
+typedef struct {
+  char magic[4];
+  uint32_t version;
+} store_hdr_t;
+
+// record header, followed by the JSON response
+typedef struct {
+  uint32_t magic;
+  uint32_t len; /*!< length of the JSON response */
+  uint32_t crc; /*!< CRC32 of the ID and the JSON response */
+  byte_t id[STORE_ID_BYTES];
+} rec_hdr_t;
+
+typedef struct {
+  byte_t id[STORE_ID_BYTES];
+  size_t offset; /*!< offset of the JSON response */
+  uint32_t len;
+  UT_hash_handle hh;
+} store_idx_t;
+
+struct cli_msg_store {
+  pthread_mutex_t lock;
+  int fd;
+  char *path;
+  byte_t *map;    /*!< read-only mapping of the file */
+  size_t map_len; /*!< mapped length, could be behind the file size after appending */
+  store_idx_t *index;
+  cli_msg_store_stats_t stats;
+};
+
+static uint32_t crc_table[256];
+static pthread_once_t crc_once = PTHREAD_ONCE_INIT;
+
+static void crc_table_init() {
+  for (uint32_t i = 0; i < 256; i++) {
+    uint32_t c = i;
+    for (int k = 0; k < 8; k++) {
+      c = (c & 1) ? 0xEDB88320U ^ (c >> 1) : c >> 1;
+    }
+    crc_table[i] = c;
+  }
+}
+
+static uint32_t crc32_update(uint32_t crc, byte_t const *data, size_t len) {
+  crc = ~crc;
+  for (size_t i = 0; i < len; i++) {
+    crc = crc_table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+  }
+  return ~crc;
+}
+
+static uint32_t rec_crc(byte_t const id[], byte_t const *json, size_t len) {
+  return crc32_update(crc32_update(0, id, STORE_ID_BYTES), json, len);
+}
+
+static int id_from_hex(char const msg_id[], byte_t id[]) {
+  if (strlen(msg_id) != STORE_ID_BYTES * 2) {
+    return -1;
+  }
+  return hex_2_bin(msg_id, STORE_ID_BYTES * 2, id, STORE_ID_BYTES);
+}
+
+// map len bytes of the file, must be called with the lock
+static int store_remap(cli_msg_store_t *store, size_t len) {
+  if (store->map) {
+    munmap(store->map, store->map_len);
+    store->map = NULL;
+    store->map_len = 0;
+  }
+  if (len == 0) {
+    return 0;
+  }
+  void *map = mmap(NULL, len, PROT_READ, MAP_SHARED, store->fd, 0);
+  if (map == MAP_FAILED) {
+    return -1;
+  }
+  store->map = (byte_t *)map;
+  store->map_len = len;
+  return 0;
+}
+
+static void index_free(cli_msg_store_t *store) {
+  store_idx_t *elm, *tmp;
+  HASH_ITER(hh, store->index, elm, tmp) {
+    HASH_DEL(store->index, elm);
+    free(elm);
+  }
+  store->stats.records = 0;
+}
+
+static int index_add(cli_msg_store_t *store, byte_t const id[], size_t offset, uint32_t len) {
+  store_idx_t *elm = NULL;
+  HASH_FIND(hh, store->index, id, STORE_ID_BYTES, elm);
+  if (elm) {
+    // a message is appended once, but the latest record wins
+    elm->offset = offset;
+    elm->len = len;
+    return 0;
+  }
+
+  if ((elm = malloc(sizeof(store_idx_t))) == NULL) {
+    return -1;
+  }
+  memcpy(elm->id, id, STORE_ID_BYTES);
+  elm->offset = offset;
+  elm->len = len;
+  HASH_ADD(hh, store->index, id, STORE_ID_BYTES, elm);
+  store->stats.records++;
+  return 0;
+}
+
+typedef enum {
+  REC_VALID = 0,
+  REC_PARTIAL, /*!< the record runs past the end of the file */
+  REC_CORRUPT, /*!< a complete record with a bad magic or CRC */
+} rec_state_t;
+
+static rec_state_t rec_check(cli_msg_store_t const *store, size_t offset, rec_hdr_t *rec) {
+  if (offset + sizeof(rec_hdr_t) > store->map_len) {
+    return REC_PARTIAL;
+  }
+  memcpy(rec, store->map + offset, sizeof(rec_hdr_t));
+  size_t json_offset = offset + sizeof(rec_hdr_t);
+  if (rec->magic != REC_MAGIC) {
+    return REC_CORRUPT;
+  }
+  if (rec->len > store->map_len - json_offset) {
+    return REC_PARTIAL;
+  }
+  return rec_crc(rec->id, store->map + json_offset, rec->len) == rec->crc ? REC_VALID : REC_CORRUPT;
+}
+
+// the offset of the next valid record after a bad one, or the end of the mapping if there's none
+static size_t rec_resync(cli_msg_store_t const *store, size_t offset) {
+  uint32_t const magic = REC_MAGIC;
+  rec_hdr_t rec;
+  for (size_t p = offset + 1; p + sizeof(rec_hdr_t) <= store->map_len; p++) {
+    if (memcmp(store->map + p, &magic, sizeof(magic)) == 0 && rec_check(store, p, &rec) == REC_VALID) {
+      return p;
+    }
+  }
+  return store->map_len;
+}
+
+// index records after the known ones up to the end of the mapping, returns the end of the indexed part. Corrupt
+// records are skipped, only a record running past the end of the file is left out as a partial tail.
+static int store_scan(cli_msg_store_t *store, size_t *end) {
+  size_t offset = store->stats.file_size;
+  while (offset < store->map_len) {
+    rec_hdr_t rec;
+    rec_state_t state = rec_check(store, offset, &rec);
+    if (state != REC_VALID) {
+      size_t next = rec_resync(store, offset);
+      if (next == store->map_len && state == REC_PARTIAL) {
+        // the last record, a crashed writer left it
+        break;
+      }
+      store->stats.corrupted += next - offset;
+      offset = next;
+      continue;
+    }
+    size_t json_offset = offset + sizeof(rec_hdr_t);
+    if (index_add(store, rec.id, json_offset, rec.len) != 0) {
+      return -1;
+    }
+    offset = json_offset + rec.len;
+  }
+  *end = offset;
+  store->stats.file_size = offset;
+  return 0;
+}
+
+// index records appended by other processes, must be called with the lock and a file lock. Appends are done with
+// the exclusive file lock, so a partial tail seen with it is left by a crashed writer, it's truncated if trim is set.
+// Corrupt records before the tail are kept in the file and skipped.
+static int store_sync(cli_msg_store_t *store, bool trim) {
+  struct stat st;
+  size_t end = 0;
+
+  if (fstat(store->fd, &st) != 0) {
+    return -1;
+  }
+  size_t size = (size_t)st.st_size;
+  if (size == store->stats.file_size) {
+    return 0;
+  }
+  if (size != store->map_len && store_remap(store, size) != 0) {
+    return -1;
+  }
+  if (store_scan(store, &end) != 0) {
+    return -1;
+  }
+
+  if (trim && end < size) {
+    store->stats.truncated += size - end;
+    if (ftruncate(store->fd, (off_t)end) != 0) {
+      return -1;
+    }
+    return store_remap(store, end);
+  }
+  return 0;
+}
+
+// check the header and build the index, must be called with the exclusive file lock
+static int store_load(cli_msg_store_t *store) {
+  struct stat st;
+  store_hdr_t hdr = {};
+
+  if (fstat(store->fd, &st) != 0) {
+    return -1;
+  }
+
+  if ((size_t)st.st_size < sizeof(store_hdr_t)) {
+    // a new file, or crashed before the header was written
+    memcpy(hdr.magic, STORE_MAGIC, sizeof(hdr.magic));
+    hdr.version = STORE_VERSION;
+    if (ftruncate(store->fd, 0) != 0 || pwrite(store->fd, &hdr, sizeof(hdr), 0) != sizeof(hdr)) {
+      return -1;
+    }
+    store->stats.file_size = sizeof(hdr);
+    return store_remap(store, sizeof(hdr));
+  }
+
+  if (pread(store->fd, &hdr, sizeof(hdr), 0) != sizeof(hdr)) {
+    return -1;
+  }
+  if (memcmp(hdr.magic, STORE_MAGIC, sizeof(hdr.magic)) != 0 || hdr.version != STORE_VERSION) {
+    printf("%s is not a message store\n", store->path);
+    return -1;
+  }
+
+  store->stats.file_size = sizeof(store_hdr_t);
+  return store_sync(store, true);
+}
+
+cli_msg_store_t *cli_msg_store_open(char const path[]) {
+  pthread_once(&crc_once, crc_table_init);
+
+  cli_msg_store_t *store = calloc(1, sizeof(cli_msg_store_t));
+  if (store == NULL) {
+    return NULL;
+  }
+
+  if ((store->path = strdup(path)) == NULL) {
+    free(store);
+    return NULL;
+  }
+
+  if ((store->fd = open(path, O_RDWR | O_CREAT | O_CLOEXEC, 0600)) < 0) {
+    printf("open %s failed\n", path);
+    free(store->path);
+    free(store);
+    return NULL;
+  }
+  pthread_mutex_init(&store->lock, NULL);
+
+  // other processes, e.g. a daemon and single commands, share the file
+  if (flock(store->fd, LOCK_EX) != 0) {
+    cli_msg_store_close(store);
+    return NULL;
+  }
+  int ret = store_load(store);
+  flock(store->fd, LOCK_UN);
+  if (ret != 0) {
+    cli_msg_store_close(store);
+    return NULL;
+  }
+  return store;
+}
+
+void cli_msg_store_close(cli_msg_store_t *store) {
+  if (store) {
+    if (store->map) {
+      munmap(store->map, store->map_len);
+    }
+    close(store->fd);
+    index_free(store);
+    pthread_mutex_destroy(&store->lock);
+    free(store->path);
+    free(store);
+  }
+}
+
+char *cli_msg_store_get(cli_msg_store_t *store, char const msg_id[]) {
+  byte_t id[STORE_ID_BYTES];
+  store_idx_t *elm = NULL;
+  char *json = NULL;
+
+  if (store == NULL || id_from_hex(msg_id, id) != 0) {
+    return NULL;
+  }
+
+  pthread_mutex_lock(&store->lock);
+  HASH_FIND(hh, store->index, id, STORE_ID_BYTES, elm);
+  if (elm == NULL && flock(store->fd, LOCK_SH) == 0) {
+    // appended by other processes, the shared lock keeps a partial tail from being truncated while it's scanned
+    if (store_sync(store, false) == 0) {
+      HASH_FIND(hh, store->index, id, STORE_ID_BYTES, elm);
+    }
+    flock(store->fd, LOCK_UN);
+  }
+  if (elm) {
+    // records appended after the last mapping
+    if (elm->offset + elm->len > store->map_len && store_remap(store, store->stats.file_size) != 0) {
+      elm = NULL;
+    }
+  }
+  if (elm && (json = malloc(elm->len + 1)) != NULL) {
+    memcpy(json, store->map + elm->offset, elm->len);
+    json[elm->len] = '\0';
+  }
+
+  if (json) {
+    store->stats.hits++;
+  } else {
+    store->stats.misses++;
+  }
+  pthread_mutex_unlock(&store->lock);
+  return json;
+}
+
+int cli_msg_store_put(cli_msg_store_t *store, char const msg_id[], char const json[], size_t len) {
+  rec_hdr_t rec = {.magic = REC_MAGIC};
+  store_idx_t *elm = NULL;
+  int ret = 0;
+
+  if (store == NULL || json == NULL || len > UINT32_MAX || id_from_hex(msg_id, rec.id) != 0) {
+    return -1;
+  }
+  rec.len = (uint32_t)len;
+  rec.crc = rec_crc(rec.id, (byte_t const *)json, len);
+
+  byte_t *buf = malloc(sizeof(rec_hdr_t) + len);
+  if (buf == NULL) {
+    return -1;
+  }
+  memcpy(buf, &rec, sizeof(rec_hdr_t));
+  memcpy(buf + sizeof(rec_hdr_t), json, len);
+
+  pthread_mutex_lock(&store->lock);
+  // records are appended at the end of the file with the exclusive lock, one process at a time
+  if (flock(store->fd, LOCK_EX) != 0) {
+    pthread_mutex_unlock(&store->lock);
+    free(buf);
+    return -1;
+  }
+  if (store_sync(store, true) != 0) {
+    ret = -1;
+    goto done;
+  }
+  HASH_FIND(hh, store->index, rec.id, STORE_ID_BYTES, elm);
+  // messages are immutable, nothing to update
+  if (elm == NULL) {
+    size_t offset = store->stats.file_size;
+    size_t n = sizeof(rec_hdr_t) + len;
+    if (pwrite(store->fd, buf, n, (off_t)offset) != (ssize_t)n) {
+      // roll back a partial record
+      if (ftruncate(store->fd, (off_t)offset) != 0) {
+        printf("[%s:%d] truncate store failed\n", __func__, __LINE__);
+      }
+      ret = -1;
+    } else {
+      store->stats.file_size += n;
+      ret = index_add(store, rec.id, offset + sizeof(rec_hdr_t), rec.len);
+    }
+  }
+done:
+  flock(store->fd, LOCK_UN);
+  pthread_mutex_unlock(&store->lock);
+
+  free(buf);
+  return ret;
+}
+
+char const *cli_msg_store_path(cli_msg_store_t const *store) { return store->path; }
+
+void cli_msg_store_stats(cli_msg_store_t *store, cli_msg_store_stats_t *stats) {
+  if (store == NULL) {
+    memset(stats, 0, sizeof(cli_msg_store_stats_t));
+    return;
+  }
+  pthread_mutex_lock(&store->lock);
+  memcpy(stats, &store->stats, sizeof(cli_msg_store_stats_t));
+  pthread_mutex_unlock(&store->lock);
+}
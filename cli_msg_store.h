@@ -0,0 +1,84 @@
+#ifndef __CLI_MSG_STORE_H__
+#define __CLI_MSG_STORE_H__
+
+#include <stddef.h>
+#include <stdint.h>
+
+typedef struct cli_msg_store cli_msg_store_t;
+
+/**
+ * @brief Message store statistics
+ *
+ */
+typedef struct {
+  uint64_t hits;
+  uint64_t misses;
+  size_t records;   /*!< number of records */
+  size_t file_size; /*!< size of the store file */
+  size_t truncated; /*!< bytes of a partial tail dropped at open */
+  size_t corrupted; /*!< bytes of corrupt records which are skipped */
+} cli_msg_store_stats_t;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Open or create an append-only message store
+ *
+ * The file is memory-mapped and indexed by message ID. Messages are immutable, a message is stored once and never
+ * rewritten. A partial tail record, e.g. from a crash, is truncated, corrupt records are skipped.
+ *
+ * @param path the path of the store file
+ * @return cli_msg_store_t* NULL on failed
+ */
+cli_msg_store_t *cli_msg_store_open(char const path[]);
+
+/**
+ * @brief Close the store
+ *
+ * @param store the store
+ */
+void cli_msg_store_close(cli_msg_store_t *store);
+
+/**
+ * @brief Get a message from the store
+ *
+ * @param store the store
+ * @param msg_id a hex string of the message ID
+ * @return char* a copy of the JSON response, the caller must free it. NULL if not found.
+ */
+char *cli_msg_store_get(cli_msg_store_t *store, char const msg_id[]);
+
+/**
+ * @brief Append a message to the store
+ *
+ * @param store the store
+ * @param msg_id a hex string of the message ID
+ * @param json the JSON response of the message
+ * @param len the length of the JSON response
+ * @return int 0 on success
+ */
+int cli_msg_store_put(cli_msg_store_t *store, char const msg_id[], char const json[], size_t len);
+
+/**
+ * @brief Get the path of the store file
+ *
+ * @param store the store
+ * @return char const* the path
+ */
+char const *cli_msg_store_path(cli_msg_store_t const *store);
+
+/**
+ * @brief Get a snapshot of the statistics
+ *
+ * @param store the store
+ * @param stats the output statistics
+ */
+void cli_msg_store_stats(cli_msg_store_t *store, cli_msg_store_stats_t *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // __CLI_MSG_STORE_H__
@@ -0,0 +1,400 @@
+#include <inttypes.h>
+#include <math.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "cli_out.h"
+
+// max nesting of a record
+#define OUT_DEPTH_MAX 16
+#define OUT_BUF_INIT 1024
+// flush buffered text early if a result is larger than it
+#define OUT_TEXT_FLUSH (64 * 1024)
+// release the text buffer at the end of a command if it grew larger than it
+#define OUT_TEXT_KEEP (256 * 1024)
+
+typedef struct {
+  cli_out_mode_t mode;
+  FILE *out;                  /*!< stdout of records, NULL in text mode */
+  int out_fd;                 /*!< the original stdout */
+  char *buf;                  /*!< the current record */
+  size_t len;                 /*!< length of the current record */
+  size_t cap;                 /*!< capacity of the record buffer */
+  bool oom;                   /*!< the current record is dropped */
+  int depth;                  /*!< nesting of the current record, 0 if no record is started */
+  int skipped;                /*!< nesting levels beyond OUT_DEPTH_MAX, they and their fields are dropped */
+  bool first[OUT_DEPTH_MAX];  /*!< no field is written at a nesting level */
+  char closer[OUT_DEPTH_MAX]; /*!< the closing bracket of a nesting level */
+  size_t records;             /*!< records of the current command */
+  char *text;                 /*!< buffered text of the current command */
+  size_t text_len;            /*!< length of the buffered text */
+  size_t text_cap;            /*!< capacity of the text buffer */
+  bool line_buffered;         /*!< flush text at every new line */
+} cli_out_t;
+
+static cli_out_t cli_out = {.mode = CLI_OUT_TEXT, .out_fd = -1};
+
+static void out_write(char const *s, size_t len) {
+  if (cli_out.oom) {
+    return;
+  }
+  if (cli_out.len + len + 1 > cli_out.cap) {
+    size_t cap = cli_out.cap ? cli_out.cap : OUT_BUF_INIT;
+    while (cli_out.len + len + 1 > cap) {
+      cap *= 2;
+    }
+    char *buf = realloc(cli_out.buf, cap);
+    if (buf == NULL) {
+      cli_out.oom = true;
+      return;
+    }
+    cli_out.buf = buf;
+    cli_out.cap = cap;
+  }
+  memcpy(cli_out.buf + cli_out.len, s, len);
+  cli_out.len += len;
+}
+
+static void out_puts(char const *s) { out_write(s, strlen(s)); }
+
+// length of a valid UTF-8 sequence at s, 0 if it's invalid, overlong or a surrogate
+static size_t utf8_len(unsigned char const *s) {
+  size_t n = s[0] >= 0xF0 ? 4 : s[0] >= 0xE0 ? 3 : 2;
+  if (s[0] < 0xC2 || s[0] > 0xF4) {
+    return 0;
+  }
+  for (size_t i = 1; i < n; i++) {
+    if ((s[i] & 0xC0) != 0x80) {
+      return 0;
+    }
+  }
+  if ((s[0] == 0xE0 && s[1] < 0xA0) || (s[0] == 0xED && s[1] > 0x9F) || (s[0] == 0xF0 && s[1] < 0x90) ||
+      (s[0] == 0xF4 && s[1] > 0x8F)) {
+    return 0;
+  }
+  return n;
+}
+
+static void out_quoted(char const *s) {
+  static char const hex[] = "0123456789abcdef";
+  out_write("\"", 1);
+  for (char const *p = s; *p; p++) {
+    unsigned char c = (unsigned char)*p;
+    if (c >= 0x80) {
+      // payloads are arbitrary bytes, an invalid sequence is replaced so the record stays valid JSON
+      size_t n = utf8_len((unsigned char const *)p);
+      if (n == 0) {
+        out_write("\\ufffd", 6);
+      } else {
+        out_write(p, n);
+        p += n - 1;
+      }
+    } else if (c == '"' || c == '\\') {
+      char esc[2] = {'\\', (char)c};
+      out_write(esc, 2);
+    } else if (c == '\n') {
+      out_write("\\n", 2);
+    } else if (c == '\r') {
+      out_write("\\r", 2);
+    } else if (c == '\t') {
+      out_write("\\t", 2);
+    } else if (c < 0x20) {
+      char esc[6] = {'\\', 'u', '0', '0', hex[c >> 4], hex[c & 0xF]};
+      out_write(esc, 6);
+    } else {
+      out_write((char const *)&c, 1);
+    }
+  }
+  out_write("\"", 1);
+}
+
+// write the separator and the key of a field
+static bool out_key(char const key[]) {
+  if (!cli_out_structured() || cli_out.depth == 0 || cli_out.skipped > 0) {
+    return false;
+  }
+  if (!cli_out.first[cli_out.depth]) {
+    out_write(",", 1);
+  }
+  cli_out.first[cli_out.depth] = false;
+  if (key) {
+    out_quoted(key);
+    out_write(":", 1);
+  }
+  return true;
+}
+
+static void out_open(char const key[], char open, char close) {
+  if (cli_out_structured() && cli_out.depth > 0 && (cli_out.skipped > 0 || cli_out.depth + 1 >= OUT_DEPTH_MAX)) {
+    // the matching close is ignored
+    cli_out.skipped++;
+    return;
+  }
+  if (!out_key(key)) {
+    return;
+  }
+  out_write(&open, 1);
+  cli_out.depth++;
+  cli_out.first[cli_out.depth] = true;
+  cli_out.closer[cli_out.depth] = close;
+}
+
+static void out_close() {
+  if (cli_out.skipped > 0) {
+    cli_out.skipped--;
+    return;
+  }
+  if (cli_out_structured() && cli_out.depth > 1) {
+    out_write(&cli_out.closer[cli_out.depth], 1);
+    cli_out.depth--;
+  }
+}
+
+int cli_out_mode_parse(char const name[], cli_out_mode_t *mode) {
+  if (strcmp(name, "text") == 0) {
+    *mode = CLI_OUT_TEXT;
+  } else if (strcmp(name, "json") == 0) {
+    *mode = CLI_OUT_JSON;
+  } else if (strcmp(name, "ndjson") == 0) {
+    *mode = CLI_OUT_NDJSON;
+  } else {
+    return -1;
+  }
+  return 0;
+}
+
+int cli_out_set_mode(cli_out_mode_t mode) {
+  bool structured = mode != CLI_OUT_TEXT;
+  if (structured == cli_out_structured()) {
+    cli_out.mode = mode;
+    return 0;
+  }
+
+  fflush(stdout);
+  if (structured) {
+    // records go to the original stdout, text goes to stderr
+    int fd = dup(STDOUT_FILENO);
+    if (fd < 0) {
+      return -1;
+    }
+    FILE *out = fdopen(fd, "w");
+    if (out == NULL || dup2(STDERR_FILENO, STDOUT_FILENO) < 0) {
+      if (out) {
+        fclose(out);
+      } else {
+        close(fd);
+      }
+      return -1;
+    }
+    cli_out.out = out;
+    cli_out.out_fd = fd;
+  } else {
+    fflush(cli_out.out);
+    if (dup2(cli_out.out_fd, STDOUT_FILENO) < 0) {
+      return -1;
+    }
+    fclose(cli_out.out);
+    cli_out.out = NULL;
+    cli_out.out_fd = -1;
+  }
+  cli_out.mode = mode;
+  return 0;
+}
+
+cli_out_mode_t cli_out_mode() { return cli_out.mode; }
+
+bool cli_out_structured() { return cli_out.mode != CLI_OUT_TEXT && cli_out.out != NULL; }
+
+FILE *cli_out_set_record_stream(FILE *fp) {
+  if (!cli_out_structured() || fp == NULL) {
+    return NULL;
+  }
+  FILE *prev = cli_out.out;
+  fflush(prev);
+  cli_out.out = fp;
+  return prev;
+}
+
+void cli_out_command_begin() { cli_out.records = 0; }
+
+void cli_out_command_end() {
+  cli_out_flush();
+  if (cli_out.text_cap > OUT_TEXT_KEEP) {
+    free(cli_out.text);
+    cli_out.text = NULL;
+    cli_out.text_cap = 0;
+  }
+  if (!cli_out_structured()) {
+    return;
+  }
+  if (cli_out.mode == CLI_OUT_JSON) {
+    // an array per command, even if it's empty
+    fputs(cli_out.records ? "\n]\n" : "[]\n", cli_out.out);
+  }
+  fflush(cli_out.out);
+  // text goes to stderr in the meantime
+  fflush(stdout);
+}
+
+void cli_out_record_begin(char const type[]) {
+  if (!cli_out_structured()) {
+    return;
+  }
+  cli_out.len = 0;
+  cli_out.oom = false;
+  cli_out.depth = 1;
+  cli_out.skipped = 0;
+  cli_out.first[1] = true;
+  out_write("{", 1);
+  cli_out_str("type", type);
+}
+
+void cli_out_record_end() {
+  if (!cli_out_structured() || cli_out.depth == 0) {
+    return;
+  }
+  // close unbalanced fields
+  cli_out.skipped = 0;
+  while (cli_out.depth > 1) {
+    out_close();
+  }
+  out_write("}", 1);
+  cli_out.depth = 0;
+  if (cli_out.oom) {
+    fprintf(stderr, "[%s:%d] record is dropped, out of memory\n", __func__, __LINE__);
+    return;
+  }
+
+  if (cli_out.mode == CLI_OUT_JSON) {
+    fputs(cli_out.records ? ",\n" : "[\n", cli_out.out);
+  }
+  fwrite(cli_out.buf, 1, cli_out.len, cli_out.out);
+  if (cli_out.mode == CLI_OUT_NDJSON) {
+    fputc('\n', cli_out.out);
+  }
+  cli_out.records++;
+}
+
+void cli_out_str(char const key[], char const val[]) {
+  if (out_key(key)) {
+    if (val) {
+      out_quoted(val);
+    } else {
+      out_puts("null");
+    }
+  }
+}
+
+void cli_out_u64(char const key[], uint64_t val) {
+  char num[24];
+  if (out_key(key)) {
+    snprintf(num, sizeof(num), "%" PRIu64, val);
+    out_puts(num);
+  }
+}
+
+void cli_out_i64(char const key[], int64_t val) {
+  char num[24];
+  if (out_key(key)) {
+    snprintf(num, sizeof(num), "%" PRId64, val);
+    out_puts(num);
+  }
+}
+
+void cli_out_double(char const key[], double val) {
+  char num[32];
+  if (out_key(key)) {
+    // JSON has no NaN or infinity
+    if (isfinite(val)) {
+      snprintf(num, sizeof(num), "%.10g", val);
+      out_puts(num);
+    } else {
+      out_puts("null");
+    }
+  }
+}
+
+void cli_out_bool(char const key[], bool val) {
+  if (out_key(key)) {
+    out_puts(val ? "true" : "false");
+  }
+}
+
+void cli_out_array_begin(char const key[]) { out_open(key, '[', ']'); }
+
+void cli_out_array_end() { out_close(); }
+
+void cli_out_object_begin(char const key[]) { out_open(key, '{', '}'); }
+
+void cli_out_object_end() { out_close(); }
+
+static bool text_reserve(size_t len) {
+  if (cli_out.text_len + len + 1 <= cli_out.text_cap) {
+    return true;
+  }
+  size_t cap = cli_out.text_cap ? cli_out.text_cap : OUT_BUF_INIT;
+  while (cli_out.text_len + len + 1 > cap) {
+    cap *= 2;
+  }
+  char *text = realloc(cli_out.text, cap);
+  if (text == NULL) {
+    return false;
+  }
+  cli_out.text = text;
+  cli_out.text_cap = cap;
+  return true;
+}
+
+void cli_out_printf(char const *fmt, ...) {
+  va_list ap;
+  size_t room = cli_out.text_cap - cli_out.text_len;
+
+  va_start(ap, fmt);
+  int n = room ? vsnprintf(cli_out.text + cli_out.text_len, room, fmt, ap) : -1;
+  va_end(ap);
+  if (n < 0 || (size_t)n >= room) {
+    if (n < 0) {
+      va_start(ap, fmt);
+      n = vsnprintf(NULL, 0, fmt, ap);
+      va_end(ap);
+    }
+    if (n < 0) {
+      return;
+    }
+    if (!text_reserve((size_t)n)) {
+      // keep the order of the text and write it directly
+      cli_out_flush();
+      va_start(ap, fmt);
+      vprintf(fmt, ap);
+      va_end(ap);
+      return;
+    }
+    va_start(ap, fmt);
+    vsnprintf(cli_out.text + cli_out.text_len, cli_out.text_cap - cli_out.text_len, fmt, ap);
+    va_end(ap);
+  }
+  cli_out.text_len += (size_t)n;
+
+  if (cli_out.text_len >= OUT_TEXT_FLUSH ||
+      (cli_out.line_buffered && cli_out.text_len > 0 && cli_out.text[cli_out.text_len - 1] == '\n')) {
+    cli_out_flush();
+  }
+}
+
+void cli_out_flush() {
+  if (cli_out.text_len > 0) {
+    fwrite(cli_out.text, 1, cli_out.text_len, stdout);
+    cli_out.text_len = 0;
+  }
+  fflush(stdout);
+}
+
+void cli_out_set_line_buffered(bool on) {
+  cli_out_flush();
+  cli_out.line_buffered = on;
+}
+
+bool cli_out_line_buffered() { return cli_out.line_buffered; }
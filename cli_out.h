@@ -0,0 +1,191 @@
+#ifndef __CLI_OUT_H__
+#define __CLI_OUT_H__
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+/**
+ * @brief Output modes
+ *
+ */
+typedef enum {
+  CLI_OUT_TEXT = 0, /*!< human readable text */
+  CLI_OUT_JSON,     /*!< a JSON array of records per command */
+  CLI_OUT_NDJSON,   /*!< a JSON record per line */
+} cli_out_mode_t;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Parse the name of an output mode
+ *
+ * @param name text, json or ndjson
+ * @param mode the output mode
+ * @return int 0 on success
+ */
+int cli_out_mode_parse(char const name[], cli_out_mode_t *mode);
+
+/**
+ * @brief Switch the output mode
+ *
+ * In JSON modes, records are written to the original stdout and the human readable text printed by commands is
+ * redirected to stderr, so stdout carries records only.
+ *
+ * @param mode the output mode
+ * @return int 0 on success
+ */
+int cli_out_set_mode(cli_out_mode_t mode);
+
+/**
+ * @brief Get the output mode
+ *
+ * @return cli_out_mode_t
+ */
+cli_out_mode_t cli_out_mode();
+
+/**
+ * @brief Check if commands should output records instead of text
+ *
+ * @return true in JSON modes
+ */
+bool cli_out_structured();
+
+/**
+ * @brief Replace the stream of records in JSON modes, the daemon captures records of a command this way
+ *
+ * @param fp the new stream
+ * @return FILE* the previous stream, NULL in text mode
+ */
+FILE *cli_out_set_record_stream(FILE *fp);
+
+/**
+ * @brief Start the output of a command, it's called before running a command
+ *
+ */
+void cli_out_command_begin();
+
+/**
+ * @brief End the output of a command and flush buffered text and records, it's called after running a command
+ *
+ */
+void cli_out_command_end();
+
+/**
+ * @brief Start a record, records are written one by one, a command could stream any number of records
+ *
+ * @param type the type of the record, it's the "type" field
+ */
+void cli_out_record_begin(char const type[]);
+
+/**
+ * @brief End and write out the record
+ *
+ */
+void cli_out_record_end();
+
+/**
+ * @brief Add a string field, the key is NULL for array elements
+ *
+ * @param key the field name
+ * @param val the string, NULL for null
+ */
+void cli_out_str(char const key[], char const val[]);
+
+/**
+ * @brief Add an unsigned integer field
+ *
+ * @param key the field name
+ * @param val the value
+ */
+void cli_out_u64(char const key[], uint64_t val);
+
+/**
+ * @brief Add a signed integer field
+ *
+ * @param key the field name
+ * @param val the value
+ */
+void cli_out_i64(char const key[], int64_t val);
+
+/**
+ * @brief Add a number field
+ *
+ * @param key the field name
+ * @param val the value
+ */
+void cli_out_double(char const key[], double val);
+
+/**
+ * @brief Add a boolean field
+ *
+ * @param key the field name
+ * @param val the value
+ */
+void cli_out_bool(char const key[], bool val);
+
+/**
+ * @brief Start an array field, ended by cli_out_array_end
+ *
+ * @param key the field name
+ */
+void cli_out_array_begin(char const key[]);
+
+/**
+ * @brief End an array field
+ *
+ */
+void cli_out_array_end();
+
+/**
+ * @brief Start an object field, ended by cli_out_object_end
+ *
+ * @param key the field name
+ */
+void cli_out_object_begin(char const key[]);
+
+/**
+ * @brief End an object field
+ *
+ */
+void cli_out_object_end();
+
+/**
+ * @brief Format text into the output buffer
+ *
+ * A result is formatted into a reusable buffer and written out at once by cli_out_flush, instead of a write per
+ * field. Text printed by printf in the meantime comes out before the buffered text.
+ *
+ * @param fmt the printf format
+ * @param ... arguments of the format
+ */
+void cli_out_printf(char const *fmt, ...) __attribute__((format(printf, 1, 2)));
+
+/**
+ * @brief Write out the buffered text
+ *
+ */
+void cli_out_flush();
+
+/**
+ * @brief Flush the buffered text at every new line, for interactive use
+ *
+ * @param on true for line buffered, false to flush at the end of a command
+ */
+void cli_out_set_line_buffered(bool on);
+
+/**
+ * @brief Check if the text output is line buffered
+ *
+ * @return true if line buffered
+ */
+bool cli_out_line_buffered();
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // __CLI_OUT_H__
@@ -0,0 +1,187 @@
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "cli_parallel.h"
+
+typedef struct {
+  pthread_mutex_t lock;
+  size_t count;   /*!< number of tasks */
+  size_t next;    /*!< the next task to run */
+  size_t emitted; /*!< number of emitted results */
+  bool stop;      /*!< stop pending tasks */
+  bool *done;     /*!< completed tasks */
+  cli_task_fn_t task;
+  cli_emit_fn_t emit;
+  void *ctx;
+} parallel_t;
+
+static void *parallel_worker(void *arg) {
+  parallel_t *p = (parallel_t *)arg;
+
+  for (;;) {
+    pthread_mutex_lock(&p->lock);
+    size_t idx = p->next;
+    if (p->stop || idx >= p->count) {
+      pthread_mutex_unlock(&p->lock);
+      break;
+    }
+    p->next++;
+    pthread_mutex_unlock(&p->lock);
+
+    p->task(p->ctx, idx);
+
+    pthread_mutex_lock(&p->lock);
+    p->done[idx] = true;
+    // emit completed results in order
+    while (!p->stop && p->emitted < p->count && p->done[p->emitted]) {
+      if (p->emit && !p->emit(p->ctx, p->emitted)) {
+        p->stop = true;
+      }
+      p->emitted++;
+    }
+    pthread_mutex_unlock(&p->lock);
+  }
+  return NULL;
+}
+
+size_t cli_parallel_for(size_t count, size_t workers, cli_task_fn_t task, cli_emit_fn_t emit, void *ctx) {
+  if (count == 0 || task == NULL) {
+    return 0;
+  }
+
+  parallel_t p = {.count = count, .task = task, .emit = emit, .ctx = ctx};
+  if ((p.done = calloc(count, sizeof(bool))) == NULL) {
+    return 0;
+  }
+  pthread_mutex_init(&p.lock, NULL);
+
+  if (workers == 0) {
+    workers = 1;
+  }
+  if (workers > count) {
+    workers = count;
+  }
+
+  pthread_t *threads = NULL;
+  size_t created = 0;
+  if (workers > 1 && (threads = calloc(workers - 1, sizeof(pthread_t))) != NULL) {
+    for (; created < workers - 1; created++) {
+      if (pthread_create(&threads[created], NULL, parallel_worker, &p) != 0) {
+        // run on fewer threads
+        break;
+      }
+    }
+  }
+
+  // the calling thread is a worker too
+  parallel_worker(&p);
+
+  for (size_t i = 0; i < created; i++) {
+    pthread_join(threads[i], NULL);
+  }
+
+  free(threads);
+  free(p.done);
+  pthread_mutex_destroy(&p.lock);
+  return p.emitted;
+}
+
+typedef struct {
+  pthread_mutex_t lock;
+  pthread_cond_t cond;
+  size_t slots;   /*!< number of slots */
+  size_t next;    /*!< sequence number of the next task */
+  size_t emitted; /*!< number of emitted results */
+  bool end;       /*!< the stream is ended */
+  bool stop;      /*!< stop pending tasks */
+  bool *done;     /*!< completed tasks of slots */
+  cli_fetch_fn_t fetch;
+  cli_task_fn_t task;
+  cli_emit_fn_t emit;
+  void *ctx;
+} stream_t;
+
+static void *stream_worker(void *arg) {
+  stream_t *p = (stream_t *)arg;
+
+  pthread_mutex_lock(&p->lock);
+  for (;;) {
+    // the slot of the next task is busy until its result is emitted
+    while (!p->stop && !p->end && p->next - p->emitted >= p->slots) {
+      pthread_cond_wait(&p->cond, &p->lock);
+    }
+    if (p->stop || p->end) {
+      break;
+    }
+    size_t slot = p->next % p->slots;
+    if (!p->fetch(p->ctx, slot)) {
+      p->end = true;
+      pthread_cond_broadcast(&p->cond);
+      break;
+    }
+    p->next++;
+    pthread_mutex_unlock(&p->lock);
+
+    p->task(p->ctx, slot);
+
+    pthread_mutex_lock(&p->lock);
+    p->done[slot] = true;
+    // emit completed results in order, their slots are free again
+    while (!p->stop && p->emitted < p->next && p->done[p->emitted % p->slots]) {
+      slot = p->emitted % p->slots;
+      if (p->emit && !p->emit(p->ctx, slot)) {
+        p->stop = true;
+      }
+      p->done[slot] = false;
+      p->emitted++;
+    }
+    pthread_cond_broadcast(&p->cond);
+  }
+  pthread_mutex_unlock(&p->lock);
+  return NULL;
+}
+
+size_t cli_parallel_stream(size_t workers, size_t slots, cli_fetch_fn_t fetch, cli_task_fn_t task, cli_emit_fn_t emit,
+                           void *ctx) {
+  if (fetch == NULL || task == NULL) {
+    return 0;
+  }
+  if (workers == 0) {
+    workers = 1;
+  }
+  if (slots < workers) {
+    slots = workers;
+  }
+
+  stream_t p = {.slots = slots, .fetch = fetch, .task = task, .emit = emit, .ctx = ctx};
+  if ((p.done = calloc(slots, sizeof(bool))) == NULL) {
+    return 0;
+  }
+  pthread_mutex_init(&p.lock, NULL);
+  pthread_cond_init(&p.cond, NULL);
+
+  pthread_t *threads = NULL;
+  size_t created = 0;
+  if (workers > 1 && (threads = calloc(workers - 1, sizeof(pthread_t))) != NULL) {
+    for (; created < workers - 1; created++) {
+      if (pthread_create(&threads[created], NULL, stream_worker, &p) != 0) {
+        // run on fewer threads
+        break;
+      }
+    }
+  }
+
+  // the calling thread is a worker too
+  stream_worker(&p);
+
+  for (size_t i = 0; i < created; i++) {
+    pthread_join(threads[i], NULL);
+  }
+
+  free(threads);
+  free(p.done);
+  pthread_cond_destroy(&p.cond);
+  pthread_mutex_destroy(&p.lock);
+  return p.emitted;
+}
@@ -0,0 +1,76 @@
+#ifndef __CLI_PARALLEL_H__
+#define __CLI_PARALLEL_H__
+
+#include <stdbool.h>
+#include <stddef.h>
+
+/**
+ * @brief A task on a worker thread
+ *
+ * @param ctx the user context
+ * @param idx the index of the task
+ */
+typedef void (*cli_task_fn_t)(void *ctx, size_t idx);
+
+/**
+ * @brief Emit the result of a completed task
+ *
+ * Emit callbacks are serialized and in index order, it's safe to print out from here.
+ *
+ * @param ctx the user context
+ * @param idx the index of the task
+ * @return true to continue, false to stop pending tasks
+ */
+typedef bool (*cli_emit_fn_t)(void *ctx, size_t idx);
+
+/**
+ * @brief Fetch the next task of a stream into a slot, it's serialized with the other callbacks of the stream
+ *
+ * @param ctx the user context
+ * @param slot the slot of the task, it's reused once the result is emitted
+ * @return true if a task is fetched, false at the end of the stream
+ */
+typedef bool (*cli_fetch_fn_t)(void *ctx, size_t slot);
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Run tasks [0, count) on a bounded pool of worker threads
+ *
+ * The calling thread is one of the workers. A result is emitted as soon as the tasks before it are completed, so
+ * results come out in index order while the tasks are completed in any order.
+ *
+ * @param count the number of tasks
+ * @param workers the max number of concurrent tasks
+ * @param task the task callback
+ * @param emit the emit callback, can be NULL
+ * @param ctx the user context
+ * @return size_t the number of emitted results
+ */
+size_t cli_parallel_for(size_t count, size_t workers, cli_task_fn_t task, cli_emit_fn_t emit, void *ctx);
+
+/**
+ * @brief Run tasks of a stream on a bounded pool of worker threads
+ *
+ * A free worker fetches the next task at once, so workers tasks stay in flight until the end of the stream. Results
+ * are emitted in fetch order, a task is fetched only if its slot is emitted, so a slow task stalls the stream after
+ * slots tasks at most. Tasks and emits get the slot as the index.
+ *
+ * @param workers the max number of concurrent tasks
+ * @param slots the number of slots, at least workers
+ * @param fetch the fetch callback
+ * @param task the task callback
+ * @param emit the emit callback, can be NULL
+ * @param ctx the user context
+ * @return size_t the number of emitted results
+ */
+size_t cli_parallel_stream(size_t workers, size_t slots, cli_fetch_fn_t fetch, cli_task_fn_t task, cli_emit_fn_t emit,
+                           void *ctx);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // __CLI_PARALLEL_H__
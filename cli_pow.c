@@ -0,0 +1,312 @@
+#include <math.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "cli_pow.h"
+#include "crypto/iota_crypto.h"
+
+// Curl-P-81
+#define CURL_HASH_TRITS 243
+#define CURL_STATE_TRITS (CURL_HASH_TRITS * 3)
+#define CURL_ROUNDS 81
+
+// b1t6 encodes a byte into 6 trits
+#define B1T6_TRITS 6
+#define DIGEST_TRITS (CLI_POW_DIGEST_BYTES * B1T6_TRITS)
+#define NONCE_TRITS (CLI_POW_NONCE_BYTES * B1T6_TRITS)
+
+// hashes are bit-sliced, a state word holds a trit of 64 nonces
+#define POW_LANES 64
+
+/*
+ * A bit-sliced state, a trit is a pair of bits in lo and hi:
+ * -1 is (1, 0), 0 is (1, 1) and 1 is (0, 1).
+ */
+typedef struct {
+  uint64_t lo[CURL_STATE_TRITS];
+  uint64_t hi[CURL_STATE_TRITS];
+} curl_bct_t;
+
+typedef struct {
+  int8_t trits[CURL_HASH_TRITS]; /*!< digest and padding trits, nonce trits are filled by workers */
+  unsigned target_zeros;
+  size_t threads;
+  int found; /*!< set by the first thread finding a nonce */
+  uint64_t nonce;
+  uint64_t hashes;
+  pthread_mutex_t lock;
+} pow_search_t;
+
+typedef struct {
+  pow_search_t *search;
+  size_t id;
+} pow_worker_t;
+
+static uint16_t curl_index[CURL_STATE_TRITS + 1];
+static pthread_once_t curl_once = PTHREAD_ONCE_INIT;
+
+static void curl_index_init() {
+  size_t idx = 0;
+  for (size_t i = 0; i <= CURL_STATE_TRITS; i++) {
+    curl_index[i] = (uint16_t)idx;
+    idx = idx < 365 ? idx + 364 : idx - 365;
+  }
+}
+
+static void curl_bct_transform(curl_bct_t *state) {
+  curl_bct_t scratch;
+  curl_bct_t *from = state, *to = &scratch;
+
+  for (int r = 0; r < CURL_ROUNDS; r++) {
+    for (size_t i = 0; i < CURL_STATE_TRITS; i++) {
+      uint64_t alpha = from->lo[curl_index[i]];
+      uint64_t beta = from->hi[curl_index[i]];
+      uint64_t gamma = from->hi[curl_index[i + 1]];
+      uint64_t delta = (alpha | ~gamma) & (from->lo[curl_index[i + 1]] ^ beta);
+      to->lo[i] = ~delta;
+      to->hi[i] = (alpha ^ gamma) | delta;
+    }
+    curl_bct_t *tmp = from;
+    from = to;
+    to = tmp;
+  }
+  // an odd number of rounds ends in the scratch
+  memcpy(state, from, sizeof(curl_bct_t));
+}
+
+static void trit_set(curl_bct_t *state, size_t i, uint64_t lanes, int8_t trit) {
+  if (trit <= 0) {
+    state->lo[i] |= lanes;
+  }
+  if (trit >= 0) {
+    state->hi[i] |= lanes;
+  }
+}
+
+// b1t6 encoding, a byte is two balanced trytes of 3 trits
+static void b1t6_encode(uint8_t const bytes[], size_t len, int8_t trits[]) {
+  for (size_t i = 0; i < len; i++) {
+    int v = (int8_t)bytes[i] + 364;
+    int trytes[2] = {v % 27 - 13, v / 27 - 13};
+    for (int t = 0; t < 2; t++) {
+      int x = trytes[t];
+      for (int k = 0; k < 3; k++) {
+        int rem = ((x % 3) + 3) % 3;
+        int8_t trit = rem == 2 ? -1 : (int8_t)rem;
+        trits[i * B1T6_TRITS + t * 3 + k] = trit;
+        x = (x - trit) / 3;
+      }
+    }
+  }
+}
+
+static void nonce_bytes(uint64_t nonce, uint8_t out[]) {
+  for (int i = 0; i < CLI_POW_NONCE_BYTES; i++) {
+    out[i] = (uint8_t)(nonce >> (8 * i));
+  }
+}
+
+// hash nonces [base, base + POW_LANES) and return lanes with enough trailing zeros
+static uint64_t pow_try(int8_t const trits[], uint64_t base, unsigned target_zeros, curl_bct_t *state) {
+  memset(state, 0, sizeof(curl_bct_t));
+  for (size_t i = 0; i < DIGEST_TRITS; i++) {
+    trit_set(state, i, ~0ULL, trits[i]);
+  }
+  for (size_t i = DIGEST_TRITS + NONCE_TRITS; i < CURL_STATE_TRITS; i++) {
+    // padding and the rest of the state are zero trits
+    state->lo[i] = state->hi[i] = ~0ULL;
+  }
+  for (int lane = 0; lane < POW_LANES; lane++) {
+    uint8_t nonce[CLI_POW_NONCE_BYTES];
+    int8_t nonce_trits[NONCE_TRITS];
+    nonce_bytes(base + (uint64_t)lane, nonce);
+    b1t6_encode(nonce, CLI_POW_NONCE_BYTES, nonce_trits);
+    for (size_t i = 0; i < NONCE_TRITS; i++) {
+      trit_set(state, DIGEST_TRITS + i, 1ULL << lane, nonce_trits[i]);
+    }
+  }
+
+  curl_bct_transform(state);
+
+  uint64_t lanes = ~0ULL;
+  for (unsigned i = 0; i < target_zeros && lanes; i++) {
+    size_t t = CURL_HASH_TRITS - 1 - i;
+    lanes &= state->lo[t] & state->hi[t];
+  }
+  return lanes;
+}
+
+static void *pow_worker(void *arg) {
+  pow_worker_t *w = (pow_worker_t *)arg;
+  pow_search_t *s = w->search;
+  curl_bct_t *state = malloc(sizeof(curl_bct_t));
+  uint64_t hashes = 0;
+
+  if (state == NULL) {
+    return NULL;
+  }
+
+  // workers interleave batches of nonces
+  uint64_t base = (uint64_t)w->id * POW_LANES;
+  uint64_t step = (uint64_t)s->threads * POW_LANES;
+  while (!__atomic_load_n(&s->found, __ATOMIC_ACQUIRE)) {
+    uint64_t lanes = pow_try(s->trits, base, s->target_zeros, state);
+    hashes += POW_LANES;
+    if (lanes) {
+      pthread_mutex_lock(&s->lock);
+      if (!s->found) {
+        s->nonce = base + (uint64_t)__builtin_ctzll(lanes);
+        __atomic_store_n(&s->found, 1, __ATOMIC_RELEASE);
+      }
+      pthread_mutex_unlock(&s->lock);
+      break;
+    }
+    base += step;
+  }
+
+  pthread_mutex_lock(&s->lock);
+  s->hashes += hashes;
+  pthread_mutex_unlock(&s->lock);
+  free(state);
+  return NULL;
+}
+
+// count trailing zero trits of the hash of a nonce on a single lane
+static unsigned trailing_zeros(uint8_t const digest[], uint64_t nonce) {
+  int8_t trits[CURL_HASH_TRITS] = {};
+  uint8_t nonce_buf[CLI_POW_NONCE_BYTES];
+  unsigned zeros = 0;
+
+  curl_bct_t *state = calloc(1, sizeof(curl_bct_t));
+  if (state == NULL) {
+    return 0;
+  }
+  b1t6_encode(digest, CLI_POW_DIGEST_BYTES, trits);
+  nonce_bytes(nonce, nonce_buf);
+  b1t6_encode(nonce_buf, CLI_POW_NONCE_BYTES, trits + DIGEST_TRITS);
+  for (size_t i = 0; i < CURL_STATE_TRITS; i++) {
+    trit_set(state, i, 1ULL, i < CURL_HASH_TRITS ? trits[i] : 0);
+  }
+
+  curl_bct_transform(state);
+  while (zeros < CURL_HASH_TRITS) {
+    size_t t = CURL_HASH_TRITS - 1 - zeros;
+    if (!(state->lo[t] & state->hi[t] & 1ULL)) {
+      break;
+    }
+    zeros++;
+  }
+  free(state);
+  return zeros;
+}
+
+unsigned cli_pow_target_zeros(uint64_t min_score, size_t msg_len) {
+  if (min_score == 0) {
+    return 0;
+  }
+  // the smallest zeros that 3^zeros >= min_score * msg_len
+  double target = (double)min_score * (double)msg_len;
+  double v = 1.0;
+  unsigned zeros = 0;
+  while (v < target && zeros < CURL_HASH_TRITS) {
+    v *= 3.0;
+    zeros++;
+  }
+  return zeros;
+}
+
+int cli_pow_search(uint8_t const digest[], unsigned target_zeros, size_t threads, cli_pow_result_t *res) {
+  if (digest == NULL || res == NULL || target_zeros > CURL_HASH_TRITS) {
+    return -1;
+  }
+  pthread_once(&curl_once, curl_index_init);
+
+  if (threads == 0) {
+    long n = sysconf(_SC_NPROCESSORS_ONLN);
+    threads = n > 0 ? (size_t)n : 1;
+  }
+
+  pow_search_t s = {.target_zeros = target_zeros, .threads = threads};
+  b1t6_encode(digest, CLI_POW_DIGEST_BYTES, s.trits);
+  pthread_mutex_init(&s.lock, NULL);
+
+  pow_worker_t *workers = calloc(threads, sizeof(pow_worker_t));
+  pthread_t *tids = calloc(threads, sizeof(pthread_t));
+  if (workers == NULL || tids == NULL) {
+    free(workers);
+    free(tids);
+    pthread_mutex_destroy(&s.lock);
+    return -1;
+  }
+
+  struct timespec ts_start, ts_end;
+  clock_gettime(CLOCK_MONOTONIC, &ts_start);
+  size_t created = 0;
+  for (size_t i = 1; i < threads; i++) {
+    workers[i] = (pow_worker_t){.search = &s, .id = i};
+    if (pthread_create(&tids[created], NULL, pow_worker, &workers[i]) != 0) {
+      break;
+    }
+    created++;
+  }
+  // nonces of threads failed to start are not searched, keep the stride anyway
+  workers[0] = (pow_worker_t){.search = &s, .id = 0};
+  pow_worker(&workers[0]);
+  for (size_t i = 0; i < created; i++) {
+    pthread_join(tids[i], NULL);
+  }
+  clock_gettime(CLOCK_MONOTONIC, &ts_end);
+
+  memset(res, 0, sizeof(cli_pow_result_t));
+  res->threads = created + 1;
+  res->hashes = s.hashes;
+  res->elapsed = (ts_end.tv_sec - ts_start.tv_sec) + (ts_end.tv_nsec - ts_start.tv_nsec) / 1e9;
+  int ret = -1;
+  if (s.found) {
+    res->nonce = s.nonce;
+    res->zeros = trailing_zeros(digest, s.nonce);
+    ret = res->zeros >= target_zeros ? 0 : -1;
+  }
+
+  free(workers);
+  free(tids);
+  pthread_mutex_destroy(&s.lock);
+  return ret;
+}
+
+int cli_pow_message(uint8_t msg[], size_t msg_len, uint64_t min_score, size_t threads, cli_pow_result_t *res) {
+  uint8_t digest[CLI_POW_DIGEST_BYTES];
+
+  if (msg == NULL || msg_len <= CLI_POW_NONCE_BYTES) {
+    return -1;
+  }
+  if (iota_blake2b_sum(msg, msg_len - CLI_POW_NONCE_BYTES, digest, sizeof(digest)) != 0) {
+    return -1;
+  }
+  if (cli_pow_search(digest, cli_pow_target_zeros(min_score, msg_len), threads, res) != 0) {
+    return -1;
+  }
+  nonce_bytes(res->nonce, msg + msg_len - CLI_POW_NONCE_BYTES);
+  return 0;
+}
+
+double cli_pow_score(uint8_t const msg[], size_t msg_len) {
+  uint8_t digest[CLI_POW_DIGEST_BYTES];
+  uint64_t nonce = 0;
+
+  if (msg == NULL || msg_len <= CLI_POW_NONCE_BYTES) {
+    return 0;
+  }
+  if (iota_blake2b_sum(msg, msg_len - CLI_POW_NONCE_BYTES, digest, sizeof(digest)) != 0) {
+    return 0;
+  }
+  pthread_once(&curl_once, curl_index_init);
+  for (int i = 0; i < CLI_POW_NONCE_BYTES; i++) {
+    nonce |= (uint64_t)msg[msg_len - CLI_POW_NONCE_BYTES + i] << (8 * i);
+  }
+  return pow(3.0, trailing_zeros(digest, nonce)) / (double)msg_len;
+}
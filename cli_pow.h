@@ -0,0 +1,77 @@
+#ifndef __CLI_POW_H__
+#define __CLI_POW_H__
+
+#include <stddef.h>
+#include <stdint.h>
+
+// bytes of the nonce at the end of a message
+#define CLI_POW_NONCE_BYTES 8
+// bytes of the PoW digest
+#define CLI_POW_DIGEST_BYTES 32
+
+/**
+ * @brief Result of a nonce search
+ *
+ */
+typedef struct {
+  uint64_t nonce;  /*!< the found nonce */
+  unsigned zeros;  /*!< trailing zero trits of the Curl-P-81 hash */
+  uint64_t hashes; /*!< number of hashes computed by all threads */
+  size_t threads;  /*!< number of search threads */
+  double elapsed;  /*!< search time in seconds */
+} cli_pow_result_t;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Get the number of trailing zero trits required by a PoW score
+ *
+ * The PoW score of a message is 3^zeros / message_length.
+ *
+ * @param min_score the min PoW score of the node
+ * @param msg_len the length of the message including the nonce
+ * @return unsigned the number of trailing zero trits
+ */
+unsigned cli_pow_target_zeros(uint64_t min_score, size_t msg_len);
+
+/**
+ * @brief Search a nonce for a PoW digest
+ *
+ * Nonces are searched by all threads, the search stops as soon as a thread finds a nonce.
+ *
+ * @param digest the BLAKE2b-256 digest of the message without the nonce, CLI_POW_DIGEST_BYTES
+ * @param target_zeros the number of trailing zero trits
+ * @param threads the number of threads, 0 for the number of CPUs
+ * @param res the search result
+ * @return int 0 on success
+ */
+int cli_pow_search(uint8_t const digest[], unsigned target_zeros, size_t threads, cli_pow_result_t *res);
+
+/**
+ * @brief Do PoW on a serialized message and write the nonce to its last CLI_POW_NONCE_BYTES bytes
+ *
+ * @param msg the serialized message
+ * @param msg_len the length of the message including the nonce
+ * @param min_score the min PoW score, nothing to do if it's 0
+ * @param threads the number of threads, 0 for the number of CPUs
+ * @param res the search result
+ * @return int 0 on success
+ */
+int cli_pow_message(uint8_t msg[], size_t msg_len, uint64_t min_score, size_t threads, cli_pow_result_t *res);
+
+/**
+ * @brief Compute the PoW score of a serialized message
+ *
+ * @param msg the serialized message
+ * @param msg_len the length of the message including the nonce
+ * @return double the PoW score, 0 on failed
+ */
+double cli_pow_score(uint8_t const msg[], size_t msg_len);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // __CLI_POW_H__
@@ -0,0 +1,148 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include "cli_resp_cache.h"
+#include "uthash.h"
+
+// a hex output ID is the longest key
+#define RESP_ID_MAX 72
+
+typedef struct {
+  uint32_t kind;
+  char id[RESP_ID_MAX];
+} resp_key_t;
+
+struct cli_resp_entry {
+  resp_key_t key;
+  char *json;
+  size_t len;
+  UT_hash_handle hh;
+};
+
+static int make_key(resp_key_t *key, cli_resp_kind_t kind, char const id[]) {
+  size_t len = strlen(id);
+  if (kind >= CLI_RESP_KINDS || len == 0 || len >= RESP_ID_MAX) {
+    return -1;
+  }
+  memset(key, 0, sizeof(resp_key_t));
+  key->kind = kind;
+  memcpy(key->id, id, len);
+  return 0;
+}
+
+static size_t entry_size(cli_resp_entry_t const *elm) { return sizeof(cli_resp_entry_t) + elm->len + 1; }
+
+// must be called with the lock
+static void entry_remove(cli_resp_cache_t *cache, cli_resp_entry_t *elm) {
+  HASH_DEL(cache->entries, elm);
+  cache->stats.bytes -= entry_size(elm);
+  cache->stats.entries--;
+  free(elm->json);
+  free(elm);
+}
+
+void cli_resp_cache_init(cli_resp_cache_t *cache, size_t max_bytes) {
+  memset(cache, 0, sizeof(cli_resp_cache_t));
+  pthread_mutex_init(&cache->lock, NULL);
+  cache->max_bytes = max_bytes;
+}
+
+void cli_resp_cache_clear(cli_resp_cache_t *cache) {
+  cli_resp_entry_t *elm, *tmp;
+  pthread_mutex_lock(&cache->lock);
+  HASH_ITER(hh, cache->entries, elm, tmp) { entry_remove(cache, elm); }
+  pthread_mutex_unlock(&cache->lock);
+}
+
+void cli_resp_cache_cleanup(cli_resp_cache_t *cache) {
+  cli_resp_cache_clear(cache);
+  pthread_mutex_destroy(&cache->lock);
+}
+
+char *cli_resp_cache_get(cli_resp_cache_t *cache, cli_resp_kind_t kind, char const id[]) {
+  resp_key_t key;
+  cli_resp_entry_t *elm = NULL;
+  char *json = NULL;
+
+  if (make_key(&key, kind, id) != 0) {
+    return NULL;
+  }
+
+  pthread_mutex_lock(&cache->lock);
+  HASH_FIND(hh, cache->entries, &key, sizeof(resp_key_t), elm);
+  if (elm) {
+    // move to the tail, the head is the least recently used
+    HASH_DEL(cache->entries, elm);
+    HASH_ADD(hh, cache->entries, key, sizeof(resp_key_t), elm);
+    if ((json = malloc(elm->len + 1)) != NULL) {
+      memcpy(json, elm->json, elm->len + 1);
+    }
+  }
+
+  if (json) {
+    cache->stats.hits[kind]++;
+  } else {
+    cache->stats.misses[kind]++;
+  }
+  pthread_mutex_unlock(&cache->lock);
+  return json;
+}
+
+int cli_resp_cache_put(cli_resp_cache_t *cache, cli_resp_kind_t kind, char const id[], char const json[], size_t len) {
+  resp_key_t key;
+  cli_resp_entry_t *elm = NULL;
+
+  if (json == NULL || make_key(&key, kind, id) != 0) {
+    return -1;
+  }
+
+  if ((elm = calloc(1, sizeof(cli_resp_entry_t))) == NULL) {
+    return -1;
+  }
+  if ((elm->json = malloc(len + 1)) == NULL) {
+    free(elm);
+    return -1;
+  }
+  memcpy(elm->json, json, len);
+  elm->json[len] = '\0';
+  elm->len = len;
+  elm->key = key;
+
+  if (entry_size(elm) > cache->max_bytes) {
+    // larger than the cache
+    free(elm->json);
+    free(elm);
+    return -1;
+  }
+
+  pthread_mutex_lock(&cache->lock);
+  cli_resp_entry_t *found = NULL;
+  HASH_FIND(hh, cache->entries, &key, sizeof(resp_key_t), found);
+  if (found) {
+    entry_remove(cache, found);
+  }
+  // evict least recently used responses
+  while (cache->entries && cache->stats.bytes + entry_size(elm) > cache->max_bytes) {
+    entry_remove(cache, cache->entries);
+    cache->stats.evictions++;
+  }
+  HASH_ADD(hh, cache->entries, key, sizeof(resp_key_t), elm);
+  cache->stats.bytes += entry_size(elm);
+  cache->stats.entries++;
+  pthread_mutex_unlock(&cache->lock);
+  return 0;
+}
+
+void cli_resp_cache_refuse(cli_resp_cache_t *cache, cli_resp_kind_t kind) {
+  if (kind < CLI_RESP_KINDS) {
+    pthread_mutex_lock(&cache->lock);
+    cache->stats.refused[kind]++;
+    pthread_mutex_unlock(&cache->lock);
+  }
+}
+
+void cli_resp_cache_stats(cli_resp_cache_t *cache, cli_resp_cache_stats_t *stats) {
+  pthread_mutex_lock(&cache->lock);
+  memcpy(stats, &cache->stats, sizeof(cli_resp_cache_stats_t));
+  pthread_mutex_unlock(&cache->lock);
+}
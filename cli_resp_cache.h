@@ -0,0 +1,115 @@
+#ifndef __CLI_RESP_CACHE_H__
+#define __CLI_RESP_CACHE_H__
+
+#include <pthread.h>
+#include <stddef.h>
+#include <stdint.h>
+
+typedef struct cli_resp_entry cli_resp_entry_t;
+
+/**
+ * @brief Kinds of cached responses
+ *
+ */
+typedef enum {
+  CLI_RESP_MSG = 0, /*!< a message */
+  CLI_RESP_META,    /*!< metadata of a message referenced by a milestone */
+  CLI_RESP_OUTPUT,  /*!< a spent output */
+  CLI_RESP_KINDS,
+} cli_resp_kind_t;
+
+/**
+ * @brief Response cache statistics
+ *
+ */
+typedef struct {
+  uint64_t hits[CLI_RESP_KINDS];
+  uint64_t misses[CLI_RESP_KINDS];
+  uint64_t refused[CLI_RESP_KINDS]; /*!< responses of mutable objects, they are not cached */
+  uint64_t evictions;
+  size_t entries; /*!< number of cached responses */
+  size_t bytes;   /*!< memory used by cached responses */
+} cli_resp_cache_stats_t;
+
+/**
+ * @brief An LRU cache of node responses of immutable objects, keyed by message ID or output ID
+ *
+ * The raw JSON response is cached, the total size is capped by max_bytes. It's thread-safe.
+ *
+ */
+typedef struct {
+  pthread_mutex_t lock;
+  cli_resp_entry_t *entries;
+  size_t max_bytes; /*!< memory cap */
+  cli_resp_cache_stats_t stats;
+} cli_resp_cache_t;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Initialize a response cache
+ *
+ * @param cache the cache
+ * @param max_bytes the memory cap of cached responses
+ */
+void cli_resp_cache_init(cli_resp_cache_t *cache, size_t max_bytes);
+
+/**
+ * @brief Remove all responses and release the cache
+ *
+ * @param cache the cache
+ */
+void cli_resp_cache_cleanup(cli_resp_cache_t *cache);
+
+/**
+ * @brief Remove all responses
+ *
+ * @param cache the cache
+ */
+void cli_resp_cache_clear(cli_resp_cache_t *cache);
+
+/**
+ * @brief Get a cached response
+ *
+ * @param cache the cache
+ * @param kind the kind of the object
+ * @param id the message ID or output ID
+ * @return char* a copy of the JSON response, the caller must free it. NULL if not found.
+ */
+char *cli_resp_cache_get(cli_resp_cache_t *cache, cli_resp_kind_t kind, char const id[]);
+
+/**
+ * @brief Add a response of an immutable object to the cache
+ *
+ * @param cache the cache
+ * @param kind the kind of the object
+ * @param id the message ID or output ID
+ * @param json the JSON response
+ * @param len the length of the JSON response
+ * @return int 0 on success
+ */
+int cli_resp_cache_put(cli_resp_cache_t *cache, cli_resp_kind_t kind, char const id[], char const json[], size_t len);
+
+/**
+ * @brief Count a response which is not cacheable
+ *
+ * @param cache the cache
+ * @param kind the kind of the object
+ */
+void cli_resp_cache_refuse(cli_resp_cache_t *cache, cli_resp_kind_t kind);
+
+/**
+ * @brief Get a snapshot of the statistics
+ *
+ * @param cache the cache
+ * @param stats the output statistics
+ */
+void cli_resp_cache_stats(cli_resp_cache_t *cache, cli_resp_cache_stats_t *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // __CLI_RESP_CACHE_H__
@@ -0,0 +1,133 @@
+#include <stdbool.h>
+#include <string.h>
+
+#include "cli_split.h"
+
+#if defined(__SSE2__)
+#define SPLIT_SSE2 1
+#include <emmintrin.h>
+#else
+#define SPLIT_SSE2 0
+#endif
+
+#define SPLIT_SPACE ' '
+#define SPLIT_QUOTE '"'
+#define SPLIT_ESCAPE '\\'
+
+// length of the prefix of [p, end) without a, b and NUL
+static size_t scan_plain(char const *p, char const *end, char a, char b) {
+  char const *s = p;
+#if SPLIT_SSE2
+  __m128i const va = _mm_set1_epi8(a), vb = _mm_set1_epi8(b), vz = _mm_setzero_si128();
+  for (; end - s >= 16; s += 16) {
+    __m128i v = _mm_loadu_si128((__m128i const *)s);
+    __m128i hit = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(v, va), _mm_cmpeq_epi8(v, vb)), _mm_cmpeq_epi8(v, vz));
+    int bits = _mm_movemask_epi8(hit);
+    if (bits) {
+      return (size_t)(s - p) + (size_t)__builtin_ctz((unsigned)bits);
+    }
+  }
+#endif
+  while (s < end && *s != a && *s != b && *s != '\0') {
+    s++;
+  }
+  return (size_t)(s - p);
+}
+
+// length of the prefix of [p, end) of spaces
+static size_t scan_spaces(char const *p, char const *end) {
+  char const *s = p;
+#if SPLIT_SSE2
+  __m128i const vs = _mm_set1_epi8(SPLIT_SPACE);
+  for (; end - s >= 16; s += 16) {
+    int bits = _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128((__m128i const *)s), vs)) ^ 0xFFFF;
+    if (bits) {
+      return (size_t)(s - p) + (size_t)__builtin_ctz((unsigned)bits);
+    }
+  }
+#endif
+  while (s < end && *s == SPLIT_SPACE) {
+    s++;
+  }
+  return (size_t)(s - p);
+}
+
+size_t cli_split_argv(char *line, size_t len, char **argv, size_t argv_size) {
+  char const *end = line + len;
+  char *in = line;
+  char *out = line;
+  char *arg = NULL;
+  size_t argc = 0;
+
+  // output never overtakes input, a plain run is moved only after the first escape or separator
+  while (argc < argv_size - 1) {
+    in += scan_spaces(in, end);
+    if (in == end || *in == '\0') {
+      break;
+    }
+    arg = out;
+    bool quoted = *in == SPLIT_QUOTE;
+    if (quoted) {
+      in++;
+    }
+    for (;;) {
+      size_t n = scan_plain(in, end, quoted ? SPLIT_QUOTE : SPLIT_SPACE, SPLIT_ESCAPE);
+      if (out != in) {
+        if (n > 16) {
+          memmove(out, in, n);
+        } else {
+          // the short runs between escapes
+          for (size_t i = 0; i < n; i++) {
+            out[i] = in[i];
+          }
+        }
+      }
+      out += n;
+      in += n;
+      if (in == end || *in == '\0') {
+        // the line ends in the argument
+        *out = '\0';
+        argv[argc++] = arg;
+        argv[argc] = NULL;
+        return argc;
+      }
+      if (*in == SPLIT_ESCAPE) {
+        in++;
+        if (in == end || *in == '\0') {
+          continue;
+        }
+        // backslash, quote and space are escaped, other escape sequences are dropped
+        if (*in == SPLIT_ESCAPE || *in == SPLIT_QUOTE || *in == SPLIT_SPACE) {
+          *out++ = *in;
+        }
+        in++;
+        continue;
+      }
+      // the closing quote or the space after the argument
+      in++;
+      *out++ = '\0';
+      argv[argc++] = arg;
+      break;
+    }
+  }
+  *out = '\0';
+  argv[argc] = NULL;
+  return argc;
+}
+
+size_t cli_split_argc_max(char const *line, size_t len) {
+  char const *s = line, *end = line + len;
+  size_t n = 1;
+#if SPLIT_SSE2
+  __m128i const vs = _mm_set1_epi8(SPLIT_SPACE), vq = _mm_set1_epi8(SPLIT_QUOTE);
+  for (; end - s >= 16; s += 16) {
+    __m128i v = _mm_loadu_si128((__m128i const *)s);
+    int bits = _mm_movemask_epi8(_mm_or_si128(_mm_cmpeq_epi8(v, vs), _mm_cmpeq_epi8(v, vq)));
+    n += (size_t)__builtin_popcount((unsigned)bits);
+  }
+#endif
+  for (; s < end; s++) {
+    n += *s == SPLIT_SPACE || *s == SPLIT_QUOTE;
+  }
+  return n;
+}
@@ -0,0 +1,37 @@
+#ifndef __CLI_SPLIT_H__
+#define __CLI_SPLIT_H__
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Split a command line into arguments in place, a vectorized esp_console_split_argv
+ *
+ * The quoting and escaping semantics are the ones of esp_console_split_argv, only the scan differs: runs of plain
+ * bytes between spaces, quotes and backslashes are found 16 bytes per step with SSE2 and moved at once.
+ *
+ * @param line the buffer to parse, line[len] must be writable; it is modified in place
+ * @param len length of the line, a NUL byte before it ends the line
+ * @param argv array where the pointers to arguments are written
+ * @param argv_size number of elements in argv (max. number of arguments + 1), at least 1
+ * @return number of arguments found (argc), argv[argc] is NULL
+ */
+size_t cli_split_argv(char *line, size_t len, char **argv, size_t argv_size);
+
+/**
+ * @brief Get the max number of arguments of a line, every argument but the last one ends with a space or a quote
+ *
+ * @param line the line
+ * @param len length of the line
+ * @return size_t 1 + the number of spaces and quotes, argv of cli_split_argv needs one more element
+ */
+size_t cli_split_argc_max(char const *line, size_t len);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // __CLI_SPLIT_H__
@@ -0,0 +1,193 @@
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "cli_stats.h"
+#include "uthash.h"
+
+#define HIST_SUB (1u << CLI_HIST_SUB_BITS)
+
+struct cli_stats_node {
+  cli_stats_entry_t entry;
+  UT_hash_handle hh;
+};
+
+// values below HIST_SUB have a bucket each, each power of 2 above is split into HIST_SUB buckets
+static size_t hist_bucket(uint64_t val) {
+  if (val < HIST_SUB) {
+    return (size_t)val;
+  }
+  unsigned msb = 63 - (unsigned)__builtin_clzll(val);
+  if (msb >= CLI_HIST_MAX_BITS) {
+    return CLI_HIST_BUCKETS - 1;
+  }
+  unsigned shift = msb - CLI_HIST_SUB_BITS;
+  return ((size_t)(shift + 1) << CLI_HIST_SUB_BITS) + (size_t)((val >> shift) - HIST_SUB);
+}
+
+// the highest value of a bucket
+static uint64_t hist_bucket_high(size_t idx) {
+  if (idx < HIST_SUB) {
+    return idx;
+  }
+  unsigned shift = (unsigned)(idx >> CLI_HIST_SUB_BITS) - 1;
+  uint64_t low = (uint64_t)(HIST_SUB + (idx & (HIST_SUB - 1))) << shift;
+  return low + ((uint64_t)1 << shift) - 1;
+}
+
+void cli_hist_record(cli_hist_t *h, uint64_t val) {
+  h->buckets[hist_bucket(val)]++;
+  h->count++;
+  h->sum += val;
+  if (val > h->max) {
+    h->max = val;
+  }
+}
+
+uint64_t cli_hist_percentile(cli_hist_t const *h, double percentile) {
+  if (h->count == 0) {
+    return 0;
+  }
+  uint64_t rank = (uint64_t)(percentile / 100.0 * h->count + 0.5);
+  if (rank == 0) {
+    rank = 1;
+  }
+  uint64_t seen = 0;
+  for (size_t i = 0; i < CLI_HIST_BUCKETS; i++) {
+    seen += h->buckets[i];
+    if (seen >= rank) {
+      uint64_t high = hist_bucket_high(i);
+      return high < h->max ? high : h->max;
+    }
+  }
+  return h->max;
+}
+
+uint64_t cli_stats_now_ns() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+uint64_t cli_stats_cpu_ns() {
+  struct timespec ts;
+  if (clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts) != 0) {
+    return 0;
+  }
+  return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+void cli_stats_init(cli_stats_t *stats) {
+  memset(stats, 0, sizeof(cli_stats_t));
+  pthread_mutex_init(&stats->lock, NULL);
+}
+
+// must be called with the lock
+static void stats_free(cli_stats_t *stats) {
+  for (int k = 0; k < CLI_STATS_KINDS; k++) {
+    cli_stats_node_t *elm, *tmp;
+    HASH_ITER(hh, stats->entries[k], elm, tmp) {
+      HASH_DEL(stats->entries[k], elm);
+      free(elm);
+    }
+  }
+}
+
+void cli_stats_cleanup(cli_stats_t *stats) {
+  pthread_mutex_lock(&stats->lock);
+  stats_free(stats);
+  pthread_mutex_unlock(&stats->lock);
+  pthread_mutex_destroy(&stats->lock);
+}
+
+void cli_stats_reset(cli_stats_t *stats) {
+  pthread_mutex_lock(&stats->lock);
+  stats_free(stats);
+  pthread_mutex_unlock(&stats->lock);
+}
+
+// find or add an entry, must be called with the lock
+static cli_stats_entry_t *stats_entry(cli_stats_t *stats, cli_stats_kind_t kind, char const name[]) {
+  cli_stats_node_t *elm = NULL;
+  size_t len = strlen(name);
+  if (len >= CLI_STATS_NAME_MAX) {
+    len = CLI_STATS_NAME_MAX - 1;
+  }
+  HASH_FIND(hh, stats->entries[kind], name, len, elm);
+  if (elm == NULL) {
+    if ((elm = calloc(1, sizeof(cli_stats_node_t))) == NULL) {
+      return NULL;
+    }
+    memcpy(elm->entry.name, name, len);
+    HASH_ADD_KEYPTR(hh, stats->entries[kind], elm->entry.name, len, elm);
+  }
+  return &elm->entry;
+}
+
+uint64_t cli_stats_api_begin(cli_stats_t *stats, bool in_command) {
+  uint64_t now = cli_stats_now_ns();
+  if (in_command) {
+    pthread_mutex_lock(&stats->lock);
+    if (stats->net_inflight++ == 0) {
+      stats->net_since = now;
+    }
+    pthread_mutex_unlock(&stats->lock);
+  }
+  return now;
+}
+
+void cli_stats_api(cli_stats_t *stats, char const name[], uint64_t ns, bool failed, bool in_command) {
+  pthread_mutex_lock(&stats->lock);
+  // parallel calls of a command are not summed up, the network time is when any of them is in flight
+  if (in_command && stats->net_inflight > 0 && --stats->net_inflight == 0) {
+    stats->net_ns += cli_stats_now_ns() - stats->net_since;
+  }
+  cli_stats_entry_t *e = stats_entry(stats, CLI_STATS_API, name);
+  if (e) {
+    cli_hist_record(&e->hist[CLI_STATS_WALL], ns / 1000);
+    e->errors += failed;
+  }
+  pthread_mutex_unlock(&stats->lock);
+}
+
+uint64_t cli_stats_net_ns(cli_stats_t *stats) {
+  pthread_mutex_lock(&stats->lock);
+  uint64_t ns = stats->net_ns + (stats->net_inflight ? cli_stats_now_ns() - stats->net_since : 0);
+  pthread_mutex_unlock(&stats->lock);
+  return ns;
+}
+
+void cli_stats_command(cli_stats_t *stats, char const name[], uint64_t const ns[CLI_STATS_TIMERS], bool failed) {
+  pthread_mutex_lock(&stats->lock);
+  cli_stats_entry_t *e = stats_entry(stats, CLI_STATS_CMD, name);
+  if (e) {
+    for (int t = 0; t < CLI_STATS_TIMERS; t++) {
+      cli_hist_record(&e->hist[t], ns[t] / 1000);
+    }
+    e->errors += failed;
+  }
+  pthread_mutex_unlock(&stats->lock);
+}
+
+static int entry_cmp(void const *a, void const *b) {
+  return strcmp(((cli_stats_entry_t const *)a)->name, ((cli_stats_entry_t const *)b)->name);
+}
+
+size_t cli_stats_snapshot(cli_stats_t *stats, cli_stats_kind_t kind, cli_stats_entry_t **entries) {
+  *entries = NULL;
+  pthread_mutex_lock(&stats->lock);
+  size_t n = HASH_COUNT(stats->entries[kind]);
+  if (n > 0 && (*entries = malloc(n * sizeof(cli_stats_entry_t))) != NULL) {
+    size_t i = 0;
+    for (cli_stats_node_t *elm = stats->entries[kind]; elm != NULL; elm = elm->hh.next) {
+      (*entries)[i++] = elm->entry;
+    }
+  } else {
+    n = 0;
+  }
+  pthread_mutex_unlock(&stats->lock);
+  if (n > 1) {
+    qsort(*entries, n, sizeof(cli_stats_entry_t), entry_cmp);
+  }
+  return n;
+}
@@ -0,0 +1,184 @@
+#ifndef __CLI_STATS_H__
+#define __CLI_STATS_H__
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// sub-buckets per power of 2 is 2^CLI_HIST_SUB_BITS, values are within 1/16 of the recorded value
+#define CLI_HIST_SUB_BITS 4
+// values up to 2^40 microseconds
+#define CLI_HIST_MAX_BITS 40
+#define CLI_HIST_BUCKETS ((CLI_HIST_MAX_BITS - CLI_HIST_SUB_BITS + 1) << CLI_HIST_SUB_BITS)
+// max length of a command or API name
+#define CLI_STATS_NAME_MAX 64
+
+/**
+ * @brief A log-linear latency histogram of microseconds, in the manner of HDR histograms
+ *
+ */
+typedef struct {
+  uint64_t count;                     /*!< number of values */
+  uint64_t sum;                       /*!< sum of values */
+  uint64_t max;                       /*!< the max value */
+  uint32_t buckets[CLI_HIST_BUCKETS]; /*!< counts of value ranges */
+} cli_hist_t;
+
+/**
+ * @brief Timers of a command
+ *
+ */
+typedef enum {
+  CLI_STATS_WALL = 0, /*!< elapsed time */
+  CLI_STATS_NET,      /*!< time waiting for node API calls */
+  CLI_STATS_CPU,      /*!< CPU time of the process */
+  CLI_STATS_TIMERS,
+} cli_stats_timer_t;
+
+/**
+ * @brief Kinds of statistics
+ *
+ */
+typedef enum {
+  CLI_STATS_CMD = 0, /*!< commands, all timers are recorded */
+  CLI_STATS_API,     /*!< node API calls, only the wall timer is recorded */
+  CLI_STATS_KINDS,
+} cli_stats_kind_t;
+
+/**
+ * @brief Statistics of a command or a node API
+ *
+ */
+typedef struct {
+  char name[CLI_STATS_NAME_MAX];     /*!< the command or API name */
+  uint64_t errors;                   /*!< failed calls */
+  cli_hist_t hist[CLI_STATS_TIMERS]; /*!< latency histograms */
+} cli_stats_entry_t;
+
+typedef struct cli_stats_node cli_stats_node_t;
+
+/**
+ * @brief Latency statistics of commands and node API calls, it's thread-safe
+ *
+ */
+typedef struct {
+  pthread_mutex_t lock;
+  cli_stats_node_t *entries[CLI_STATS_KINDS]; /*!< entries by name */
+  uint64_t net_ns;                            /*!< time with node API calls in flight, commands take the difference */
+  uint64_t net_since;                         /*!< start of the current in-flight period */
+  uint32_t net_inflight;                      /*!< node API calls in flight for commands */
+} cli_stats_t;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Record a value
+ *
+ * @param h the histogram
+ * @param val the value in microseconds
+ */
+void cli_hist_record(cli_hist_t *h, uint64_t val);
+
+/**
+ * @brief Get the value at a percentile
+ *
+ * @param h the histogram
+ * @param percentile 0 to 100
+ * @return uint64_t the highest value of the bucket at the percentile, 0 if the histogram is empty
+ */
+uint64_t cli_hist_percentile(cli_hist_t const *h, double percentile);
+
+/**
+ * @brief Get a monotonic timestamp
+ *
+ * @return uint64_t nanoseconds
+ */
+uint64_t cli_stats_now_ns();
+
+/**
+ * @brief Get the CPU time of the process, it includes all threads
+ *
+ * @return uint64_t nanoseconds
+ */
+uint64_t cli_stats_cpu_ns();
+
+/**
+ * @brief Initialize statistics
+ *
+ * @param stats the statistics
+ */
+void cli_stats_init(cli_stats_t *stats);
+
+/**
+ * @brief Release statistics
+ *
+ * @param stats the statistics
+ */
+void cli_stats_cleanup(cli_stats_t *stats);
+
+/**
+ * @brief Clear all statistics
+ *
+ * @param stats the statistics
+ */
+void cli_stats_reset(cli_stats_t *stats);
+
+/**
+ * @brief Start a node API call, it's ended by cli_stats_api
+ *
+ * Parallel calls overlap, the network time counts the wall time with at least one call in flight.
+ *
+ * @param stats the statistics
+ * @param in_command the call is made for the running command
+ * @return uint64_t the start time in nanoseconds
+ */
+uint64_t cli_stats_api_begin(cli_stats_t *stats, bool in_command);
+
+/**
+ * @brief Record a node API call
+ *
+ * @param stats the statistics
+ * @param name the API name
+ * @param ns the elapsed time in nanoseconds
+ * @param failed the call failed
+ * @param in_command the call is made for the running command and started by cli_stats_api_begin with it
+ */
+void cli_stats_api(cli_stats_t *stats, char const name[], uint64_t ns, bool failed, bool in_command);
+
+/**
+ * @brief Get the time with node API calls in flight for commands, the network time of a command is the difference
+ * before and after it
+ *
+ * @param stats the statistics
+ * @return uint64_t nanoseconds
+ */
+uint64_t cli_stats_net_ns(cli_stats_t *stats);
+
+/**
+ * @brief Record a command
+ *
+ * @param stats the statistics
+ * @param name the command name
+ * @param ns elapsed, network and CPU time in nanoseconds, indexed by cli_stats_timer_t
+ * @param failed the command failed
+ */
+void cli_stats_command(cli_stats_t *stats, char const name[], uint64_t const ns[CLI_STATS_TIMERS], bool failed);
+
+/**
+ * @brief Get a copy of statistics sorted by name
+ *
+ * @param stats the statistics
+ * @param kind commands or node API calls
+ * @param entries the copy, it's freed by the caller
+ * @return size_t the number of entries
+ */
+size_t cli_stats_snapshot(cli_stats_t *stats, cli_stats_kind_t kind, cli_stats_entry_t **entries);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // __CLI_STATS_H__
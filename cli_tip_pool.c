@@ -0,0 +1,173 @@
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "cli_tip_pool.h"
+
+static double elapsed_secs(struct timespec const *since) {
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return (now.tv_sec - since->tv_sec) + (now.tv_nsec - since->tv_nsec) / 1e9;
+}
+
+// must be called with the lock
+static void pool_set(cli_tip_pool_t *pool, char const tips[][CLI_TIP_ID_BUF], size_t len) {
+  if (len > CLI_TIP_POOL_MAX) {
+    len = CLI_TIP_POOL_MAX;
+  }
+  memcpy(pool->tips, tips, len * CLI_TIP_ID_BUF);
+  pool->len = len;
+  pool->cursor = 0;
+  clock_gettime(CLOCK_MONOTONIC, &pool->fetched);
+}
+
+// must be called with the lock
+static bool pool_fresh(cli_tip_pool_t *pool) {
+  if (pool->len == 0) {
+    return false;
+  }
+  if (elapsed_secs(&pool->fetched) * 1000 > pool->max_age_ms) {
+    pool->len = 0;
+    pool->stats.dropped++;
+    return false;
+  }
+  return true;
+}
+
+static void *pool_refresher(void *arg) {
+  cli_tip_pool_t *pool = (cli_tip_pool_t *)arg;
+  char(*tips)[CLI_TIP_ID_BUF] = malloc(CLI_TIP_POOL_MAX * CLI_TIP_ID_BUF);
+  if (tips == NULL) {
+    return NULL;
+  }
+
+  pthread_mutex_lock(&pool->lock);
+  while (!pool->stop) {
+    uint32_t generation = pool->generation;
+    pthread_mutex_unlock(&pool->lock);
+    // fetch without the lock, requests are served from the old tips meanwhile
+    size_t len = pool->fetch(pool->fetch_ctx, tips, CLI_TIP_POOL_MAX);
+    pthread_mutex_lock(&pool->lock);
+    if (generation != pool->generation) {
+      // cleared during the fetch, the tips could be from the previous node
+      pool->kick = true;
+    } else if (len > 0) {
+      pool_set(pool, (char const(*)[CLI_TIP_ID_BUF])tips, len);
+      pool->stats.refreshes++;
+    } else {
+      pool->stats.failed++;
+    }
+
+    struct timespec deadline;
+    clock_gettime(CLOCK_MONOTONIC, &deadline);
+    deadline.tv_sec += pool->refresh_ms / 1000;
+    deadline.tv_nsec += (long)(pool->refresh_ms % 1000) * 1000000L;
+    if (deadline.tv_nsec >= 1000000000L) {
+      deadline.tv_sec++;
+      deadline.tv_nsec -= 1000000000L;
+    }
+    // wait for the next refresh, a miss or clear asks for a refresh now
+    while (!pool->stop && !pool->kick) {
+      if (pthread_cond_timedwait(&pool->cond, &pool->lock, &deadline) == ETIMEDOUT) {
+        break;
+      }
+    }
+    pool->kick = false;
+  }
+  pthread_mutex_unlock(&pool->lock);
+  free(tips);
+  return NULL;
+}
+
+int cli_tip_pool_start(cli_tip_pool_t *pool, cli_tip_fetch_fn_t fetch, void *ctx, uint32_t refresh_ms,
+                       uint32_t max_age_ms) {
+  pthread_condattr_t attr;
+
+  memset(pool, 0, sizeof(cli_tip_pool_t));
+  pool->fetch = fetch;
+  pool->fetch_ctx = ctx;
+  pool->refresh_ms = refresh_ms;
+  pool->max_age_ms = max_age_ms;
+  pthread_mutex_init(&pool->lock, NULL);
+  pthread_condattr_init(&attr);
+  pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+  pthread_cond_init(&pool->cond, &attr);
+  pthread_condattr_destroy(&attr);
+
+  if (pthread_create(&pool->thread, NULL, pool_refresher, pool) != 0) {
+    pthread_cond_destroy(&pool->cond);
+    pthread_mutex_destroy(&pool->lock);
+    return -1;
+  }
+  pool->running = true;
+  return 0;
+}
+
+void cli_tip_pool_stop(cli_tip_pool_t *pool) {
+  if (!pool->running) {
+    return;
+  }
+  pthread_mutex_lock(&pool->lock);
+  pool->stop = true;
+  pthread_cond_signal(&pool->cond);
+  pthread_mutex_unlock(&pool->lock);
+  pthread_join(pool->thread, NULL);
+  pthread_cond_destroy(&pool->cond);
+  pthread_mutex_destroy(&pool->lock);
+  pool->running = false;
+}
+
+size_t cli_tip_pool_get(cli_tip_pool_t *pool, char parents[][CLI_TIP_ID_BUF], size_t max) {
+  size_t n = 0;
+  if (!pool->running) {
+    return 0;
+  }
+
+  pthread_mutex_lock(&pool->lock);
+  if (pool_fresh(pool)) {
+    n = pool->len < max ? pool->len : max;
+    // successive requests approve different subsets of the tips
+    for (size_t i = 0; i < n; i++) {
+      memcpy(parents[i], pool->tips[(pool->cursor + i) % pool->len], CLI_TIP_ID_BUF);
+    }
+    pool->cursor = (pool->cursor + n) % pool->len;
+    pool->stats.served++;
+  } else {
+    pool->stats.missed++;
+    pool->kick = true;
+    pthread_cond_signal(&pool->cond);
+  }
+  pthread_mutex_unlock(&pool->lock);
+  return n;
+}
+
+void cli_tip_pool_update(cli_tip_pool_t *pool, char const tips[][CLI_TIP_ID_BUF], size_t len) {
+  if (pool->running && len > 0) {
+    pthread_mutex_lock(&pool->lock);
+    pool_set(pool, tips, len);
+    pthread_mutex_unlock(&pool->lock);
+  }
+}
+
+void cli_tip_pool_clear(cli_tip_pool_t *pool) {
+  if (pool->running) {
+    pthread_mutex_lock(&pool->lock);
+    pool->len = 0;
+    pool->generation++;
+    pool->kick = true;
+    pthread_cond_signal(&pool->cond);
+    pthread_mutex_unlock(&pool->lock);
+  }
+}
+
+void cli_tip_pool_stats(cli_tip_pool_t *pool, cli_tip_pool_stats_t *stats) {
+  if (!pool->running) {
+    memset(stats, 0, sizeof(cli_tip_pool_stats_t));
+    return;
+  }
+  pthread_mutex_lock(&pool->lock);
+  memcpy(stats, &pool->stats, sizeof(cli_tip_pool_stats_t));
+  stats->tips = pool->len;
+  stats->age = pool->len ? elapsed_secs(&pool->fetched) : 0;
+  pthread_mutex_unlock(&pool->lock);
+}
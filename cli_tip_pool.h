@@ -0,0 +1,126 @@
+#ifndef __CLI_TIP_POOL_H__
+#define __CLI_TIP_POOL_H__
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <time.h>
+
+// buffer size of a hex message ID
+#define CLI_TIP_ID_BUF 65
+// max number of tips in the pool
+#define CLI_TIP_POOL_MAX 64
+
+/**
+ * @brief Fetch tips from the node
+ *
+ * @param ctx the user context
+ * @param tips the output tips
+ * @param max the max number of tips
+ * @return size_t the number of tips, 0 on failed
+ */
+typedef size_t (*cli_tip_fetch_fn_t)(void *ctx, char tips[][CLI_TIP_ID_BUF], size_t max);
+
+/**
+ * @brief Tip pool statistics
+ *
+ */
+typedef struct {
+  uint64_t served;    /*!< requests served from the pool */
+  uint64_t missed;    /*!< requests found the pool empty or stale */
+  uint64_t refreshes; /*!< successful refreshes */
+  uint64_t failed;    /*!< failed refreshes */
+  uint64_t dropped;   /*!< tip sets dropped by the age bound */
+  size_t tips;        /*!< number of tips in the pool */
+  double age;         /*!< age of the tips in seconds */
+} cli_tip_pool_stats_t;
+
+/**
+ * @brief A pool of tips refreshed by a background thread
+ *
+ * Tips older than the age bound are not handed out. It's thread-safe.
+ *
+ */
+typedef struct {
+  pthread_mutex_t lock;
+  pthread_cond_t cond;
+  pthread_t thread;
+  bool running;
+  bool stop;
+  bool kick;                                   /*!< refresh now */
+  uint32_t generation;                         /*!< bumped by clear */
+  cli_tip_fetch_fn_t fetch;
+  void *fetch_ctx;
+  uint32_t refresh_ms;                         /*!< refresh interval */
+  uint32_t max_age_ms;                         /*!< age bound of tips */
+  char tips[CLI_TIP_POOL_MAX][CLI_TIP_ID_BUF]; /*!< the latest tips */
+  size_t len;                                  /*!< number of tips */
+  size_t cursor;                               /*!< rotates subsets of tips handed out */
+  struct timespec fetched;                     /*!< monotonic time of the latest refresh */
+  cli_tip_pool_stats_t stats;
+} cli_tip_pool_t;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Start the background refresh of a tip pool
+ *
+ * @param pool the pool
+ * @param fetch the callback fetching tips, it's called on the background thread
+ * @param ctx the context of the callback
+ * @param refresh_ms the refresh interval in milliseconds
+ * @param max_age_ms the age bound of tips in milliseconds
+ * @return int 0 on success
+ */
+int cli_tip_pool_start(cli_tip_pool_t *pool, cli_tip_fetch_fn_t fetch, void *ctx, uint32_t refresh_ms,
+                       uint32_t max_age_ms);
+
+/**
+ * @brief Stop the background refresh and release the pool
+ *
+ * @param pool the pool
+ */
+void cli_tip_pool_stop(cli_tip_pool_t *pool);
+
+/**
+ * @brief Get parents from the pool
+ *
+ * @param pool the pool
+ * @param parents the output tips
+ * @param max the max number of tips
+ * @return size_t the number of tips, 0 if the pool is empty or stale
+ */
+size_t cli_tip_pool_get(cli_tip_pool_t *pool, char parents[][CLI_TIP_ID_BUF], size_t max);
+
+/**
+ * @brief Replace tips of the pool, e.g. with tips fetched on a miss
+ *
+ * @param pool the pool
+ * @param tips the tips
+ * @param len the number of tips
+ */
+void cli_tip_pool_update(cli_tip_pool_t *pool, char const tips[][CLI_TIP_ID_BUF], size_t len);
+
+/**
+ * @brief Drop all tips and refresh now, it's called when the node is changed
+ *
+ * @param pool the pool
+ */
+void cli_tip_pool_clear(cli_tip_pool_t *pool);
+
+/**
+ * @brief Get a snapshot of the statistics
+ *
+ * @param pool the pool
+ * @param stats the output statistics
+ */
+void cli_tip_pool_stats(cli_tip_pool_t *pool, cli_tip_pool_stats_t *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // __CLI_TIP_POOL_H__
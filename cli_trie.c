@@ -0,0 +1,159 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include "cli_trie.h"
+
+// index 0 is the root node, it's never a child so 0 is used as the null link.
+#define TRIE_NIL 0
+#define TRIE_INIT_NODES 64
+
+typedef struct {
+  uint32_t child; /*!< the first child */
+  uint32_t next;  /*!< the next sibling */
+  char c;         /*!< the character of this node */
+  bool is_key;    /*!< a key ends at this node */
+} trie_node_t;
+
+struct cli_trie {
+  trie_node_t *nodes; /*!< node pool */
+  size_t len;         /*!< used nodes */
+  size_t cap;         /*!< allocated nodes */
+  size_t max;         /*!< node limit, 0 for unlimited */
+  size_t keys;        /*!< number of keys */
+};
+
+cli_trie_t *cli_trie_new(size_t max_nodes) {
+  cli_trie_t *t = calloc(1, sizeof(cli_trie_t));
+  if (t) {
+    t->nodes = calloc(TRIE_INIT_NODES, sizeof(trie_node_t));
+    if (t->nodes == NULL) {
+      free(t);
+      return NULL;
+    }
+    t->cap = TRIE_INIT_NODES;
+    t->len = 1;  // root
+    t->max = max_nodes;
+  }
+  return t;
+}
+
+void cli_trie_free(cli_trie_t *t) {
+  if (t) {
+    free(t->nodes);
+    free(t);
+  }
+}
+
+static uint32_t trie_new_node(cli_trie_t *t, char c) {
+  if (t->max && t->len >= t->max) {
+    return TRIE_NIL;
+  }
+
+  if (t->len == t->cap) {
+    size_t cap = t->cap * 2;
+    trie_node_t *nodes = realloc(t->nodes, cap * sizeof(trie_node_t));
+    if (nodes == NULL) {
+      return TRIE_NIL;
+    }
+    t->nodes = nodes;
+    t->cap = cap;
+  }
+
+  uint32_t n = (uint32_t)t->len++;
+  memset(&t->nodes[n], 0, sizeof(trie_node_t));
+  t->nodes[n].c = c;
+  return n;
+}
+
+// find the child of the parent node, return TRIE_NIL if not found
+static uint32_t trie_child(cli_trie_t const *t, uint32_t parent, char c) {
+  uint32_t n = t->nodes[parent].child;
+  // siblings are sorted
+  while (n != TRIE_NIL && t->nodes[n].c < c) {
+    n = t->nodes[n].next;
+  }
+  return (n != TRIE_NIL && t->nodes[n].c == c) ? n : TRIE_NIL;
+}
+
+int cli_trie_insert(cli_trie_t *t, char const *key) {
+  if (t == NULL || key == NULL) {
+    return -1;
+  }
+
+  size_t len = strlen(key);
+  if (len == 0 || len >= CLI_TRIE_KEY_MAX) {
+    return -1;
+  }
+
+  uint32_t cur = 0;
+  for (size_t i = 0; i < len; i++) {
+    char c = key[i];
+    // find the insert position in the sorted sibling list
+    uint32_t prev = TRIE_NIL;
+    uint32_t n = t->nodes[cur].child;
+    while (n != TRIE_NIL && t->nodes[n].c < c) {
+      prev = n;
+      n = t->nodes[n].next;
+    }
+
+    if (n == TRIE_NIL || t->nodes[n].c != c) {
+      uint32_t new_n = trie_new_node(t, c);
+      if (new_n == TRIE_NIL) {
+        return -1;
+      }
+      t->nodes[new_n].next = n;
+      if (prev == TRIE_NIL) {
+        t->nodes[cur].child = new_n;
+      } else {
+        t->nodes[prev].next = new_n;
+      }
+      n = new_n;
+    }
+    cur = n;
+  }
+
+  if (!t->nodes[cur].is_key) {
+    t->nodes[cur].is_key = true;
+    t->keys++;
+  }
+  return 0;
+}
+
+static void trie_collect(cli_trie_t const *t, uint32_t node, char buf[], size_t depth, size_t max, size_t *found,
+                         cli_trie_cb_t cb, void *ctx) {
+  if (t->nodes[node].is_key) {
+    buf[depth] = '\0';
+    if (cb) {
+      cb(buf, ctx);
+    }
+    (*found)++;
+  }
+
+  for (uint32_t n = t->nodes[node].child; n != TRIE_NIL && *found < max; n = t->nodes[n].next) {
+    buf[depth] = t->nodes[n].c;
+    trie_collect(t, n, buf, depth + 1, max, found, cb, ctx);
+  }
+}
+
+size_t cli_trie_find(cli_trie_t const *t, char const *prefix, size_t len, size_t max, cli_trie_cb_t cb, void *ctx) {
+  char buf[CLI_TRIE_KEY_MAX] = {};
+  size_t found = 0;
+
+  if (t == NULL || len >= CLI_TRIE_KEY_MAX || max == 0) {
+    return 0;
+  }
+
+  uint32_t cur = 0;
+  for (size_t i = 0; i < len; i++) {
+    cur = trie_child(t, cur, prefix[i]);
+    if (cur == TRIE_NIL) {
+      return 0;
+    }
+    buf[i] = prefix[i];
+  }
+
+  trie_collect(t, cur, buf, len, max, &found, cb, ctx);
+  return found;
+}
+
+size_t cli_trie_count(cli_trie_t const *t) { return t ? t->keys : 0; }
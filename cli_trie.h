@@ -0,0 +1,83 @@
+#ifndef __CLI_TRIE_H__
+#define __CLI_TRIE_H__
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// the max length of a key in the trie
+#define CLI_TRIE_KEY_MAX 128
+
+/**
+ * @brief A compact prefix trie
+ *
+ * Nodes are kept in a single growable array and linked as first-child/next-sibling, siblings are sorted by the
+ * character. Keys can not be removed, the trie is released as a whole.
+ *
+ */
+typedef struct cli_trie cli_trie_t;
+
+/**
+ * @brief Trie match callback
+ *
+ * @param key a null-terminated key which matches the prefix
+ * @param ctx the user context
+ */
+typedef void (*cli_trie_cb_t)(char const *key, void *ctx);
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Create a trie
+ *
+ * @param max_nodes the max number of nodes, 0 for unlimited
+ * @return cli_trie_t* NULL on failed
+ */
+cli_trie_t *cli_trie_new(size_t max_nodes);
+
+/**
+ * @brief Free a trie
+ *
+ * @param t the trie
+ */
+void cli_trie_free(cli_trie_t *t);
+
+/**
+ * @brief Add a key to the trie
+ *
+ * @param t the trie
+ * @param key a null-terminated string, the length must be smaller than CLI_TRIE_KEY_MAX
+ * @return int 0 on success, -1 if the key is invalid or the node limit is reached
+ */
+int cli_trie_insert(cli_trie_t *t, char const *key);
+
+/**
+ * @brief Find keys with the given prefix
+ *
+ * The cost is proportional to the length of the prefix plus the total length of matched keys.
+ *
+ * @param t the trie
+ * @param prefix the prefix, not need to be null-terminated
+ * @param len the length of the prefix
+ * @param max the max number of keys are returned to the callback
+ * @param cb the callback, can be NULL for counting matches
+ * @param ctx the user context of the callback
+ * @return size_t the number of keys returned
+ */
+size_t cli_trie_find(cli_trie_t const *t, char const *prefix, size_t len, size_t max, cli_trie_cb_t cb, void *ctx);
+
+/**
+ * @brief Get the number of keys in the trie
+ *
+ * @param t the trie
+ * @return size_t
+ */
+size_t cli_trie_count(cli_trie_t const *t);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // __CLI_TRIE_H__
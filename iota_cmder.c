@@ -1,17 +1,101 @@
+#include <stdbool.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
+#include "argtable3.h"
 #include "cli_cmd.h"
+#include "cli_daemon.h"
+#include "cli_out.h"
 
-int main(int argc, char **argv) {
-  char *line = NULL;
+static struct {
+  struct arg_str *batch;
+  struct arg_str *daemon;
+  struct arg_str *node;
+  struct arg_str *data_dir;
+  struct arg_lit *fail_fast;
+  struct arg_str *output;
+  struct arg_lit *line_buffered;
+  struct arg_lit *help;
+  struct arg_end *end;
+} main_args;
 
-  if (cli_command_init() != 0) {
-    printf("iota cmder init failed\n");
+// parse http[s]://host[:port], the port is 80 or 443 by default
+static int parse_node_url(char const url[], char host[], size_t host_len, uint16_t *port, bool *tls) {
+  char const *p = url;
+  if (strncmp(p, "https://", 8) == 0) {
+    *tls = true;
+    p += 8;
+  } else if (strncmp(p, "http://", 7) == 0) {
+    *tls = false;
+    p += 7;
+  } else {
     return -1;
   }
 
+  size_t len = strcspn(p, ":/");
+  if (len == 0 || len >= host_len) {
+    return -1;
+  }
+  memcpy(host, p, len);
+  host[len] = '\0';
+  p += len;
+
+  *port = *tls ? 443 : 80;
+  if (*p == ':') {
+    char *end = NULL;
+    unsigned long n = strtoul(p + 1, &end, 10);
+    if (end == p + 1 || n == 0 || n > UINT16_MAX) {
+      return -1;
+    }
+    *port = (uint16_t)n;
+    p = end;
+  }
+  return *p == '\0' || strcmp(p, "/") == 0 ? 0 : -1;
+}
+
+// run commands from a file or stdin without linenoise, returns the number of failed commands.
+static size_t run_batch(FILE *fp, bool fail_fast) {
+  char *line = NULL;
+  size_t line_cap = 0;
+  size_t line_num = 0;
+  size_t failed = 0;
+  ssize_t len = 0;
+
+  while ((len = getline(&line, &line_cap, fp)) != -1) {
+    line_num++;
+    // trim new line
+    while (len > 0 && (line[len - 1] == '\n' || line[len - 1] == '\r')) {
+      line[--len] = '\0';
+    }
+
+    // skip empty lines and comments
+    if (line[0] == '\0' || line[0] == '/' || line[0] == '#') {
+      continue;
+    }
+    if (!strncmp(line, "exit", 4)) {
+      break;
+    }
+
+    cli_err_t cmd_ret = 0;
+    cli_err_t ret = cli_command_run(line, &cmd_ret);
+    if (ret != CLI_OK || cmd_ret != 0) {
+      failed++;
+      fprintf(stderr, "[batch] line %zu failed, status %d: %s\n", line_num, ret != CLI_OK ? ret : cmd_ret, line);
+      if (fail_fast) {
+        break;
+      }
+    }
+  }
+
+  free(line);
+  return failed;
+}
+
+static void run_interactive() {
+  char *line = NULL;
+
   // Enable multiline mode
   linenoiseSetMultiLine(1);
 
@@ -42,6 +126,109 @@ int main(int argc, char **argv) {
   }
 
   linenoiseFree(line);
+}
+
+int main(int argc, char **argv) {
+  int ret = 0;
+  FILE *batch_fp = NULL;
+
+  main_args.batch = arg_str0("b", "batch", "<file|->", "run commands from a file, or stdin if '-'");
+  main_args.daemon = arg_str0("d", "daemon", "<socket>", "serve commands on a Unix domain socket");
+  main_args.node = arg_str0("n", "node", "<url>", "connect to http[s]://host[:port] instead of the configured node");
+  main_args.data_dir =
+      arg_str0(NULL, "data-dir", "<dir>", "directory of the message stores, default $XDG_DATA_HOME/iota_cmder");
+  main_args.fail_fast = arg_lit0(NULL, "fail-fast", "stop at the first failed command in batch mode");
+  main_args.output =
+      arg_str0("o", "output", "<text|json|ndjson>", "output format, records go to stdout and logs to stderr");
+  main_args.line_buffered =
+      arg_lit0(NULL, "line-buffered", "write text line by line instead of a whole result, default in interactive mode");
+  main_args.help = arg_lit0("h", "help", "show this help");
+  main_args.end = arg_end(6);
+
+  if (arg_parse(argc, argv, (void **)&main_args) != 0) {
+    arg_print_errors(stderr, main_args.end, argv[0]);
+    ret = -1;
+    goto done;
+  }
+
+  if (main_args.help->count > 0) {
+    printf("Usage: %s", argv[0]);
+    arg_print_syntax(stdout, (void **)&main_args, "\n");
+    arg_print_glossary(stdout, (void **)&main_args, "  %-20s %s\n");
+    goto done;
+  }
+
+  if (main_args.batch->count > 0 && main_args.daemon->count > 0) {
+    printf("--batch and --daemon can't be used together\n");
+    ret = -1;
+    goto done;
+  }
+
+  if (main_args.batch->count > 0) {
+    char const *const path = main_args.batch->sval[0];
+    batch_fp = strcmp(path, "-") == 0 ? stdin : fopen(path, "r");
+    if (batch_fp == NULL) {
+      printf("open %s failed\n", path);
+      ret = -1;
+      goto done;
+    }
+  }
+
+  if (main_args.node->count > 0) {
+    char host[256] = {};
+    uint16_t port = 0;
+    bool tls = false;
+    if (parse_node_url(main_args.node->sval[0], host, sizeof(host), &port, &tls) != 0 ||
+        cli_command_set_node(host, port, tls) != CLI_OK) {
+      printf("invalid node URL: %s\n", main_args.node->sval[0]);
+      ret = -1;
+      goto done;
+    }
+  }
+
+  if (main_args.data_dir->count > 0 && cli_command_set_data_dir(main_args.data_dir->sval[0]) != CLI_OK) {
+    printf("invalid data directory: %s\n", main_args.data_dir->sval[0]);
+    ret = -1;
+    goto done;
+  }
+
+  if (main_args.output->count > 0) {
+    cli_out_mode_t mode = CLI_OUT_TEXT;
+    if (cli_out_mode_parse(main_args.output->sval[0], &mode) != 0 || cli_out_set_mode(mode) != 0) {
+      printf("invalid output format: %s\n", main_args.output->sval[0]);
+      ret = -1;
+      goto done;
+    }
+  }
+
+  if (cli_command_init() != 0) {
+    printf("iota cmder init failed\n");
+    ret = -1;
+    goto done;
+  }
+
+  // a whole result is written at once in batch and daemon modes, lines are shown as they come in interactive mode
+  bool interactive = batch_fp == NULL && main_args.daemon->count == 0;
+  if (batch_fp == stdin || main_args.daemon->count > 0) {
+    // stdin holds the commands, or it's not the one of the clients
+    cli_command_reserve_stdin();
+  }
+  cli_out_set_line_buffered(interactive || main_args.line_buffered->count > 0);
+
+  if (batch_fp) {
+    ret = run_batch(batch_fp, main_args.fail_fast->count > 0) == 0 ? 0 : 1;
+  } else if (main_args.daemon->count > 0) {
+    ret = cli_daemon_run(main_args.daemon->sval[0]) == 0 ? 0 : 1;
+  } else {
+    run_interactive();
+  }
+
   cli_command_end();
-  return 0;
+
+done:
+  if (batch_fp && batch_fp != stdin) {
+    fclose(batch_fp);
+  }
+  arg_freetable((void **)&main_args, sizeof(main_args) / sizeof(main_args.batch));
+  return ret;
 }